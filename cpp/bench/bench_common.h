@@ -0,0 +1,123 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+/**
+ * ROMs e cenas sintéticas compartilhadas pelos benchmarks (nenhuma ROM
+ * comercial é necessária)
+ */
+
+#include "ppu.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// iNES com PRG preenchida com 'fill' e CHR com padrões pseudoaleatórios.
+// chrBanks = 0 gera um cartucho com CHR RAM.
+static std::vector<uint8_t> makeSyntheticROM(int mapper = 0, int prgBanks = 2, int chrBanks = 1,
+                                             uint8_t fill = 0xEA) {
+    size_t prgSize = prgBanks * 0x4000;
+    size_t chrSize = chrBanks * 0x2000;
+    std::vector<uint8_t> rom(16 + prgSize + chrSize, fill);
+    const uint8_t header[16] = {
+        'N', 'E', 'S', 0x1A,
+        static_cast<uint8_t>(prgBanks), static_cast<uint8_t>(chrBanks),
+        static_cast<uint8_t>(((mapper & 0x0F) << 4) | 0x01), static_cast<uint8_t>(mapper & 0xF0)
+    };
+    std::copy(header, header + 16, rom.begin());
+    
+    uint32_t seed = 0x12345678;
+    for (size_t i = 16 + prgSize; i < rom.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        rom[i] = seed >> 24;
+    }
+    return rom;
+}
+
+// Nametables, paleta e 64 sprites espalhados; background e sprites ligados
+static void setupScene(PPU& ppu) {
+    ppu.write(0x2006, 0x3F);
+    ppu.write(0x2006, 0x00);
+    for (int i = 0; i < 32; i++) {
+        ppu.write(0x2007, (i * 7) & 0x3F);
+    }
+    ppu.write(0x2006, 0x20);
+    ppu.write(0x2006, 0x00);
+    for (int i = 0; i < 0x800; i++) {
+        ppu.write(0x2007, i * 13);
+    }
+    ppu.write(0x2003, 0);
+    for (int i = 0; i < 64; i++) {
+        ppu.write(0x2004, (i * 29) % 232);  // Y
+        ppu.write(0x2004, i);               // Tile
+        ppu.write(0x2004, i & 0x23);        // Atributos
+        ppu.write(0x2004, (i * 37) & 0xFF); // X
+    }
+    ppu.write(0x2005, 0);
+    ppu.write(0x2005, 0);
+    ppu.write(0x2000, 0x80);
+    ppu.write(0x2001, 0x1E);
+}
+
+/**
+ * A cena de setupScene montada por um programa 6502, para medir o Console
+ * inteiro com renderização ligada: o reset copia paleta, nametables e OAM
+ * das tabelas em $C000/$C100/$D000 e liga BG, sprites e NMI; o laço
+ * principal só faz contas em RAM e o NMI move os sprites e refaz a OAM DMA
+ * e o scroll, como um jogo.
+ */
+static std::vector<uint8_t> makeSceneROM() {
+    static const uint8_t program[] = {
+        0x78, 0xD8, 0xA2, 0xFF, 0x9A,              // SEI; CLD; LDX #$FF; TXS
+        0xA9, 0x40, 0x8D, 0x17, 0x40,              // LDA #$40; STA $4017 (sem IRQ de frame)
+        0x2C, 0x02, 0x20, 0x10, 0xFB,              // BIT $2002; BPL -5 (dois vblanks)
+        0x2C, 0x02, 0x20, 0x10, 0xFB,
+        0xA9, 0x3F, 0x8D, 0x06, 0x20,              // $2006 = $3F00
+        0xA9, 0x00, 0x8D, 0x06, 0x20,
+        0xA2, 0x00,                                // LDX #0
+        0xBD, 0x00, 0xC0, 0x8D, 0x07, 0x20,        // LDA $C000,X; STA $2007
+        0xE8, 0xE0, 0x20, 0xD0, 0xF5,              // INX; CPX #$20; BNE (paleta)
+        0xA9, 0x20, 0x8D, 0x06, 0x20,              // $2006 = $2000
+        0xA9, 0x00, 0x8D, 0x06, 0x20,
+        0x85, 0x00, 0xA9, 0xD0, 0x85, 0x01,        // ($00) = $D000
+        0xA2, 0x08, 0xA0, 0x00,                    // LDX #8; LDY #0
+        0xB1, 0x00, 0x8D, 0x07, 0x20,              // LDA ($00),Y; STA $2007
+        0xC8, 0xD0, 0xF8,                          // INY; BNE
+        0xE6, 0x01, 0xCA, 0xD0, 0xF3,              // INC $01; DEX; BNE (nametables)
+        0xA2, 0x00,                                // LDX #0
+        0xBD, 0x00, 0xC1, 0x9D, 0x00, 0x02,        // LDA $C100,X; STA $0200,X
+        0xE8, 0xD0, 0xF7,                          // INX; BNE (OAM)
+        0xA9, 0x80, 0x8D, 0x00, 0x20,              // $2000 = $80 (NMI)
+        0xA9, 0x1E, 0x8D, 0x01, 0x20,              // $2001 = $1E (BG + sprites)
+        0xE6, 0x10, 0xA5, 0x10, 0x69, 0x03,        // $8061: INC $10; LDA $10; ADC #3
+        0x85, 0x11, 0x4C, 0x61, 0x80,              // STA $11; JMP $8061
+        0x48, 0x8A, 0x48, 0xA2, 0x00,              // $806B (NMI): PHA; TXA; PHA; LDX #0
+        0xFE, 0x03, 0x02,                          // INC $0203,X (X do sprite)
+        0xE8, 0xE8, 0xE8, 0xE8, 0xD0, 0xF6,        // INX x4; BNE
+        0xA9, 0x00, 0x8D, 0x03, 0x20,              // $2003 = 0
+        0xA9, 0x02, 0x8D, 0x14, 0x40,              // $4014 = 2 (OAM DMA de $0200)
+        0xA9, 0x00, 0x8D, 0x05, 0x20, 0x8D, 0x05, 0x20,  // Scroll 0, 0
+        0x68, 0xAA, 0x68, 0x40,                    // PLA; TAX; PLA; RTI ($808F)
+    };
+    std::vector<uint8_t> rom = makeSyntheticROM(0, 2, 1, 0xEA);
+    uint8_t* prg = rom.data() + 16;
+    std::copy(program, program + sizeof(program), prg);
+    // Mesmas tabelas de setupScene
+    for (int i = 0; i < 32; i++) {
+        prg[0x4000 + i] = (i * 7) & 0x3F;
+    }
+    for (int i = 0; i < 64; i++) {
+        prg[0x4100 + i * 4] = (i * 29) % 232;
+        prg[0x4100 + i * 4 + 1] = i;
+        prg[0x4100 + i * 4 + 2] = i & 0x23;
+        prg[0x4100 + i * 4 + 3] = (i * 37) & 0xFF;
+    }
+    for (int i = 0; i < 0x800; i++) {
+        prg[0x5000 + i] = static_cast<uint8_t>(i * 13);
+    }
+    const uint8_t vectors[6] = {0x6B, 0x80, 0x00, 0x80, 0x8F, 0x80};  // NMI, reset, IRQ (RTI)
+    std::copy(vectors, vectors + 6, prg + 0x7FFA);
+    return rom;
+}
+
+#endif // BENCH_COMMON_H
@@ -0,0 +1,140 @@
+/**
+ * Benchmark do modo headless: compara o custo por frame com e sem composição
+ * de vídeo / síntese de áudio, usando ROMs sintéticas geradas em memória. Os
+ * casos do Console rodam makeSceneROM, com background e sprites ligados.
+ *
+ * Também mede o fast-forward de 8 frames por runFrame e o modo pipeline.
+ *
+ * Uso: nes_headless_bench [frames]
+ */
+
+#include "console.h"
+#include "cartridge.h"
+#include "ppu.h"
+#include "apu.h"
+#include "bench_common.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static const int PPU_DOTS_PER_FRAME = 341 * 262;
+static const int CPU_CYCLES_PER_FRAME = 29781;
+
+struct PPUResult {
+    double nsPerFrame;
+    int nmis;
+};
+
+static PPUResult benchPPU(const std::vector<uint8_t>& rom, bool video, int frames) {
+    Cartridge cartridge;
+    cartridge.loadROM(rom.data(), rom.size());
+    std::vector<uint8_t> frameBuffer(PPU::FRAME_BUFFER_SIZE);
+    
+    PPU ppu;
+    ppu.setCartridge(&cartridge);
+    ppu.setFrameBuffer(frameBuffer.data());
+    ppu.setVideoEnabled(video);
+    setupScene(ppu);
+    
+    PPUResult result = {0.0, 0};
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+        for (int dot = 0; dot < PPU_DOTS_PER_FRAME; dot++) {
+            ppu.step();
+            if (ppu.nmiRequested()) {
+                ppu.resetNMI();
+                result.nmis++;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.nsPerFrame = std::chrono::duration<double, std::nano>(end - start).count() / frames;
+    return result;
+}
+
+static double benchAPU(bool synthesis, int frames) {
+    std::vector<float> samples(Console::DEFAULT_AUDIO_CAPACITY);
+    APU apu;
+    apu.setAudioBuffer(samples.data(), samples.size());
+    apu.setSynthesisEnabled(synthesis);
+    apu.write(0x4015, 0x0F);
+    apu.write(0x4003, 0xF8);
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+        for (int c = 0; c < CPU_CYCLES_PER_FRAME; c++) {
+            apu.step();
+        }
+        while (apu.hasAudioData()) {
+            apu.getSample();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / frames;
+}
+
+static double benchConsole(const std::vector<uint8_t>& rom, uint8_t headless, int frames,
+                           int fastForward = 1, bool pipelined = false) {
+    Console console;
+    console.loadROM(rom.data(), rom.size());
+    console.setHeadless(headless);
+    console.setFastForward(fastForward);
+    console.setPipelined(pipelined);
+    
+    // ns por frame emulado
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames / fastForward; f++) {
+        console.runFrame();
+        while (console.hasAudioData()) {
+            console.getAudioSample();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           (frames / fastForward * fastForward);
+}
+
+static void report(const char* name, double full, double headless) {
+    printf("%-8s %12.0f %12.0f %9.2fx\n", name, full, headless, full / headless);
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 600;
+    if (frames <= 0) {
+        fprintf(stderr, "uso: %s [frames]\n", argv[0]);
+        return 1;
+    }
+    
+    std::vector<uint8_t> rom = makeSyntheticROM();
+    std::vector<uint8_t> scene = makeSceneROM();
+    
+    PPUResult ppuFull = benchPPU(rom, true, frames);
+    PPUResult ppuHeadless = benchPPU(rom, false, frames);
+    double apuFull = benchAPU(true, frames);
+    double apuHeadless = benchAPU(false, frames);
+    double consoleFull = benchConsole(scene, HEADLESS_NONE, frames);
+    double consoleHeadless = benchConsole(scene, HEADLESS_ALL, frames);
+    double consoleTurbo = benchConsole(scene, HEADLESS_NONE, frames, 8);
+    double consolePipelined = benchConsole(scene, HEADLESS_NONE, frames, 1, true);
+    
+    printf("%d frames, ns/frame\n", frames);
+    printf("%-8s %12s %12s %10s\n", "", "completo", "headless", "speedup");
+    report("PPU", ppuFull.nsPerFrame, ppuHeadless.nsPerFrame);
+    report("APU", apuFull, apuHeadless);
+    report("Console", consoleFull, consoleHeadless);
+    printf("%-8s %12.0f (fast-forward 8x, %.2fx)\n", "Turbo", consoleTurbo, consoleFull / consoleTurbo);
+    // Com um núcleo só setPipelined mantém o console serial
+    printf("%-8s %12.0f (%s, %.2fx)\n", "Pipeline", consolePipelined,
+           std::thread::hardware_concurrency() == 1 ? "serial: 1 núcleo" : "thread de renderização",
+           consoleFull / consolePipelined);
+    
+    // O timing visível à CPU não pode mudar entre os modos
+    if (ppuFull.nmis != ppuHeadless.nmis) {
+        fprintf(stderr, "divergência de NMI: %d vs %d\n", ppuFull.nmis, ppuHeadless.nmis);
+        return 1;
+    }
+    return 0;
+}
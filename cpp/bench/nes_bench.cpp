@@ -0,0 +1,627 @@
+/**
+ * Microbenchmarks dos caminhos quentes do núcleo, todos com ROMs sintéticas
+ * geradas em memória.
+ *
+ * Cada caso roda várias vezes e reporta o melhor tempo por operação, o
+ * equivalente em ciclos do TSC (x86) e, quando faz sentido, a vazão em
+ * bytes. Regressões aparecem como ns/op maiores entre builds.
+ *
+ * Uso: nes_bench [filtro]   (roda só os casos cujo nome contém o filtro)
+ *      nes_bench --verify [rom.nes ...]
+ *
+ * --verify não mede nada: confere frame a frame o LockstepEngine contra
+ * Consoles separados nas ROMs dadas (sem nenhuma, no programa sintético do
+ * caso lockstep) e sai com 1 se algum estado divergir.
+ */
+
+#include "apu.h"
+#include "bench_common.h"
+#include "cartridge.h"
+#include "console.h"
+#include "cpu.h"
+#include "decode_cache.h"
+#include "lockstep.h"
+#include "memory.h"
+#include "ppu.h"
+#include "state_saver.h"
+#include "thumbnail.h"
+#include "video_filter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define NES_BENCH_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define NES_BENCH_TSC 1
+#endif
+
+static const int REPEATS = 5;
+static const char* filter = nullptr;
+static double tscPerNs = 0.0;
+static volatile uint32_t sink;
+
+// Frequência do TSC, medida contra o relógio monotônico
+static void calibrateTSC() {
+#ifdef NES_BENCH_TSC
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t c0 = __rdtsc();
+    while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(50)) {
+    }
+    uint64_t c1 = __rdtsc();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    tscPerNs = (c1 - c0) / ns;
+#endif
+}
+
+// Melhor de REPEATS execuções de body(), que realiza 'ops' operações
+template <typename Body>
+static void bench(const std::string& name, uint64_t ops, uint64_t bytesPerOp, Body body) {
+    if (filter && name.find(filter) == std::string::npos) {
+        return;
+    }
+    
+    double best = 1e300;
+    for (int r = 0; r < REPEATS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    
+    double nsPerOp = best / ops;
+    printf("%-28s %12.2f", name.c_str(), nsPerOp);
+    if (tscPerNs > 0.0) {
+        printf(" %12.1f", nsPerOp * tscPerNs);
+    } else {
+        printf(" %12s", "-");
+    }
+    if (bytesPerOp > 0) {
+        printf(" %10.1f MB/s", bytesPerOp / nsPerOp * 1000.0);
+    }
+    printf("\n");
+}
+
+/**
+ * CPU: PRG de 32KB repetindo um trecho de programa, com JMP $8000 no fim e
+ * vetor de reset em $8000. Roda só CPU + memória + cartucho.
+ */
+static std::vector<uint8_t> makeProgramROM(const std::vector<uint8_t>& pattern) {
+    std::vector<uint8_t> rom = makeSyntheticROM(0, 2, 1, 0xEA);
+    uint8_t* prg = rom.data() + 16;
+    size_t end = 0x7F00 - 3;
+    size_t pos = 0;
+    while (pos + pattern.size() <= end) {
+        std::memcpy(prg + pos, pattern.data(), pattern.size());
+        pos += pattern.size();
+    }
+    prg[pos] = 0x4C;  // JMP $8000
+    prg[pos + 1] = 0x00;
+    prg[pos + 2] = 0x80;
+    prg[0x7F00] = 0x60;  // RTS em $FF00 para o JSR
+    prg[0x7FFC] = 0x00;  // Reset
+    prg[0x7FFD] = 0x80;
+    return rom;
+}
+
+static void benchCPU() {
+    struct OpcodeClass {
+        const char* name;
+        std::vector<uint8_t> pattern;
+    };
+    const OpcodeClass classes[] = {
+        {"nop",          {0xEA}},
+        {"load imm",     {0xA9, 0x01, 0xA2, 0x02, 0xA0, 0x03}},
+        {"load mem",     {0xA5, 0x10, 0xAD, 0x00, 0x02, 0xBD, 0x00, 0x02, 0xB1, 0x10}},
+        {"store",        {0x85, 0x10, 0x8D, 0x00, 0x02, 0x9D, 0x00, 0x02}},
+        {"alu",          {0x69, 0x01, 0xE9, 0x01, 0x29, 0x0F, 0x09, 0xF0, 0x49, 0x55, 0xC9, 0x10}},
+        {"rmw/inc",      {0x0A, 0x4A, 0xE6, 0x10, 0xC8, 0xCA, 0x2E, 0x00, 0x02}},
+        {"branch",       {0x18, 0x90, 0x00, 0x38, 0xB0, 0x00}},
+        {"stack",        {0x48, 0x68, 0x08, 0x28}},
+        {"jsr/rts",      {0x20, 0x00, 0xFF}},
+    };
+    const uint64_t steps = 1000000;
+    
+    for (const OpcodeClass& opcodeClass : classes) {
+        std::vector<uint8_t> rom = makeProgramROM(opcodeClass.pattern);
+        Cartridge cartridge;
+        cartridge.loadROM(rom.data(), rom.size());
+        Memory memory;
+        memory.setCartridge(&cartridge);
+        CPU cpu(&memory);
+        DecodeCache cache;
+        cache.attach(&cartridge);
+        
+        // Com o cache de instruções e decodificando pelo barramento
+        for (bool cached : {true, false}) {
+            cpu.setDecodeCache(cached ? &cache : nullptr);
+            bench(std::string("cpu/") + opcodeClass.name + (cached ? "" : " uncached"), steps, 0, [&]() {
+                cpu.reset();
+                for (uint64_t i = 0; i < steps; i++) {
+                    cpu.step();
+                }
+            });
+        }
+    }
+}
+
+static void benchMemory() {
+    std::vector<uint8_t> rom = makeSyntheticROM(2, 8, 0);
+    Cartridge cartridge;
+    cartridge.loadROM(rom.data(), rom.size());
+    PPU ppu;
+    ppu.setCartridge(&cartridge);
+    APU apu;
+    Memory memory;
+    memory.setCartridge(&cartridge);
+    memory.setPPU(&ppu);
+    memory.setAPU(&apu);
+    
+    struct Region {
+        const char* name;
+        uint16_t base;
+        uint16_t mask;  // Endereços percorridos: base + (i & mask)
+    };
+    const Region reads[] = {
+        {"ram",        0x0000, 0x07FF},
+        {"ram mirror", 0x0800, 0x17FF},
+        {"ppu",        0x2000, 0x0007},
+        {"apu/io",     0x4015, 0x0000},
+        {"prg ram",    0x6000, 0x1FFF},
+        {"prg rom",    0x8000, 0x7FFF},
+    };
+    const Region writes[] = {
+        {"ram",        0x0000, 0x07FF},
+        {"ppu",        0x2006, 0x0001},
+        {"apu",        0x4000, 0x0013},
+        {"prg ram",    0x6000, 0x1FFF},
+        {"mapper",     0x8000, 0x7FFF},
+    };
+    const uint64_t ops = 1 << 20;
+    
+    for (const Region& region : reads) {
+        bench(std::string("memory/read ") + region.name, ops, 1, [&]() {
+            uint32_t sum = 0;
+            for (uint64_t i = 0; i < ops; i++) {
+                sum += memory.read(region.base + (i & region.mask));
+            }
+            sink = sum;
+        });
+    }
+    for (const Region& region : writes) {
+        bench(std::string("memory/write ") + region.name, ops, 1, [&]() {
+            for (uint64_t i = 0; i < ops; i++) {
+                memory.write(region.base + (i & region.mask), static_cast<uint8_t>(i));
+            }
+        });
+    }
+}
+
+static void benchCartridge() {
+    struct MapperROM {
+        int mapper;
+        int prgBanks;
+        int chrBanks;
+        uint16_t bankRegister;
+    };
+    const MapperROM mappers[] = {
+        {0, 2, 1, 0x8000},
+        {1, 8, 4, 0xE000},
+        {2, 8, 0, 0x8000},
+        {3, 2, 4, 0x8000},
+        {4, 16, 16, 0x8001},
+        {7, 8, 0, 0x8000},
+    };
+    const uint64_t ops = 1 << 20;
+    
+    for (const MapperROM& m : mappers) {
+        std::vector<uint8_t> rom = makeSyntheticROM(m.mapper, m.prgBanks, m.chrBanks);
+        Cartridge cartridge;
+        cartridge.loadROM(rom.data(), rom.size());
+        std::string prefix = "cartridge/mapper" + std::to_string(m.mapper);
+        
+        bench(prefix + " prg", ops, 1, [&]() {
+            uint32_t sum = 0;
+            for (uint64_t i = 0; i < ops; i++) {
+                sum += cartridge.readPRG(0x8000 | (i & 0x7FFF));
+            }
+            sink = sum;
+        });
+        bench(prefix + " chr", ops, 1, [&]() {
+            uint32_t sum = 0;
+            for (uint64_t i = 0; i < ops; i++) {
+                sum += cartridge.readCHR(i & 0x1FFF);
+            }
+            sink = sum;
+        });
+        bench(prefix + " bank switch", ops / 16, 0, [&]() {
+            for (uint64_t i = 0; i < ops / 16; i++) {
+                cartridge.writePRG(m.bankRegister, static_cast<uint8_t>(i & 0x07));
+            }
+        });
+    }
+}
+
+static void benchPPU() {
+    std::vector<uint8_t> rom = makeSyntheticROM();
+    Cartridge cartridge;
+    cartridge.loadROM(rom.data(), rom.size());
+    std::vector<uint8_t> frameBuffer(PPU::FRAME_BUFFER_SIZE);
+    const int frames = 60;
+    const int dots = 341 * 262;
+    
+    for (int video = 1; video >= 0; video--) {
+        PPU ppu;
+        ppu.setCartridge(&cartridge);
+        ppu.setFrameBuffer(frameBuffer.data());
+        ppu.setVideoEnabled(video != 0);
+        setupScene(ppu);
+        
+        bench(video ? "ppu/frame" : "ppu/frame headless", frames,
+              video ? PPU::FRAME_BUFFER_SIZE : 0, [&]() {
+            for (int f = 0; f < frames; f++) {
+                for (int d = 0; d < dots; d++) {
+                    ppu.step();
+                }
+                ppu.resetNMI();
+            }
+        });
+    }
+    
+    // run() só para nos eventos: sem mapper, com o IRQ do MMC3 a cada 8
+    // linhas agendado analiticamente (8x8, sprites em $1000) e com as
+    // subidas de A12 calculadas linha a linha (8x16)
+    std::vector<uint8_t> mmc3 = makeSyntheticROM(4, 8, 8);
+    Cartridge mmc3Cartridge;
+    mmc3Cartridge.loadROM(mmc3.data(), mmc3.size());
+    const char* runNames[3] = {"ppu/run headless", "ppu/run mmc3 irq headless", "ppu/run mmc3 8x16 headless"};
+    const uint8_t runCtrl[3] = {0x80, 0x88, 0xA0};
+    for (int i = 0; i < 3; i++) {
+        PPU ppu;
+        ppu.setCartridge(i ? &mmc3Cartridge : &cartridge);
+        ppu.setVideoEnabled(false);
+        setupScene(ppu);
+        ppu.write(0x2000, runCtrl[i]);
+        if (i) {
+            ppu.syncMapperIRQ();
+            mmc3Cartridge.writePRG(0xC000, 7);
+            mmc3Cartridge.writePRG(0xC001, 0);
+            mmc3Cartridge.writePRG(0xE001, 0);
+            ppu.updateMapperIRQ();
+        }
+        
+        bench(runNames[i], frames, 0, [&]() {
+            for (int f = 0; f < frames; f++) {
+                ppu.run(dots);
+                ppu.resetNMI();
+            }
+        });
+    }
+}
+
+static void benchAPU() {
+    std::vector<float> samples(Console::DEFAULT_AUDIO_CAPACITY);
+    const uint64_t cycles = 29781 * 60;
+    
+    for (int synthesis = 1; synthesis >= 0; synthesis--) {
+        APU apu;
+        apu.setAudioBuffer(samples.data(), samples.size());
+        apu.setSynthesisEnabled(synthesis != 0);
+        apu.write(0x4015, 0x0F);
+        apu.write(0x4003, 0xF8);
+        
+        bench(synthesis ? "apu/step" : "apu/step headless", cycles, 0, [&]() {
+            for (uint64_t c = 0; c < cycles; c++) {
+                apu.step();
+                if (apu.getAudioCount() == samples.size()) {
+                    while (apu.hasAudioData()) {
+                        apu.getSample();
+                    }
+                }
+            }
+        });
+    }
+    
+    APU apu;
+    apu.setAudioBuffer(samples.data(), samples.size());
+    apu.write(0x4015, 0x0F);
+    uint64_t drained = 0;
+    bench("apu/drain", 1 << 20, sizeof(float), [&]() {
+        drained = 0;
+        while (drained < (1 << 20)) {
+            while (apu.getAudioCount() < samples.size()) {
+                apu.step();
+            }
+            while (apu.hasAudioData()) {
+                apu.getSample();
+                drained++;
+            }
+        }
+    });
+}
+
+static void benchState() {
+    std::vector<uint8_t> rom = makeSyntheticROM(1, 8, 0);
+    Console console(true);
+    console.loadROM(rom.data(), rom.size());
+    console.setHeadless(HEADLESS_ALL);
+    for (int f = 0; f < 10; f++) {
+        console.runFrame();
+    }
+    
+    const size_t size = console.getStateSize();
+    std::vector<uint8_t> buffer(size);
+    const int ops = 2000;
+    
+    bench("state/get", ops, size, [&]() {
+        for (int i = 0; i < ops; i++) {
+            std::vector<uint8_t> state = console.getState();
+            sink = state[i % state.size()];
+        }
+    });
+    bench("state/save buffer", ops, size, [&]() {
+        for (int i = 0; i < ops; i++) {
+            console.saveState(buffer.data(), buffer.size());
+        }
+    });
+    bench("state/set", ops, size, [&]() {
+        for (int i = 0; i < ops; i++) {
+            console.setState(buffer.data(), buffer.size());
+        }
+    });
+    
+    // Codec dos arquivos do StateSaver (roda na thread de gravação)
+    std::vector<uint8_t> compressed(StateSaver::maxCompressedSize(size));
+    size_t compressedSize = 0;
+    bench("state/compress", ops, size, [&]() {
+        for (int i = 0; i < ops; i++) {
+            compressedSize = StateSaver::compress(buffer.data(), size, compressed.data(), compressed.size());
+        }
+    });
+    bench("state/decompress", ops, size, [&]() {
+        for (int i = 0; i < ops; i++) {
+            sink = StateSaver::decompress(compressed.data(), compressedSize, buffer.data(), size);
+        }
+    });
+}
+
+// Programa que lê o controle e desvia pelo botão A
+static std::vector<uint8_t> makeLockstepROM() {
+    const std::vector<uint8_t> pattern = {
+        0xA9, 0x01, 0x8D, 0x16, 0x40,  // LDA #1; STA $4016
+        0xA9, 0x00, 0x8D, 0x16, 0x40,  // LDA #0; STA $4016
+        0xAD, 0x16, 0x40, 0x29, 0x01,  // LDA $4016; AND #1
+        0xF0, 0x02, 0xE6, 0x10,        // BEQ +2; INC $10
+        0xA5, 0x10, 0x69, 0x03, 0x85, 0x11, 0xA6, 0x11,  // LDA $10; ADC #3; STA $11; LDX $11
+        0xB5, 0x20, 0x9D, 0x00, 0x02, 0x2E, 0x00, 0x02,  // LDA $20,X; STA $0200,X; ROL $0200
+    };
+    return makeProgramROM(pattern);
+}
+
+/**
+ * Lockstep: 16 instâncias do programa de makeLockstepROM, rodadas uma a uma
+ * e pelo LockstepEngine. Com entradas diferentes metade das lanes segue
+ * outro caminho a cada repetição do trecho.
+ */
+static void benchLockstep() {
+    std::vector<uint8_t> rom = makeLockstepROM();
+    const int lanes = LockstepEngine::MAX_LANES;
+    const int frames = 10;
+    
+    for (bool diverge : {false, true}) {
+        std::vector<std::unique_ptr<Console>> consoles;
+        std::vector<Console*> list;
+        for (int i = 0; i < lanes; i++) {
+            consoles.push_back(std::make_unique<Console>(true));
+            consoles[i]->setHeadless(HEADLESS_ALL);
+            consoles[i]->loadROM(rom.data(), rom.size());
+            consoles[i]->pushInput({0, 0, 0, static_cast<uint8_t>(diverge ? i & 1 : 0)});
+            list.push_back(consoles[i].get());
+        }
+        LockstepEngine engine;
+        engine.attach(list.data(), lanes);
+        
+        std::string suffix = diverge ? " diverge" : "";
+        bench("lockstep/16 scalar" + suffix, lanes * frames, 0, [&]() {
+            for (int f = 0; f < frames; f++) {
+                for (Console* console : list) {
+                    console->runFrame();
+                }
+            }
+        });
+        bench("lockstep/16 lanes" + suffix, lanes * frames, 0, [&]() {
+            for (int f = 0; f < frames; f++) {
+                engine.runFrame();
+            }
+        });
+    }
+}
+
+/**
+ * Roda a ROM em 'lanes' instâncias pelo LockstepEngine e em outras tantas
+ * uma a uma, com a mesma entrada (diferente por lane, para forçar
+ * divergência), e compara o estado completo depois de cada frame. Devolve
+ * os pares (frame, lane) divergentes ou -1 se a ROM não carregar.
+ */
+static int verifyLockstep(const std::vector<uint8_t>& rom, int lanes, int frames) {
+    std::vector<std::unique_ptr<Console>> scalar;
+    std::vector<std::unique_ptr<Console>> lockstep;
+    std::vector<Console*> list;
+    for (int i = 0; i < lanes; i++) {
+        scalar.push_back(std::make_unique<Console>(true));
+        lockstep.push_back(std::make_unique<Console>(true));
+        scalar[i]->setHeadless(HEADLESS_ALL);
+        lockstep[i]->setHeadless(HEADLESS_ALL);
+        if (!scalar[i]->loadROM(rom.data(), rom.size()) || !lockstep[i]->loadROM(rom.data(), rom.size())) {
+            return -1;
+        }
+        list.push_back(lockstep[i].get());
+    }
+    LockstepEngine engine;
+    if (!engine.attach(list.data(), lanes)) {
+        return -1;
+    }
+    
+    int mismatches = 0;
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < lanes; i++) {
+            InputEvent event = {0, 0, 0, static_cast<uint8_t>(f * 7 + i * 13)};
+            scalar[i]->pushInput(event);
+            lockstep[i]->pushInput(event);
+            scalar[i]->runFrame();
+        }
+        engine.runFrame();
+        for (int i = 0; i < lanes; i++) {
+            if (scalar[i]->getState() != lockstep[i]->getState()) {
+                if (mismatches++ < 5) {
+                    printf("  divergência no frame %d, lane %d\n", f, i);
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+static int runVerify(int count, char** paths) {
+    struct VerifyROM {
+        std::string name;
+        std::vector<uint8_t> data;
+    };
+    std::vector<VerifyROM> roms;
+    for (int i = 0; i < count; i++) {
+        std::ifstream file(paths[i], std::ios::binary);
+        if (!file) {
+            fprintf(stderr, "não foi possível ler %s\n", paths[i]);
+            return 1;
+        }
+        roms.push_back({paths[i], std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                                       std::istreambuf_iterator<char>())});
+    }
+    if (roms.empty()) {
+        roms.push_back({"lockstep sintético", makeLockstepROM()});
+    }
+    
+    // Todas as lanes e um número que não enche o vetor
+    const int laneCounts[2] = {LockstepEngine::MAX_LANES, 5};
+    const int frames = 120;
+    bool failed = false;
+    for (const VerifyROM& rom : roms) {
+        for (int lanes : laneCounts) {
+            int mismatches = verifyLockstep(rom.data, lanes, frames);
+            if (mismatches < 0) {
+                printf("%s: ROM inválida\n", rom.name.c_str());
+            } else {
+                printf("%s: %d lanes, %d frames, %d divergências\n", rom.name.c_str(), lanes, frames, mismatches);
+            }
+            failed |= mismatches != 0;
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+// Miniatura de save state a partir de um frame renderizado da cena sintética
+static void benchThumbnail() {
+    std::vector<uint8_t> rom = makeSyntheticROM();
+    Cartridge cartridge;
+    cartridge.loadROM(rom.data(), rom.size());
+    std::vector<uint8_t> frame(PPU::FRAME_BUFFER_SIZE);
+    PPU ppu;
+    ppu.setCartridge(&cartridge);
+    ppu.setFrameBuffer(frame.data());
+    setupScene(ppu);
+    for (int d = 0; d < 341 * 262; d++) {
+        ppu.step();
+    }
+    
+    const int width = 128;
+    const int height = 120;
+    const int ops = 200;
+    std::vector<uint8_t> scaled(width * height * 3);
+    std::vector<uint8_t> out(thumbnailMaxSize(THUMBNAIL_QOI, width, height));
+    
+    bench("thumbnail/scale 128x120", ops, PPU::FRAME_BUFFER_SIZE, [&]() {
+        for (int i = 0; i < ops; i++) {
+            downscaleRGB(frame.data(), 256, 240, scaled.data(), width, height);
+        }
+    });
+    bench("thumbnail/qoi 128x120", ops, PPU::FRAME_BUFFER_SIZE, [&]() {
+        for (int i = 0; i < ops; i++) {
+            sink = static_cast<uint32_t>(encodeThumbnail(frame.data(), width, height, THUMBNAIL_QOI,
+                                                         out.data(), out.size()));
+        }
+    });
+    bench("thumbnail/png 128x120", ops, PPU::FRAME_BUFFER_SIZE, [&]() {
+        for (int i = 0; i < ops; i++) {
+            sink = static_cast<uint32_t>(encodeThumbnail(frame.data(), width, height, THUMBNAIL_PNG,
+                                                         out.data(), out.size()));
+        }
+    });
+}
+
+// Pós-processamento de um frame renderizado da cena sintética
+static void benchVideoFilter() {
+    std::vector<uint8_t> rom = makeSyntheticROM();
+    Cartridge cartridge;
+    cartridge.loadROM(rom.data(), rom.size());
+    std::vector<uint8_t> frame(PPU::FRAME_BUFFER_SIZE);
+    PPU ppu;
+    ppu.setCartridge(&cartridge);
+    ppu.setFrameBuffer(frame.data());
+    setupScene(ppu);
+    for (int d = 0; d < 341 * 262; d++) {
+        ppu.step();
+    }
+    
+    static const struct {
+        const char* name;
+        VideoFilterSettings settings;
+    } cases[] = {
+        {"video/nearest 3x", {VIDEO_FILTER_NEAREST, 3, 0}},
+        {"video/scanlines 3x", {VIDEO_FILTER_NEAREST, 3, 96}},
+        {"video/smooth 2x", {VIDEO_FILTER_SMOOTH, 2, 0}},
+        {"video/smooth 3x", {VIDEO_FILTER_SMOOTH, 3, 0}},
+        {"video/smooth 4x", {VIDEO_FILTER_SMOOTH, 4, 0}},
+        {"video/ntsc 3x", {VIDEO_FILTER_NTSC, 3, 0}},
+    };
+    const int frames = 20;
+    for (const auto& filterCase : cases) {
+        VideoFilter filter;
+        filter.configure(filterCase.settings);
+        size_t pitch = static_cast<size_t>(filter.getWidth()) * 4;
+        std::vector<uint8_t> out(pitch * filter.getHeight());
+        bench(filterCase.name, frames, out.size(), [&]() {
+            for (int f = 0; f < frames; f++) {
+                filter.apply(frame.data(), out.data(), pitch);
+            }
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--verify") == 0) {
+        return runVerify(argc - 2, argv + 2);
+    }
+    filter = argc > 1 ? argv[1] : nullptr;
+    calibrateTSC();
+    
+    printf("%-28s %12s %12s %15s\n", "caso", "ns/op", "ciclos/op", "vazão");
+    benchCPU();
+    benchMemory();
+    benchCartridge();
+    benchPPU();
+    benchAPU();
+    benchState();
+    benchLockstep();
+    benchThumbnail();
+    benchVideoFilter();
+    return 0;
+}
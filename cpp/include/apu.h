@@ -2,24 +2,61 @@
 #define APU_H
 
 #include <cstdint>
+#include <cstddef>
 #include <array>
-#include <queue>
+
+class StateWriter;
+class StateReader;
 
 /**
  * Audio Processing Unit (APU) do NES
  */
 class APU {
 public:
+    // Uma amostra por step(), isto é, por ciclo de CPU (NTSC); o host
+    // reamostra para a taxa do dispositivo
+    static constexpr uint32_t SAMPLE_RATE = 1789773;
+    static constexpr size_t SAMPLES_PER_FRAME = 29781;
+    
     APU();
     
     uint8_t read(uint16_t addr);
     void write(uint16_t addr, uint8_t value);
     
     void step();
+    // Mesmo efeito de 'count' chamadas a step(); sem síntese pula direto
+    // para o próximo passo do frame sequencer
+    void run(uint64_t count);
     void reset();
     
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    
     float getSample();
-    bool hasAudioData() const { return !audioBuffer.empty(); }
+    bool hasAudioData() const { return audioCount > 0; }
+    
+    // Buffer circular de amostras pertence ao chamador; nullptr desliga o áudio.
+    // Quando cheio, amostras novas são descartadas (contadas em overruns).
+    void setAudioBuffer(float* buffer, size_t capacity);
+    size_t getAudioCount() const { return audioCount; }
+    size_t getAudioCapacity() const { return audioCapacity; }
+    // Leitura sem cópia: a amostra mais antiga está em buffer[getAudioHead()]
+    // e as seguintes dão a volta no fim do buffer
+    size_t getAudioHead() const { return audioHead; }
+    void consumeAudio(size_t count);
+    uint64_t getAudioOverruns() const { return audioOverruns; }
+    
+    // Modo headless: pula a síntese, mantém length counters e IRQ de frame
+    void setSynthesisEnabled(bool enabled) { synthesisEnabled = enabled; }
+    bool isSynthesisEnabled() const { return synthesisEnabled; }
+    
+    // Fast-forward: cada amostra de saída é a média de 'factor' amostras
+    void setDecimation(uint32_t factor);
+    
+    bool irqRequested() const { return frameIrqFlag; }
+    // step()s até o próximo IRQ de frame (UINT32_MAX se inibido ou no modo
+    // de 5 passos)
+    uint32_t cyclesUntilIRQ() const;
     
 private:
     // Registradores
@@ -49,10 +86,30 @@ private:
     uint8_t statusReg;
     uint8_t frameCounter;
     
+    // Frame sequencer e length counters (pulse 1, pulse 2, triangle, noise)
+    std::array<uint8_t, 4> lengthCounters;
+    uint32_t frameCycle;
+    bool frameIrqFlag;
+    
     // Estado interno
-    std::queue<float> audioBuffer;
+    bool synthesisEnabled;
+    uint32_t decimation;
+    uint32_t decimationCount;
+    float decimationSum;
+    float* audioBuffer;
+    size_t audioCapacity;
+    size_t audioHead;
+    size_t audioCount;
+    uint64_t audioOverruns;
     uint64_t cycles;
     
+    void pushSample(float sample);
+    void loadLengthCounter(int channel, uint8_t value);
+    void clockFrameSequencer();
+    uint32_t nextFrameStep() const;
+    void quarterFrame();
+    void halfFrame();
+    
     float generatePulse(uint8_t channel);
     float generateTriangle();
     float generateNoise();
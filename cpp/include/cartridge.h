@@ -2,41 +2,105 @@
 #define CARTRIDGE_H
 
 #include <cstdint>
+#include <cstddef>
+#include <array>
 #include <vector>
-#include <memory>
+
+class StateWriter;
+class StateReader;
 
 /**
  * Gerenciador de cartucho NES com suporte a múltiplos mappers
+ *
+ * O mapeamento de PRG, CHR e nametables é mantido em tabelas de páginas que
+ * só mudam quando o jogo troca de banco ou de espelhamento; cada acesso vira
+ * ponteiro de página + offset.
  */
 class Cartridge {
 public:
+    enum Mirroring {
+        MIRROR_HORIZONTAL = 0,
+        MIRROR_VERTICAL = 1,
+        MIRROR_SINGLE_LOW = 2,   // Uma tela, CIRAM $000
+        MIRROR_SINGLE_HIGH = 3,  // Uma tela, CIRAM $400
+        MIRROR_FOUR_SCREEN = 4,  // 2KB extras de VRAM no cartucho
+    };
+    
     Cartridge();
     
     bool loadROM(const uint8_t* data, size_t size);
     
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    
     uint8_t readPRG(uint16_t addr);
     void writePRG(uint16_t addr, uint8_t value);
     
-    uint8_t readCHR(uint16_t addr);
+    // Ponteiro direto para PRG RAM/ROM em $6000-$FFFF (nullptr fora do mapa)
+    const uint8_t* getPRGPointer(uint16_t addr) const;
+    // Offset na PRG ROM do byte mapeado em addr ($8000-$FFFF)
+    size_t getPRGOffset(uint16_t addr) const {
+        if (addr < 0x8000 || prgRom.empty()) {
+            return SIZE_MAX;
+        }
+        return (prgPages[(addr >> 13) & 0x03] - prgRom.data()) + (addr & 0x1FFF);
+    }
+    size_t getPRGSize() const { return prgRom.size(); }
+    const uint8_t* getPRGData() const { return prgRom.data(); }
+    
+    uint8_t readCHR(uint16_t addr) const { return chrPages[(addr >> 10) & 0x07][addr & 0x3FF]; }
     void writeCHR(uint16_t addr, uint8_t value);
     
+    // CIRAM de 2KB da PPU, destino das nametables. Também reconstrói as
+    // tabelas de páginas: chamar de novo depois de copiar o cartucho.
+    void setCIRAM(uint8_t* ciram);
+    
+    // Tabelas de páginas de 1KB lidas diretamente pela PPU; os ponteiros
+    // para as tabelas são estáveis, o conteúdo muda com bancos/espelhamento
+    const uint8_t* const* getCHRPages() const { return chrPages.data(); }
+    uint8_t* const* getNametablePages() const { return nametablePages.data(); }
+    
     int getMapperNumber() const { return mapperNumber; }
     bool hasBattery() const { return batteryBacked; }
     int getMirroring() const { return mirroring; }
+    // Hash da imagem PRG/CHR, identifica a ROM em save states e filmes
+    uint64_t getROMHash() const { return romHash; }
+    
+    // Tamanho da imagem PRG/CHR (imutável, fora do bloco de estado)
+    size_t getROMBytes() const { return prgRom.size() + chrRom.size() + extraVram.size(); }
     
     // IRQ
     bool irqRequested() const { return irqFlag; }
     void resetIRQ() { irqFlag = false; }
     
+    // Contador de scanlines do MMC3, clocado pelas subidas de A12 que a PPU
+    // calcula (ver PPU::syncMapperIRQ)
+    bool hasScanlineIRQ() const { return mapperNumber == 4; }
+    // Uma subida de A12 filtrada; pode levantar o IRQ
+    void clockScanlineCounter();
+    // clocks subidas de uma vez, sabendo que nenhuma delas levanta o IRQ
+    void advanceScanlineCounter(uint32_t clocks);
+    // Clocks até o próximo IRQ (o último deles o levanta); UINT32_MAX desligado
+    uint32_t scanlineClocksUntilIRQ() const;
+
 private:
     int mapperNumber;
     bool batteryBacked;
     int mirroring;
+    uint64_t romHash;
     
+    // ROM imutável em heap; RAMs mutáveis inline no objeto
     std::vector<uint8_t> prgRom;
     std::vector<uint8_t> chrRom;
-    std::vector<uint8_t> prgRam;
-    std::vector<uint8_t> chrRam;
+    std::array<uint8_t, 0x2000> prgRam;  // 8KB PRG RAM
+    std::array<uint8_t, 0x2000> chrRam;  // 8KB CHR RAM (quando não há CHR ROM)
+    std::vector<uint8_t> extraVram;      // 2KB, só em cartuchos four-screen
+    
+    // Páginas mapeadas (recalculadas por updateBanks)
+    uint8_t* ciram;
+    std::array<const uint8_t*, 4> prgPages;  // 8KB cada, $8000-$FFFF
+    std::array<uint8_t*, 8> chrPages;        // 1KB cada, $0000-$1FFF
+    std::array<uint8_t*, 4> nametablePages;  // 1KB cada, $2000-$2FFF
     
     bool irqFlag;
     
@@ -51,6 +115,20 @@ private:
     uint8_t chrBankD;
     uint8_t chrBankE;
     uint8_t chrBankF;
+    uint8_t mmc1Shift;       // Registrador serial (bit 4 marca o fim)
+    uint8_t mmc1Control;
+    uint8_t mmc3BankSelect;
+    uint8_t mmc3IrqLatch;
+    uint8_t mmc3IrqCounter;
+    bool mmc3IrqReload;
+    bool mmc3IrqEnabled;
+    
+    void updateBanks();
+    void updateNametables();
+    void mapPRG8(int slot, size_t bank);
+    void mapPRG16(int slot, size_t bank);
+    void mapCHR1(int slot, size_t bank);
+    void mapCHR4(int slot, size_t bank);
     
     // Mapper-specific
     void writeMapper0(uint16_t addr, uint8_t value);
@@ -59,13 +137,6 @@ private:
     void writeMapper3(uint16_t addr, uint8_t value);
     void writeMapper4(uint16_t addr, uint8_t value);
     void writeMapper7(uint16_t addr, uint8_t value);
-    
-    uint8_t readMapper0(uint16_t addr);
-    uint8_t readMapper1(uint16_t addr);
-    uint8_t readMapper2(uint16_t addr);
-    uint8_t readMapper3(uint16_t addr);
-    uint8_t readMapper4(uint16_t addr);
-    uint8_t readMapper7(uint16_t addr);
 };
 
 #endif // CARTRIDGE_H
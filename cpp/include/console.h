@@ -2,62 +2,277 @@
 #define CONSOLE_H
 
 #include <cstdint>
+#include <cstddef>
 #include <memory>
 #include <array>
+#include <atomic>
+#include <vector>
 
 class CPU;
 class PPU;
 class APU;
 class Memory;
 class Cartridge;
+class Controller;
+class Profiler;
+class TelemetryRing;
+class Tracer;
+class DecodeCache;
+class RenderPipeline;
+class StateWriter;
+struct DirtyRows;
+template <typename T, size_t Capacity> class SPSCQueue;
+
+// Flags do modo headless (combináveis)
+enum HeadlessFlags : uint8_t {
+    HEADLESS_NONE = 0,
+    HEADLESS_NO_VIDEO = 1 << 0,  // Sem composição de pixels
+    HEADLESS_NO_AUDIO = 1 << 1,  // Sem síntese de amostras
+    HEADLESS_ALL = HEADLESS_NO_VIDEO | HEADLESS_NO_AUDIO,
+};
+
+/**
+ * Mudança de estado de um controle, produzida pela thread de UI
+ */
+struct InputEvent {
+    uint64_t frame;      // Frame emulado a partir do qual vale (0 = próximo)
+    uint64_t timestamp;  // Relógio do host em ns, para medir latência (0 = sem)
+    uint8_t port;
+    uint8_t buttons;     // Estado completo da porta (Controller::Button)
+};
+
+/**
+ * Tempo de host gasto em runFrame, dividido entre os componentes pela
+ * proporção medida nas instruções amostradas (soma dos FrameTelemetry)
+ */
+struct ComponentTimings {
+    uint64_t frameNs;   // Total medido (relógio lido só nas fronteiras de frame)
+    uint64_t cpuNs;
+    uint64_t ppuNs;
+    uint64_t apuNs;
+    uint64_t mapperNs;  // Escritas em registradores do mapper
+    uint64_t outputNs;  // Entrega do frame (espera pelo pipeline)
+    uint64_t samples;   // Instruções cronometradas
+};
 
 /**
  * Emulador NES completo
+ *
+ * Todo o estado mutável (CPU, RAM, PPU, APU, cartucho) fica em um único bloco
+ * alinhado à cache line. Os buffers de vídeo e áudio são opcionais: no modo
+ * compacto nenhum é alocado e o chamador pode fornecer os seus.
+ *
+ * Orçamento por instância no modo compacto: COMPACT_INSTANCE_BYTES (24KB)
+ * mais a imagem PRG/CHR da ROM. O cache de instruções (~16 bytes por byte
+ * de código executado, 512KB para 32KB de código) é um só para todas as
+ * instâncias da mesma ROM e não entra na conta por instância. 1000
+ * instâncias de um jogo de 256KB cabem em ~280MB.
  */
 class Console {
 public:
-    Console();
+    static constexpr size_t COMPACT_INSTANCE_BYTES = 24 * 1024;
+    // Amostras; dois frames de APU::SAMPLES_PER_FRAME com folga, para o
+    // host drenar entre frames sem overrun
+    static constexpr size_t DEFAULT_AUDIO_CAPACITY = 65536;
+    static constexpr int MAX_FAST_FORWARD = 16;
+    
+    explicit Console(bool compact = false);
     ~Console();
     
     bool loadROM(const uint8_t* data, size_t size);
     void reset();
+    // Roda um frame de host: fastForward frames emulados completos
     void runFrame();
     void runCycle();
     
+    // nullptr quando não há buffer de vídeo. Com pipeline, ver a validade
+    // do ponteiro em setPipelined.
     const uint8_t* getFrameBuffer() const;
+    // Linhas do vídeo alteradas desde a última chamada (DirtyRows, ppu.h),
+    // para o host atualizar só parte da textura. Sem nenhuma o frame é
+    // idêntico ao último consumido e nem precisa ser apresentado.
+    DirtyRows takeDirtyRows();
+    bool isFrameIdentical() const;
     float getAudioSample();
     bool hasAudioData() const;
+    // Leitura sem cópia do buffer de áudio do chamador: devolve quantas
+    // amostras estão prontas a partir de buffer[head] (com volta no fim);
+    // consumeAudio libera as já lidas
+    size_t getAudioAvailable(size_t& head) const;
+    void consumeAudio(size_t count);
+    // Amostras descartadas com o anel cheio
+    uint64_t getAudioOverruns() const;
     
+    // Buffers de saída do chamador (nullptr desliga a saída correspondente).
+    // O vídeo é RGB 256x240 (PPU::FRAME_BUFFER_SIZE bytes).
+    void setFrameBuffer(uint8_t* buffer);
+    void setAudioBuffer(float* buffer, size_t capacity);
+    
+    // Entrada: uma thread produtora (UI) e a thread de emulação consumindo.
+    // Os eventos são aplicados no início do frame alvo, antes do NMI em que
+    // os jogos leem os controles; o resultado não depende do relógio do host.
+    static constexpr size_t INPUT_QUEUE_CAPACITY = 64;
+    // button: 0-7 = A, B, Select, Start, Cima, Baixo, Esquerda, Direita (porta 0)
     void setButtonState(int button, bool pressed);
+    // Estado completo da porta no próximo frame. Se a fila estiver cheia o
+    // estado mais novo fica guardado à parte e vale depois dos eventos da
+    // fila (sem timestamp): nunca se perde.
+    void setButtons(int port, uint8_t buttons);
+    // false se a fila estiver cheia
+    bool pushInput(const InputEvent& event);
+    // Reprodução de filme, só na thread de emulação: os botões das duas
+    // portas (porta 1 no byte alto) valem a partir do próximo frame e não
+    // passam pela fila. Enquanto a reprodução durar, eventos da UI são
+    // descartados no início de cada frame.
+    void setMoviePlayback(bool enabled);
+    void setMovieButtons(uint16_t buttons);
+    // Botões aplicados das duas portas (porta 1 no byte alto), carga atômica
+    uint16_t getButtons() const;
+    // Botões que cada frame emulado do último runFrame viu (vários em
+    // fast-forward), na ordem; frame < getBatchFrames()
+    int getBatchFrames() const { return batchFrames; }
+    uint16_t getBatchButtons(int frame) const;
+    uint64_t getLastInputTimestamp() const { return lastInputTimestamp; }
     
-    // Save states
+    // Save states: estado completo de CPU, RAM, PPU, APU, cartucho e
+    // controles. O tamanho é fixo para uma ROM carregada.
+    size_t getStateSize() const;
+    // Grava no buffer do chamador sem alocar; devolve os bytes escritos ou 0
+    size_t saveState(uint8_t* buffer, size_t capacity) const;
     std::vector<uint8_t> getState() const;
+    // Rejeita estados de outra ROM, de tamanho inválido ou com campos fora
+    // da faixa (dados corrompidos) sem alterar nada
     bool setState(const uint8_t* data, size_t size);
+    uint64_t getROMHash() const;
     
     // Configurações
-    void setEmulationSpeed(float speed) { emulationSpeed = speed; }
+    // Velocidade é arredondada para o fator de fast-forward (1x a 16x);
+    // câmera lenta fica a cargo do ritmo do host
+    void setEmulationSpeed(float speed);
     float getEmulationSpeed() const { return emulationSpeed; }
     
+    // Fast-forward: K frames emulados por runFrame, compondo só o último e
+    // comprimindo o áudio para manter a taxa de amostras
+    void setFastForward(int frames);
+    int getFastForward() const { return fastForwardFrames; }
+    
     void setShowFPS(bool show) { showFPS = show; }
     bool getShowFPS() const { return showFPS; }
     
+    // Headless mantém vblank/NMI, sprite 0 hit, overflow e IRQs exatos
+    void setHeadless(uint8_t flags);
+    uint8_t getHeadless() const { return headlessFlags; }
+    
+    // Pipeline: a composição de vídeo roda em uma segunda thread, no máximo
+    // um frame atrás da CPU. getFrameBuffer() devolve o último frame completo
+    // de um par de buffers do pipeline. A thread de renderização só escreve
+    // no outro buffer do par, e só volta a este com os eventos do próximo
+    // frame. O ponteiro e o conteúdo valem até a próxima chamada que emula ou
+    // reinicia o console (runFrame, runCycle, reset, loadROM, setState,
+    // setPipelined); quem precisar do frame além disso deve copiá-lo antes.
+    // Duas chamadas seguidas podem devolver ponteiros diferentes, se um
+    // frame terminar entre elas. Em máquinas com um núcleo só o console
+    // continua serial (isPipelined() diz qual modo valeu).
+    void setPipelined(bool enabled);
+    bool isPipelined() const { return pipeline != nullptr; }
+    
+    // Cache de instruções decodificadas da PRG ROM (ligado por padrão).
+    // Ocupa ~16 bytes por byte de código executado, compartilhados por
+    // todas as instâncias da mesma ROM; desligar economiza essa memória ao
+    // custo de decodificar sempre.
+    void setDecodeCacheEnabled(bool enabled);
+    bool isDecodeCacheEnabled() const { return decodeCache != nullptr; }
+    
+    bool isCompact() const { return compact; }
+    // Bytes ocupados por esta instância (estado + buffers próprios + ROM
+    // + parcela do cache de instruções compartilhado)
+    size_t getMemoryFootprint() const;
+    
+    // Divisão do tempo entre CPU, PPU e APU: cronometra uma instrução a cada
+    // ~TIMING_SAMPLE_INTERVAL (intervalo pseudoaleatório, sem aliasing com
+    // laços do jogo), desconta o custo do relógio e reparte o tempo total
+    // dos frames pela proporção. Desligado custa um desvio por instrução.
+    static constexpr uint32_t TIMING_SAMPLE_INTERVAL = 16;
+    void setTimingEnabled(bool enabled);
+    bool isTimingEnabled() const { return timingEnabled; }
+    ComponentTimings getTimings() const;
+    void resetTimings();
+    // Um FrameTelemetry por frame emulado enquanto o timing está ligado;
+    // leitura sem lock de qualquer thread. nullptr antes do primeiro
+    // setTimingEnabled(true).
+    const TelemetryRing* getTelemetry() const { return telemetry.get(); }
+    
+    // Contadores do profiler; nullptr em builds sem NES_PROFILE
+    Profiler* getProfiler();
+    
+    // Trace binário de instruções em anel (capacidade em registros, 0 =
+    // Tracer::DEFAULT_CAPACITY). Desligar mantém o anel para o dump; ligar
+    // de novo o limpa.
+    void setTraceEnabled(bool enabled, size_t capacity = 0);
+    bool isTraceEnabled() const { return traceEnabled; }
+    const Tracer* getTracer() const { return tracer.get(); }
+    
     uint64_t getCycles() const;
     uint64_t getFrameCount() const { return frameCount; }
-    
+
 private:
-    std::shared_ptr<CPU> cpu;
-    std::shared_ptr<PPU> ppu;
-    std::shared_ptr<APU> apu;
-    std::shared_ptr<Memory> memory;
-    std::shared_ptr<Cartridge> cartridge;
+    friend class LockstepEngine;
+    
+    struct Core;
+    
+    std::unique_ptr<Core> core;
+    CPU* cpu;
+    PPU* ppu;
+    APU* apu;
+    Memory* memory;
+    Cartridge* cartridge;
+    Controller* controller;
+    
+    std::unique_ptr<RenderPipeline> pipeline;
+    std::unique_ptr<Profiler> profiler;
+    std::unique_ptr<TelemetryRing> telemetry;
+    std::unique_ptr<Tracer> tracer;
+    std::unique_ptr<DecodeCache> decodeCache;
+    
+    // Buffers próprios (vazios no modo compacto)
+    std::vector<uint8_t> videoStorage;
+    std::vector<float> audioStorage;
     
     uint64_t frameCount;
-    uint64_t cyclesPerFrame;
+    int fastForwardFrames;
+    int batchFrames;
+    std::array<uint16_t, MAX_FAST_FORWARD> batchButtons;
     float emulationSpeed;
     bool showFPS;
+    bool compact;
+    uint8_t headlessFlags;
+    bool traceEnabled;
+    
+    std::unique_ptr<SPSCQueue<InputEvent, INPUT_QUEUE_CAPACITY>> inputQueue;
+    InputEvent pendingInput;
+    bool hasPendingInput;
+    bool moviePlayback;
+    uint64_t lastInputTimestamp;
+    std::atomic<uint16_t> hostButtons;  // Último estado de setButtons (porta 1 no byte alto)
+    std::atomic<uint8_t> droppedPorts;  // Portas com evento fora da fila cheia
     
-    std::array<bool, 8> buttonStates;  // A, B, Select, Start, Up, Down, Left, Right
+    bool timingEnabled;
+    uint32_t timingCountdown;
+    uint32_t timingSeed;
+    uint32_t clockOverheadNs;
+    uint64_t sampledNs[3];  // CPU, PPU, APU
+    ComponentTimings totals;
     
+    void runEmulatedFrame();
+    void runEmulatedFrameTimed();
+    void applyInput();
+    void runCycleTimed();
+    // Ciclos de CPU que PPU e APU podem ficar atrás sem mudar nada visível
+    uint64_t deviceBudget() const;
+    void writeState(StateWriter& out) const;
+    bool readState(const uint8_t* data, size_t size);
+    void setFrameVideo(bool compose);
+    void restartPipeline();
     void handleInterrupts();
 };
 
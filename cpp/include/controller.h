@@ -0,0 +1,61 @@
+#ifndef CONTROLLER_H
+#define CONTROLLER_H
+
+#include <atomic>
+#include <cstdint>
+
+class StateWriter;
+class StateReader;
+
+/**
+ * Portas de controle do NES ($4016/$4017)
+ *
+ * Cada porta é um registrador de deslocamento de 8 bits: enquanto o strobe
+ * ($4016 bit 0) está em 1 ele recarrega o estado dos botões; cada leitura
+ * devolve um bit na ordem A, B, Select, Start, Cima, Baixo, Esquerda, Direita
+ * e, depois do oitavo, 1.
+ *
+ * Os botões das duas portas ficam em um único atômico: outra thread lê o
+ * estado inteiro com uma carga só.
+ */
+class Controller {
+public:
+    enum Button : uint8_t {
+        BUTTON_A = 0x01,
+        BUTTON_B = 0x02,
+        BUTTON_SELECT = 0x04,
+        BUTTON_START = 0x08,
+        BUTTON_UP = 0x10,
+        BUTTON_DOWN = 0x20,
+        BUTTON_LEFT = 0x40,
+        BUTTON_RIGHT = 0x80,
+    };
+    
+    static constexpr int PORT_COUNT = 2;
+    
+    Controller();
+    
+    // $4016 escrita: strobe das duas portas
+    void write(uint8_t value);
+    // $4016 (porta 0) / $4017 (porta 1)
+    uint8_t read(int port);
+    
+    void reset();
+    
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    
+    void setButtons(int port, uint8_t buttons);
+    uint8_t getButtons(int port) const {
+        return (buttonState.load(std::memory_order_relaxed) >> (port * 8)) & 0xFF;
+    }
+    // Porta 0 nos bits 0-7, porta 1 nos bits 8-15
+    uint16_t getAllButtons() const { return buttonState.load(std::memory_order_relaxed); }
+    
+private:
+    std::atomic<uint16_t> buttonState;
+    uint8_t shift[PORT_COUNT];
+    bool strobe;
+};
+
+#endif // CONTROLLER_H
@@ -2,16 +2,42 @@
 #define CPU_H
 
 #include <cstdint>
-#include <memory>
 
 class Memory;
+class Profiler;
+class Tracer;
+class DecodeCache;
+class StateWriter;
+class StateReader;
+class CPU;
+struct CPUOps;
+
+// Executa uma instrução já decodificada; o PC já aponta para a seguinte
+using InstructionHandler = void (*)(CPU& cpu, uint16_t operand);
+
+/**
+ * Instrução decodificada: handler do opcode, operando já montado (byte
+ * imediato, endereço base ou deslocamento do desvio), tamanho e ciclos base.
+ * Não depende do endereço em que a instrução está.
+ */
+struct DecodedInstruction {
+    InstructionHandler handler;
+    uint16_t operand;
+    uint8_t opcode;
+    uint8_t length;
+    uint8_t cycles;
+};
 
 /**
  * Implementação otimizada da CPU 6502 em C++
+ *
+ * Cada instrução é decodificada uma vez em DecodedInstruction e despachada
+ * pelo ponteiro de handler. Código na PRG ROM vem do DecodeCache (se houver);
+ * código em RAM, PRG RAM ou I/O é buscado pelo barramento a cada execução.
  */
 class CPU {
 public:
-    explicit CPU(std::shared_ptr<Memory> memory);
+    explicit CPU(Memory* memory);
     
     // Registradores
     uint16_t pc;    // Program Counter
@@ -38,41 +64,39 @@ public:
     uint8_t getStatus() const;
     void setStatus(uint8_t status);
     
+    // Só tem efeito em builds com NES_PROFILE
+    void setProfiler(Profiler* profiler) { this->profiler = profiler; }
+    // Trace de instruções (nullptr desliga)
+    void setTracer(Tracer* tracer) { this->tracer = tracer; }
+    // Cache de instruções da PRG ROM (nullptr decodifica sempre)
+    void setDecodeCache(DecodeCache* cache) { decodeCache = cache; }
+    
+    // Decodifica a instrução cujos bytes começam em 'bytes' (opcode e até
+    // dois operandos)
+    static void decode(const uint8_t* bytes, DecodedInstruction& out);
+    
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+
 private:
-    std::shared_ptr<Memory> memory;
+    friend struct CPUOps;
+    
+    Memory* memory;
+    Profiler* profiler;
+    Tracer* tracer;
+    DecodeCache* decodeCache;
     
     void push(uint8_t value);
     uint8_t pop();
     void pushWord(uint16_t value);
     uint16_t popWord();
+    uint16_t readZeroPageWord(uint8_t addr);
     void setZN(uint8_t value);
     
-    void execute(uint8_t opcode);
+    void fetch(DecodedInstruction& out);
     void nmi();
     void irq();
     
-    // Modos de endereçamento
-    uint8_t immediate();
-    uint8_t zeroPage();
-    uint8_t zeroPageX();
-    uint8_t zeroPageY();
-    uint8_t absolute();
-    uint8_t absoluteX();
-    uint8_t absoluteY();
-    uint8_t indirectX();
-    uint8_t indirectY();
-    
-    uint16_t zeroPageAddr();
-    uint16_t zeroPageXAddr();
-    uint16_t zeroPageYAddr();
-    uint16_t absoluteAddr();
-    uint16_t absoluteXAddr();
-    uint16_t absoluteYAddr();
-    uint16_t indirectXAddr();
-    uint16_t indirectYAddr();
-    uint16_t indirectAddr();
-    
-    void branch();
     void adc(uint8_t value);
     void sbc(uint8_t value);
     void cmp(uint8_t reg, uint8_t value);
@@ -0,0 +1,67 @@
+#ifndef DECODE_CACHE_H
+#define DECODE_CACHE_H
+
+#include "cpu.h"
+#include "cartridge.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+/**
+ * Cache de instruções decodificadas da PRG ROM
+ *
+ * A chave é o offset do opcode na PRG ROM (banco + endereço), então a troca
+ * de bancos não invalida nada: cada banco tem as suas entradas. A ROM é
+ * imutável, logo uma entrada nunca fica velha; código em RAM e PRG RAM não
+ * passa pelo cache e é decodificado a cada execução.
+ *
+ * As entradas ficam em páginas de 256 bytes da ROM, decodificadas inteiras
+ * na primeira execução de qualquer byte delas: só o código executado ocupa
+ * memória. Uma página publicada não muda mais, por isso as páginas são
+ * compartilhadas (só leitura) por todas as instâncias da mesma ROM, em
+ * qualquer thread; cada DecodeCache guarda só o cartucho da sua instância,
+ * que define os bancos mapeados.
+ */
+class DecodeCache {
+public:
+    DecodeCache();
+    
+    // Passa a decodificar a PRG ROM deste cartucho, com as páginas das
+    // outras instâncias da mesma ROM
+    void attach(const Cartridge* cartridge);
+    
+    // nullptr fora da PRG ROM ou se a instrução cruza o fim da janela de 8KB
+    // (os bytes seguintes dependem de outro banco)
+    const DecodedInstruction* lookup(uint16_t pc) {
+        if (pc < 0x8000 || !slots) {
+            return nullptr;
+        }
+        size_t offset = cartridge->getPRGOffset(pc);
+        const Page* page = slots[offset >> 8].load(std::memory_order_acquire);
+        if (!page) {
+            page = fill(offset >> 8);
+        }
+        const DecodedInstruction& entry = page->entries[offset & 0xFF];
+        return entry.handler ? &entry : nullptr;
+    }
+    
+    // Parcela desta instância dos bytes das páginas (total dividido pelas
+    // instâncias que compartilham a ROM)
+    size_t getMemoryUsage() const;
+
+private:
+    struct Page {
+        DecodedInstruction entries[256];
+    };
+    struct Pages;
+    
+    const Cartridge* cartridge;
+    std::shared_ptr<Pages> pages;
+    std::atomic<const Page*>* slots;  // pages->slots, para o lookup inline
+    
+    const Page* fill(size_t index);
+};
+
+#endif // DECODE_CACHE_H
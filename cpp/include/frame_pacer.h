@@ -0,0 +1,124 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+
+class Console;
+
+/**
+ * Medidas de um frame do FramePacer (relógio monotônico do host, em ns)
+ */
+struct FramePacing {
+    uint64_t frame;           // Console::getFrameCount() depois do frame
+    uint64_t deadlineNs;      // Vsync alvo do frame
+    uint64_t wakeNs;          // Fim da espera: a entrada é lida a partir daqui
+    uint64_t emulateNs;       // Duração de Console::runFrame
+    uint64_t presentNs;       // Informado em framePresented
+    uint64_t inputLatencyNs;  // Fim da espera -> apresentação
+    uint64_t eventLatencyNs;  // InputEvent aplicado -> apresentação (0 = nenhum novo)
+    bool missed;              // Apresentado depois do deadline
+};
+
+/**
+ * Acumulados desde resetStats()
+ */
+struct PacerStats {
+    uint64_t frames;
+    uint64_t missed;
+    uint64_t events;             // Frames com InputEvent novo e timestamp
+    uint64_t emulateAvgNs;       // Estimativa corrente (média móvel)
+    uint64_t emulateJitterNs;    // Desvio médio da estimativa
+    uint64_t inputLatencyAvgNs;
+    uint64_t inputLatencyMaxNs;
+    uint64_t eventLatencyAvgNs;
+    uint64_t eventLatencyMaxNs;
+};
+
+/**
+ * Ritmo de frames "just in time" para o loop do host
+ *
+ * Em vez de emular logo depois de apresentar o frame anterior (e a entrada
+ * esperar quase um frame inteiro até a apresentação seguinte), o pacer
+ * dorme (clock_nanosleep absoluto) até pouco antes do próximo vsync, menos
+ * a estimativa do tempo de emulação, e só então o host lê a entrada e
+ * emula:
+ *
+ *     pacer.waitForFrame();
+ *     // ler a entrada -> console.pushInput(...)
+ *     pacer.runFrame();
+ *     // apresentar
+ *     pacer.framePresented();
+ *
+ * A estimativa é a média móvel do tempo de runFrame mais 4 desvios médios
+ * (como o RTO do TCP), mais o atraso médio de acordar do sleep e uma margem
+ * fixa. Os deadlines seguem uma grade anchor + n * período sem acumular
+ * erro; onVsync realinha a grade com o vsync real do host (Choreographer,
+ * CVDisplayLink...). Os timestamps de InputEvent têm de vir do mesmo
+ * relógio (nowNs(), CLOCK_MONOTONIC / System.nanoTime no Android).
+ *
+ * Com o pipeline ligado o frame apresentado é o anterior ao emulado, então
+ * as latências são atribuídas com um frame de atraso (limite superior).
+ */
+class FramePacer {
+public:
+    static constexpr double NTSC_REFRESH_HZ = 60.0988;
+    static constexpr uint64_t DEFAULT_MARGIN_NS = 500000;
+    
+    explicit FramePacer(Console& console, double refreshHz = NTSC_REFRESH_HZ);
+    
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+    
+    static uint64_t nowNs();
+    
+    // NTSC_REFRESH_HZ para o ritmo do console ou a taxa do display do host;
+    // taxas fora de (0, 1000] são ignoradas
+    void setRefreshRate(double hz);
+    double getRefreshRate() const { return 1e9 / periodNs; }
+    // Folga entre o fim estimado da emulação e o deadline
+    void setMargin(uint64_t ns) { marginNs = ns; }
+    
+    // Realinha os deadlines com um vsync do host (período 0 mantém a taxa)
+    void onVsync(uint64_t vsyncNs, uint64_t vsyncPeriodNs = 0);
+    
+    // Dorme até a hora de começar o frame; devolve o instante do despertar.
+    // Se o deadline já passou, pula para o próximo sem dormir.
+    uint64_t waitForFrame();
+    // Console::runFrame cronometrado (alimenta a estimativa)
+    void runFrame();
+    // presentNs 0 = agora; devolve as medidas do frame apresentado
+    FramePacing framePresented(uint64_t presentNs = 0);
+    
+    PacerStats getStats() const;
+    void resetStats();
+
+private:
+    Console& console;
+    
+    double periodNs;
+    uint64_t anchorNs;
+    uint64_t nextIndex;     // Próximo deadline = anchorNs + nextIndex * periodNs
+    uint64_t marginNs;
+    
+    int64_t emulateAvgNs;
+    int64_t emulateDevNs;
+    int64_t wakeLateNs;     // Atraso médio do despertar em relação ao pedido
+    bool hasEstimate;
+    
+    uint64_t waitDeadlineNs;  // Resultado de waitForFrame para o próximo runFrame
+    uint64_t waitWakeNs;      // (0 = runFrame sem espera)
+    
+    FramePacing current;    // Frame emulado por último
+    FramePacing previous;   // Frame antes dele (apresentado no modo pipeline)
+    uint64_t seenInputTimestamp;
+    uint64_t currentEventNs;
+    uint64_t previousEventNs;
+    
+    PacerStats stats;
+    uint64_t inputLatencySumNs;
+    uint64_t eventLatencySumNs;
+    
+    uint64_t deadline(uint64_t index) const;
+};
+
+#endif // FRAME_PACER_H
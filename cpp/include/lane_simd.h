@@ -0,0 +1,113 @@
+#ifndef LANE_SIMD_H
+#define LANE_SIMD_H
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NES_LANES_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define NES_LANES_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * 16 bytes processados juntos, um por instância (lane) do LockstepEngine
+ *
+ * SSE2 em x86, NEON em ARM64 e laço escalar nos demais alvos. Máscaras são
+ * 0xFF (verdadeiro) / 0x00 (falso) por byte. As sobrecargas de uint8_t
+ * deixam o mesmo código genérico rodar em uma instância só.
+ */
+namespace lanes {
+
+constexpr int WIDTH = 16;
+
+#if defined(NES_LANES_SSE2)
+
+struct Bytes { __m128i v; };
+
+inline Bytes load(const uint8_t* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+inline void store(uint8_t* p, Bytes a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a.v); }
+inline Bytes splat(uint8_t value) { return {_mm_set1_epi8(static_cast<char>(value))}; }
+inline Bytes operator+(Bytes a, Bytes b) { return {_mm_add_epi8(a.v, b.v)}; }
+inline Bytes operator-(Bytes a, Bytes b) { return {_mm_sub_epi8(a.v, b.v)}; }
+inline Bytes operator&(Bytes a, Bytes b) { return {_mm_and_si128(a.v, b.v)}; }
+inline Bytes operator|(Bytes a, Bytes b) { return {_mm_or_si128(a.v, b.v)}; }
+inline Bytes operator^(Bytes a, Bytes b) { return {_mm_xor_si128(a.v, b.v)}; }
+inline Bytes equal(Bytes a, Bytes b) { return {_mm_cmpeq_epi8(a.v, b.v)}; }
+// a >= b sem sinal
+inline Bytes greaterEqual(Bytes a, Bytes b) { return {_mm_cmpeq_epi8(_mm_max_epu8(a.v, b.v), a.v)}; }
+inline Bytes select(Bytes mask, Bytes a, Bytes b) {
+    return {_mm_or_si128(_mm_and_si128(mask.v, a.v), _mm_andnot_si128(mask.v, b.v))};
+}
+inline Bytes shiftLeft1(Bytes a) { return {_mm_add_epi8(a.v, a.v)}; }
+inline Bytes shiftRight1(Bytes a) { return {_mm_and_si128(_mm_srli_epi16(a.v, 1), _mm_set1_epi8(0x7F))}; }
+
+#elif defined(NES_LANES_NEON)
+
+struct Bytes { uint8x16_t v; };
+
+inline Bytes load(const uint8_t* p) { return {vld1q_u8(p)}; }
+inline void store(uint8_t* p, Bytes a) { vst1q_u8(p, a.v); }
+inline Bytes splat(uint8_t value) { return {vdupq_n_u8(value)}; }
+inline Bytes operator+(Bytes a, Bytes b) { return {vaddq_u8(a.v, b.v)}; }
+inline Bytes operator-(Bytes a, Bytes b) { return {vsubq_u8(a.v, b.v)}; }
+inline Bytes operator&(Bytes a, Bytes b) { return {vandq_u8(a.v, b.v)}; }
+inline Bytes operator|(Bytes a, Bytes b) { return {vorrq_u8(a.v, b.v)}; }
+inline Bytes operator^(Bytes a, Bytes b) { return {veorq_u8(a.v, b.v)}; }
+inline Bytes equal(Bytes a, Bytes b) { return {vceqq_u8(a.v, b.v)}; }
+inline Bytes greaterEqual(Bytes a, Bytes b) { return {vcgeq_u8(a.v, b.v)}; }
+inline Bytes select(Bytes mask, Bytes a, Bytes b) { return {vbslq_u8(mask.v, a.v, b.v)}; }
+inline Bytes shiftLeft1(Bytes a) { return {vshlq_n_u8(a.v, 1)}; }
+inline Bytes shiftRight1(Bytes a) { return {vshrq_n_u8(a.v, 1)}; }
+
+#else
+
+struct Bytes { uint8_t v[WIDTH]; };
+
+template <typename F>
+inline Bytes map(Bytes a, Bytes b, F f) {
+    Bytes r;
+    for (int i = 0; i < WIDTH; i++) {
+        r.v[i] = static_cast<uint8_t>(f(a.v[i], b.v[i]));
+    }
+    return r;
+}
+
+inline Bytes load(const uint8_t* p) { Bytes r; std::memcpy(r.v, p, WIDTH); return r; }
+inline void store(uint8_t* p, Bytes a) { std::memcpy(p, a.v, WIDTH); }
+inline Bytes splat(uint8_t value) { Bytes r; std::memset(r.v, value, WIDTH); return r; }
+inline Bytes operator+(Bytes a, Bytes b) { return map(a, b, [](uint8_t x, uint8_t y) { return x + y; }); }
+inline Bytes operator-(Bytes a, Bytes b) { return map(a, b, [](uint8_t x, uint8_t y) { return x - y; }); }
+inline Bytes operator&(Bytes a, Bytes b) { return map(a, b, [](uint8_t x, uint8_t y) { return x & y; }); }
+inline Bytes operator|(Bytes a, Bytes b) { return map(a, b, [](uint8_t x, uint8_t y) { return x | y; }); }
+inline Bytes operator^(Bytes a, Bytes b) { return map(a, b, [](uint8_t x, uint8_t y) { return x ^ y; }); }
+inline Bytes equal(Bytes a, Bytes b) { return map(a, b, [](uint8_t x, uint8_t y) { return x == y ? 0xFF : 0; }); }
+inline Bytes greaterEqual(Bytes a, Bytes b) { return map(a, b, [](uint8_t x, uint8_t y) { return x >= y ? 0xFF : 0; }); }
+inline Bytes select(Bytes mask, Bytes a, Bytes b) { return (mask & a) | (b & (mask ^ splat(0xFF))); }
+inline Bytes shiftLeft1(Bytes a) { return a + a; }
+inline Bytes shiftRight1(Bytes a) { return map(a, a, [](uint8_t x, uint8_t) { return x >> 1; }); }
+
+#endif
+
+// Máscara do bit 'bit' (0-7) de cada byte
+inline Bytes testBit(Bytes a, int bit) {
+    Bytes m = splat(static_cast<uint8_t>(1 << bit));
+    return equal(a & m, m);
+}
+
+inline Bytes isZero(Bytes a) { return equal(a, splat(0)); }
+
+// Mesmas operações para uma lane só (caminho escalar do LockstepEngine)
+inline uint8_t equal(uint8_t a, uint8_t b) { return a == b ? 0xFF : 0x00; }
+inline uint8_t greaterEqual(uint8_t a, uint8_t b) { return a >= b ? 0xFF : 0x00; }
+inline uint8_t select(uint8_t mask, uint8_t a, uint8_t b) { return (mask & a) | (~mask & b); }
+inline uint8_t shiftLeft1(uint8_t a) { return static_cast<uint8_t>(a << 1); }
+inline uint8_t shiftRight1(uint8_t a) { return a >> 1; }
+inline uint8_t testBit(uint8_t a, int bit) { return (a >> bit) & 1 ? 0xFF : 0x00; }
+inline uint8_t isZero(uint8_t a) { return a == 0 ? 0xFF : 0x00; }
+
+}  // namespace lanes
+
+#endif // LANE_SIMD_H
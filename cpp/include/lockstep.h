@@ -0,0 +1,123 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "lane_simd.h"
+
+#include <cstdint>
+#include <cstddef>
+
+class Console;
+class CPU;
+class PPU;
+class APU;
+class Memory;
+class Cartridge;
+struct DecodedInstruction;
+struct LaneOps;
+
+/**
+ * Contadores do LockstepEngine: quantas rodadas executaram uma instrução em
+ * várias lanes (vetorial) ou em uma só (escalar), e o total de instruções
+ */
+struct LockstepStats {
+    uint64_t vectorSteps;    // Rodadas com 2+ lanes
+    uint64_t scalarSteps;    // Rodadas com uma lane
+    uint64_t laneSteps;      // Instruções executadas somando todas as lanes
+};
+
+/**
+ * Execução em lockstep de até MAX_LANES instâncias da mesma ROM (experimental)
+ *
+ * Durante o frame os registradores e a RAM de 2KB de todas as instâncias
+ * ficam em estrutura de arrays (ram[endereço][lane]) e cada rodada executa
+ * uma instrução em todas as lanes com o mesmo PC e os mesmos bytes de
+ * instrução, com operações SIMD de 16 bytes. Lanes cujo PC divergiu rodam
+ * sozinhas no caminho escalar até reconvergirem; a cada rodada vai a lane
+ * mais atrasada no tempo emulado junto com as que estão no mesmo PC.
+ *
+ * PPU, APU, cartucho e controles continuam sendo os de cada Console. Em vez
+ * de avançarem depois de cada instrução, como em Console::runCycle, os
+ * ciclos de cada lane se acumulam e são aplicados de uma vez antes de um
+ * acesso a I/O ou quando um vblank/IRQ pode ter acontecido (limites de
+ * PPU::dotsUntilVBlank e APU::cyclesUntilIRQ): o que a CPU observa é o
+ * mesmo, o resultado é idêntico ao de rodar as instâncias separadamente e
+ * a PPU de uma lane roda em blocos, sem disputar a cache com as outras 15
+ * a cada instrução. Entre frames o estado volta para os Consoles, então
+ * save states, filmes e entrada funcionam normalmente.
+ *
+ * Não usa pipeline, trace, profiler nem timing dos Consoles; fast-forward é
+ * ignorado (um frame emulado por runFrame).
+ */
+class LockstepEngine {
+public:
+    static constexpr int MAX_LANES = lanes::WIDTH;
+    
+    LockstepEngine();
+    
+    LockstepEngine(const LockstepEngine&) = delete;
+    LockstepEngine& operator=(const LockstepEngine&) = delete;
+    
+    // Os Consoles continuam do chamador e precisam estar com a mesma ROM
+    // carregada e sem pipeline; false (sem alterar nada) caso contrário
+    bool attach(Console* const* consoles, int count);
+    void detach();
+    int getLaneCount() const { return laneCount; }
+    
+    // Um frame emulado em cada instância, com a entrada aplicada como em
+    // Console::runFrame
+    void runFrame();
+    
+    const LockstepStats& getStats() const { return stats; }
+    void resetStats() { stats = {}; }
+
+private:
+    friend struct LaneOps;
+    
+    // Estado das CPUs em estrutura de arrays; flags são máscaras 0x00/0xFF
+    alignas(16) uint8_t ram[0x800][MAX_LANES];
+    alignas(16) uint8_t a[MAX_LANES];
+    alignas(16) uint8_t x[MAX_LANES];
+    alignas(16) uint8_t y[MAX_LANES];
+    alignas(16) uint8_t sp[MAX_LANES];
+    alignas(16) uint8_t flagC[MAX_LANES];
+    alignas(16) uint8_t flagZ[MAX_LANES];
+    alignas(16) uint8_t flagI[MAX_LANES];
+    alignas(16) uint8_t flagD[MAX_LANES];
+    alignas(16) uint8_t flagB[MAX_LANES];
+    alignas(16) uint8_t flagV[MAX_LANES];
+    alignas(16) uint8_t flagN[MAX_LANES];
+    uint16_t pc[MAX_LANES];
+    uint64_t cycles[MAX_LANES];
+    uint64_t stepStart[MAX_LANES];  // Ciclos no início da instrução em curso
+    uint64_t pending[MAX_LANES];    // Ciclos ainda não aplicados a PPU/APU
+    uint64_t budget[MAX_LANES];     // Ciclos acumuláveis sem perder evento
+    uint32_t touchedIO;             // Lanes que acessaram I/O nesta rodada
+    uint32_t irqLines;              // Lanes com fonte de IRQ ativa no último catch-up
+    bool nmiRequested[MAX_LANES];
+    bool irqRequested[MAX_LANES];
+    
+    // Componentes de cada lane (pertencem aos Consoles)
+    Console* consoles[MAX_LANES];
+    CPU* cpus[MAX_LANES];
+    PPU* ppus[MAX_LANES];
+    APU* apus[MAX_LANES];
+    Memory* memories[MAX_LANES];
+    Cartridge* cartridges[MAX_LANES];
+    int laneCount;
+    
+    LockstepStats stats;
+    
+    void loadLanes();
+    void storeLanes();
+    void beginStep(int lane);
+    void finishStep(int lane, uint32_t& running);
+    void catchUp(int lane);
+    void updateBudget(int lane);
+    uint32_t selectGroup(uint32_t running, DecodedInstruction& instruction);
+    void fetch(int lane, uint16_t addr, uint8_t* bytes);
+    
+    uint8_t readLane(int lane, uint16_t addr);
+    void writeLane(int lane, uint16_t addr, uint8_t value);
+};
+
+#endif // LOCKSTEP_H
@@ -3,11 +3,16 @@
 
 #include <cstdint>
 #include <array>
-#include <memory>
 
 class Cartridge;
+class CPU;
 class PPU;
 class APU;
+class Controller;
+class RenderPipeline;
+class Profiler;
+class StateWriter;
+class StateReader;
 
 /**
  * Gerenciador de memória do NES em C++
@@ -21,23 +26,64 @@ public:
     uint16_t readWord(uint16_t addr);
     void writeWord(uint16_t addr, uint16_t value);
     
-    void setCartridge(std::shared_ptr<Cartridge> cartridge);
-    void setPPU(std::shared_ptr<class PPU> ppu);
-    void setAPU(std::shared_ptr<class APU> apu);
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    
+    // Componentes vizinhos pertencem ao Console (ponteiros não proprietários)
+    void setCartridge(Cartridge* cartridge);
+    void setCPU(CPU* cpu);
+    void setPPU(PPU* ppu);
+    void setAPU(APU* apu);
+    void setController(Controller* controller);
+    // Modo pipeline: acessos à PPU e ao mapper são registrados para a
+    // thread de renderização (nullptr desliga)
+    void setPipeline(RenderPipeline* pipeline) { this->pipeline = pipeline; }
+    // Só tem efeito em builds com NES_PROFILE
+    void setProfiler(Profiler* profiler) { this->profiler = profiler; }
+    // Cronometra as escritas em registradores do mapper (telemetria)
+    void setMapperTiming(bool enabled) { mapperTiming = enabled; }
+    uint64_t getMapperNs() const { return mapperNs; }
+    
+    // PPU e APU podem ficar atrás da CPU (Console::runEmulatedFrame): os
+    // ciclos ainda não aplicados ficam aqui. Todo acesso a registradores
+    // ($2000-$5FFF) ou escrita no cartucho as alcança antes e fica marcado
+    // até takeDeviceAccess, para a checagem de interrupções.
+    void deferCycles(uint64_t cycles) { pendingCycles += cycles; }
+    uint64_t getPendingCycles() const { return pendingCycles; }
+    void syncDevices();
+    bool takeDeviceAccess() {
+        bool accessed = deviceAccess;
+        deviceAccess = false;
+        return accessed;
+    }
     
     // Acesso direto para performance
     uint8_t* getRam() { return ram.data(); }
     
+    // Página de 256 bytes sem efeitos colaterais (RAM, PRG RAM, PRG ROM);
+    // nullptr para páginas de I/O ou não mapeadas
+    const uint8_t* getPagePointer(uint8_t page) const;
+    
 private:
     std::array<uint8_t, 0x800> ram;  // 2KB RAM interno
-    std::shared_ptr<Cartridge> cartridge;
-    std::shared_ptr<class PPU> ppu;
-    std::shared_ptr<class APU> apu;
+    Cartridge* cartridge;
+    CPU* cpu;
+    PPU* ppu;
+    APU* apu;
+    Controller* controller;
+    RenderPipeline* pipeline;
+    Profiler* profiler;
+    bool mapperTiming;
+    bool deviceAccess;
+    uint64_t mapperNs;
+    uint64_t pendingCycles;
     
+    void writeMapper(uint16_t addr, uint8_t value);
     uint8_t readPPU(uint16_t addr);
     void writePPU(uint16_t addr, uint8_t value);
     uint8_t readAPU(uint16_t addr);
     void writeAPU(uint16_t addr, uint8_t value);
+    void oamDMA(uint8_t page);
 };
 
 #endif // MEMORY_H
@@ -0,0 +1,100 @@
+#ifndef MOVIE_H
+#define MOVIE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class Console;
+
+/**
+ * Filmes de entrada: gravação e reprodução determinística
+ *
+ * Formato (little-endian):
+ *   "NESM", versão, flags, hash da ROM, frames, tamanho do estado inicial,
+ *   tamanho da entrada, estado inicial (Console::saveState), entrada em RLE
+ *   (runs de varint comprimento + botões da porta 0 e 1) e, com
+ *   MOVIE_HASHES, dois hashes por frame (estado e frame buffer, 0 = sem).
+ *
+ * Um frame de filme é um frame emulado: a reprodução força fast-forward 1.
+ */
+class MovieRecorder {
+public:
+    MovieRecorder();
+    
+    // Começa do estado atual do console (normalmente logo após loadROM)
+    bool begin(const Console& console, bool withHashes = true);
+    // Chamar depois de cada runFrame; frames pulados em fast-forward
+    // entram com os botões que cada um viu e sem hash
+    void recordFrame(const Console& console);
+    // Serializa o filme e encerra a gravação
+    std::vector<uint8_t> finish();
+    
+    bool isRecording() const { return recording; }
+    uint32_t getFrameCount() const { return frameCount; }
+
+private:
+    bool recording;
+    bool withHashes;
+    uint64_t romHash;
+    uint64_t lastFrame;
+    uint32_t frameCount;
+    std::vector<uint8_t> startState;
+    std::vector<uint8_t> input;
+    std::vector<uint64_t> hashes;
+    std::vector<uint8_t> scratch;
+    
+    uint16_t runButtons;
+    uint32_t runLength;
+    
+    void flushRun();
+};
+
+class MoviePlayer {
+public:
+    MoviePlayer();
+    
+    bool load(const uint8_t* data, size_t size);
+    
+    // Restaura o estado inicial; false se a ROM carregada não for a do filme.
+    // Daqui até o fim da reprodução a entrada da UI é ignorada.
+    bool begin(Console& console);
+    // Roda um frame com a entrada gravada sem alocar; false no fim do filme
+    // ou quando o hash do frame diverge da gravação
+    bool step(Console& console);
+    // Devolve os controles à UI antes do fim (o fim e o desync já devolvem)
+    void end(Console& console);
+    
+    uint32_t getFrameCount() const { return frameCount; }
+    uint32_t getCurrentFrame() const { return currentFrame; }
+    bool isFinished() const { return currentFrame >= frameCount; }
+    bool hasDesynced() const { return desynced; }
+    // Primeiro frame divergente (válido com hasDesynced())
+    uint32_t getDesyncFrame() const { return desyncFrame; }
+    uint64_t getROMHash() const { return romHash; }
+
+private:
+    std::vector<uint8_t> data;
+    uint64_t romHash;
+    uint32_t frameCount;
+    bool withHashes;
+    size_t stateOffset;
+    size_t stateSize;
+    size_t inputOffset;
+    size_t inputSize;
+    size_t hashOffset;
+    std::vector<uint8_t> scratch;
+    
+    // Cursor do RLE
+    size_t inputPos;
+    uint32_t runRemaining;
+    uint16_t runButtons;
+    
+    uint32_t currentFrame;
+    bool desynced;
+    uint32_t desyncFrame;
+    
+    bool nextInput(uint16_t& buttons);
+};
+
+#endif // MOVIE_H
@@ -0,0 +1,219 @@
+#ifndef NES_API_H
+#define NES_API_H
+
+/**
+ * API C estável do núcleo, para JNI, ctypes e outros hosts de FFI
+ *
+ * Vídeo e áudio vão direto para buffers do chamador: nes_run_frame não aloca
+ * nem copia nada pela fronteira. Todas as funções de uma instância devem ser
+ * chamadas da mesma thread, exceto nes_push_input/nes_set_buttons (uma
+ * thread produtora de entrada).
+ *
+ * Compatibilidade: funções só são acrescentadas; NES_API_VERSION sobe quando
+ * isso acontece.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define NES_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#define NES_API __attribute__((visibility("default")))
+#else
+#define NES_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NES_API_VERSION 7
+
+#define NES_FRAME_WIDTH 256
+#define NES_FRAME_HEIGHT 240
+#define NES_FRAME_BYTES (NES_FRAME_WIDTH * NES_FRAME_HEIGHT * 3)  /* RGB24 */
+
+/* Áudio: float mono, uma amostra por ciclo de CPU (o host reamostra para a
+ * taxa do dispositivo). O anel só é drenado entre frames, então precisa de
+ * pelo menos um frame de amostras. */
+#define NES_AUDIO_SAMPLE_RATE 1789773
+#define NES_AUDIO_MIN_CAPACITY 29781
+
+typedef struct nes_console nes_console;
+typedef struct nes_video_filter nes_video_filter;
+typedef struct nes_frame_pacer nes_frame_pacer;
+typedef struct nes_state_saver nes_state_saver;
+
+typedef enum nes_result {
+    NES_OK = 0,
+    NES_ERROR_INVALID_ARGUMENT = -1,
+    NES_ERROR_INVALID_ROM = -2,
+    NES_ERROR_IO = -3,
+    NES_ERROR_BUFFER_TOO_SMALL = -4,
+    NES_ERROR_INVALID_STATE = -5,
+    NES_ERROR_OUT_OF_MEMORY = -6,
+} nes_result;
+
+/* Formatos de nes_encode_thumbnail (sem perdas, sem compressão de verdade) */
+typedef enum nes_image_format {
+    NES_IMAGE_QOI = 0,
+    NES_IMAGE_PNG = 1,
+} nes_image_format;
+
+/* Filtros de nes_filter_create */
+typedef enum nes_filter_type {
+    NES_FILTER_NEAREST = 0,
+    NES_FILTER_SMOOTH = 1,  /* Scale2x/Scale3x */
+    NES_FILTER_NTSC = 2,    /* Sinal composto simulado */
+} nes_filter_type;
+
+/* Botões (bits do estado de uma porta) */
+enum {
+    NES_BUTTON_A = 1 << 0,
+    NES_BUTTON_B = 1 << 1,
+    NES_BUTTON_SELECT = 1 << 2,
+    NES_BUTTON_START = 1 << 3,
+    NES_BUTTON_UP = 1 << 4,
+    NES_BUTTON_DOWN = 1 << 5,
+    NES_BUTTON_LEFT = 1 << 6,
+    NES_BUTTON_RIGHT = 1 << 7,
+};
+
+/* Flags de nes_set_headless */
+enum {
+    NES_HEADLESS_NO_VIDEO = 1 << 0,
+    NES_HEADLESS_NO_AUDIO = 1 << 1,
+};
+
+NES_API uint32_t nes_api_version(void);
+
+/* compact != 0: sem buffers próprios (use nes_set_video_buffer/audio).
+ * Devolve NULL sem memória. */
+NES_API nes_console* nes_create(int compact);
+NES_API void nes_destroy(nes_console* console);
+
+/* Imagem iNES; os dados são copiados e podem ser liberados em seguida */
+NES_API nes_result nes_load_rom(nes_console* console, const uint8_t* data, size_t size);
+/* Lê o descritor até o fim (não o fecha), ex. ParcelFileDescriptor */
+NES_API nes_result nes_load_rom_fd(nes_console* console, int fd);
+NES_API void nes_reset(nes_console* console);
+
+/* Buffers do chamador, válidos até serem trocados ou a instância destruída.
+ * Vídeo: NES_FRAME_BYTES de RGB24. Áudio: anel de 'capacity' floats, no
+ * mínimo NES_AUDIO_MIN_CAPACITY (senão NES_ERROR_BUFFER_TOO_SMALL).
+ * NULL desliga a saída correspondente. */
+NES_API nes_result nes_set_video_buffer(nes_console* console, uint8_t* rgb, size_t size);
+NES_API nes_result nes_set_audio_buffer(nes_console* console, float* samples, size_t capacity);
+
+/* Roda um frame de host (fast-forward frames emulados) */
+NES_API void nes_run_frame(nes_console* console);
+NES_API uint64_t nes_get_frame_count(const nes_console* console);
+/* Linhas do vídeo alteradas desde a última chamada (bit y de rows = linha y,
+ * rows pode ser NULL); devolve quantas. 0 = frame idêntico: o host pode
+ * pular o upload da textura e a apresentação. */
+NES_API int nes_take_dirty_rows(nes_console* console, uint64_t rows[4]);
+
+/* Amostras prontas no anel de áudio a partir de samples[*head] (dando a
+ * volta no fim); depois de lê-las, nes_consume_audio libera o espaço */
+NES_API size_t nes_audio_available(const nes_console* console, size_t* head);
+NES_API void nes_consume_audio(nes_console* console, size_t count);
+/* Amostras descartadas por anel cheio desde o último reset (ou ROM) */
+NES_API uint64_t nes_audio_overruns(const nes_console* console);
+
+/* Entrada: estado completo da porta (0 ou 1), aplicado no próximo frame.
+ * nes_set_buttons nunca perde o estado mais novo, mesmo com a fila cheia;
+ * nes_push_input devolve NES_ERROR_BUFFER_TOO_SMALL nesse caso.
+ * frame != 0 agenda para aquele frame; timestamp_ns é só para medir latência. */
+NES_API nes_result nes_set_buttons(nes_console* console, int port, uint8_t buttons);
+NES_API nes_result nes_push_input(nes_console* console, uint64_t frame, uint64_t timestamp_ns,
+                                  int port, uint8_t buttons);
+
+/* Save states: tamanho fixo para a ROM carregada */
+NES_API size_t nes_state_size(const nes_console* console);
+/* Devolve os bytes escritos ou 0 se o buffer for pequeno */
+NES_API size_t nes_save_state(const nes_console* console, uint8_t* buffer, size_t capacity);
+NES_API nes_result nes_load_state(nes_console* console, const uint8_t* data, size_t size);
+
+/* Gravação assíncrona em arquivo: nes_saver_save só serializa o estado
+ * (e copia o frame para a miniatura PNG 128x120) em um pool de 4 slots e
+ * volta; compressão e escrita (arquivo temporário + rename) rodam na
+ * thread do saver, que chama o callback ao fim de cada save (ok = 1 se o
+ * arquivo está no lugar; o callback não pode chamar nes_saver_save).
+ * Devolve o ticket do save ou 0 com o pool cheio. nes_saver_destroy
+ * termina o que já foi aceito. */
+typedef void (*nes_save_callback)(void* user, uint64_t ticket, int ok);
+
+NES_API nes_state_saver* nes_saver_create(nes_save_callback callback, void* user);
+NES_API void nes_saver_destroy(nes_state_saver* saver);
+NES_API uint64_t nes_saver_save(nes_state_saver* saver, const nes_console* console,
+                                const char* path, int thumbnail);
+/* Espera os saves pendentes */
+NES_API void nes_saver_flush(nes_state_saver* saver);
+NES_API nes_result nes_load_state_file(nes_console* console, const char* path);
+/* PNG gravado junto com o estado; devolve os bytes ou 0 (sem miniatura,
+ * arquivo inválido ou buffer pequeno) */
+NES_API size_t nes_read_state_thumbnail(const char* path, uint8_t* buffer, size_t capacity);
+
+/* Miniatura do último frame reduzida para width x height (até 256x240),
+ * codificada direto no buffer; não aloca. max_size dá a capacidade que
+ * sempre basta. Devolve os bytes escritos ou 0 (sem buffer de vídeo,
+ * tamanho inválido ou buffer pequeno). */
+NES_API size_t nes_thumbnail_max_size(nes_image_format format, int width, int height);
+NES_API size_t nes_encode_thumbnail(const nes_console* console, nes_image_format format,
+                                    int width, int height, uint8_t* buffer, size_t capacity);
+
+/* Pós-processamento de vídeo: frame RGB24 -> RGBA (ordem de bytes de um
+ * Bitmap ARGB_8888) em 2x, 3x ou 4x, com scanlines opcionais (0 = sem,
+ * 255 = linhas pretas). Um filtro não pertence a nenhuma instância e
+ * nes_filter_apply não o altera: pode rodar em uma thread de apresentação
+ * sobre o frame anterior enquanto nes_run_frame compõe o próximo em outro
+ * buffer de vídeo. nes_filter_create devolve NULL para parâmetros
+ * inválidos ou sem memória. */
+NES_API nes_video_filter* nes_filter_create(nes_filter_type type, int scale, uint8_t scanlines);
+NES_API void nes_filter_destroy(nes_video_filter* filter);
+NES_API void nes_filter_get_size(const nes_video_filter* filter, int* width, int* height);
+/* pitch: bytes entre linhas de out (no mínimo largura * 4); size: bytes de out */
+NES_API nes_result nes_filter_apply(const nes_video_filter* filter, const uint8_t* rgb,
+                                    uint8_t* out, size_t pitch, size_t size);
+
+/* Ritmo de frames "just in time": nes_pacer_wait dorme até pouco antes do
+ * próximo vsync (menos o tempo estimado de emulação); depois o host lê a
+ * entrada (nes_push_input com timestamps de nes_now_ns), chama
+ * nes_pacer_run_frame, apresenta e informa com nes_pacer_frame_presented
+ * (present_ns 0 = agora), que devolve a latência leitura -> apresentação.
+ * refresh_hz: NES_NTSC_REFRESH_HZ ou a taxa do display. */
+#define NES_NTSC_REFRESH_HZ 60.0988
+
+typedef struct nes_pacer_stats {
+    uint64_t frames;
+    uint64_t missed;                /* Apresentados depois do deadline */
+    uint64_t events;                /* Frames com entrada nova e timestamp */
+    uint64_t emulate_avg_ns;
+    uint64_t emulate_jitter_ns;
+    uint64_t input_latency_avg_ns;  /* Leitura da entrada -> apresentação */
+    uint64_t input_latency_max_ns;
+    uint64_t event_latency_avg_ns;  /* timestamp_ns do evento -> apresentação */
+    uint64_t event_latency_max_ns;
+} nes_pacer_stats;
+
+NES_API uint64_t nes_now_ns(void);
+NES_API nes_frame_pacer* nes_pacer_create(nes_console* console, double refresh_hz);
+NES_API void nes_pacer_destroy(nes_frame_pacer* pacer);
+NES_API void nes_pacer_set_refresh_rate(nes_frame_pacer* pacer, double refresh_hz);
+/* Realinha com um vsync do host (period_ns 0 mantém a taxa) */
+NES_API void nes_pacer_on_vsync(nes_frame_pacer* pacer, uint64_t vsync_ns, uint64_t period_ns);
+NES_API uint64_t nes_pacer_wait(nes_frame_pacer* pacer);
+NES_API void nes_pacer_run_frame(nes_frame_pacer* pacer);
+NES_API uint64_t nes_pacer_frame_presented(nes_frame_pacer* pacer, uint64_t present_ns);
+NES_API void nes_pacer_get_stats(const nes_frame_pacer* pacer, nes_pacer_stats* stats);
+
+/* Configurações */
+NES_API void nes_set_headless(nes_console* console, uint8_t flags);
+NES_API void nes_set_fast_forward(nes_console* console, int frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NES_API_H */
@@ -0,0 +1,65 @@
+#ifndef OPCODES_H
+#define OPCODES_H
+
+#include <cstdint>
+
+/**
+ * Tabela de opcodes do 6502 (oficiais e não documentados)
+ */
+enum AddressingMode : uint8_t {
+    MODE_IMPLIED,
+    MODE_ACCUMULATOR,
+    MODE_IMMEDIATE,
+    MODE_ZERO_PAGE,
+    MODE_ZERO_PAGE_X,
+    MODE_ZERO_PAGE_Y,
+    MODE_ABSOLUTE,
+    MODE_ABSOLUTE_X,
+    MODE_ABSOLUTE_Y,
+    MODE_INDIRECT,
+    MODE_INDIRECT_X,
+    MODE_INDIRECT_Y,
+    MODE_RELATIVE,
+};
+
+// Operação, independente do modo de endereçamento
+enum Operation : uint8_t {
+    OP_ADC, OP_AHX, OP_ALR, OP_ANC, OP_AND, OP_ARR, OP_ASL, OP_AXS,
+    OP_BCC, OP_BCS, OP_BEQ, OP_BIT, OP_BMI, OP_BNE, OP_BPL, OP_BRK,
+    OP_BVC, OP_BVS, OP_CLC, OP_CLD, OP_CLI, OP_CLV, OP_CMP, OP_CPX,
+    OP_CPY, OP_DCP, OP_DEC, OP_DEX, OP_DEY, OP_EOR, OP_INC, OP_INX,
+    OP_INY, OP_ISB, OP_JMP, OP_JSR, OP_LAS, OP_LAX, OP_LDA, OP_LDX,
+    OP_LDY, OP_LSR, OP_NOP, OP_ORA, OP_PHA, OP_PHP, OP_PLA, OP_PLP,
+    OP_RLA, OP_ROL, OP_ROR, OP_RRA, OP_RTI, OP_RTS, OP_SAX, OP_SBC,
+    OP_SEC, OP_SED, OP_SEI, OP_SHX, OP_SHY, OP_SLO, OP_SRE, OP_STA,
+    OP_STP, OP_STX, OP_STY, OP_TAS, OP_TAX, OP_TAY, OP_TSX, OP_TXA,
+    OP_TXS, OP_TYA, OP_XAA,
+};
+
+struct OpcodeInfo {
+    const char* mnemonic;
+    Operation operation;
+    AddressingMode mode;
+    uint8_t cycles;    // Sem as penalidades de página cruzada e desvio tomado
+    bool official;
+};
+
+extern const OpcodeInfo OPCODE_TABLE[256];
+
+// Bytes da instrução, incluindo o opcode
+inline uint8_t instructionLength(AddressingMode mode) {
+    switch (mode) {
+        case MODE_IMPLIED:
+        case MODE_ACCUMULATOR:
+            return 1;
+        case MODE_ABSOLUTE:
+        case MODE_ABSOLUTE_X:
+        case MODE_ABSOLUTE_Y:
+        case MODE_INDIRECT:
+            return 3;
+        default:
+            return 2;
+    }
+}
+
+#endif // OPCODES_H
@@ -0,0 +1,97 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "ppu.h"
+#include "cartridge.h"
+#include "spsc_queue.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Evento registrado pela thread da CPU para a thread de renderização
+ */
+struct PPUEvent {
+    enum Kind : uint8_t {
+        WRITE,          // Escrita em $2000-$2007 ou registrador de mapper
+        READ,           // Leitura com efeito colateral ($2002, $2007)
+        VIDEO_ENABLE,   // value = compor o próximo frame
+        FRAME_END,      // Fim de frame emulado (início do vblank)
+        OAM_DMA,        // Seguido de OAM_DMA_CHUNKS eventos com os 256 bytes
+    };
+    
+    union {
+        uint64_t dot;     // PPU::getDotCount() no momento do acesso
+        uint8_t data[8];  // Carga de OAM_DMA
+    };
+    uint16_t addr;
+    uint8_t value;
+    uint8_t kind;
+};
+
+/**
+ * Emulação em pipeline: a thread da CPU roda a PPU só com timing (tudo que a
+ * CPU consegue ler continua síncrono e exato) e registra os acessos aos
+ * registradores da PPU e do mapper. Uma segunda thread reproduz esse log em
+ * uma cópia da PPU e do cartucho, no mesmo dot, e compõe os pixels.
+ *
+ * A renderização fica no máximo um frame atrás: endFrame() espera o frame
+ * anterior terminar antes de devolver.
+ */
+class RenderPipeline {
+public:
+    // Copia o estado atual; a partir daqui ambos avançam em lockstep
+    RenderPipeline(const PPU& ppu, const Cartridge& cartridge);
+    ~RenderPipeline();
+    
+    RenderPipeline(const RenderPipeline&) = delete;
+    RenderPipeline& operator=(const RenderPipeline&) = delete;
+    
+    // Thread da CPU
+    void logWrite(uint64_t dot, uint16_t addr, uint8_t value) { push({dot, addr, value, PPUEvent::WRITE}); }
+    void logRead(uint64_t dot, uint16_t addr) { push({dot, addr, 0, PPUEvent::READ}); }
+    void logOAMDMA(uint64_t dot, const uint8_t* data);
+    void setVideoEnabled(uint64_t dot, bool enabled);
+    void endFrame(uint64_t dot);
+    
+    // Último frame completo (RGB 256x240)
+    const uint8_t* getFrameBuffer() const;
+    // Linhas alteradas nos frames publicados desde a última chamada
+    DirtyRows takeDirtyRows();
+    bool hasDirtyRows() const;
+    uint64_t getFramesRendered() const { return framesRendered.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 8192;
+    static constexpr int OAM_DMA_CHUNKS = 0x100 / 8;
+    
+    PPU ppu;
+    Cartridge cartridge;
+    SPSCQueue<PPUEvent, QUEUE_CAPACITY> queue;
+    
+    std::array<std::vector<uint8_t>, 2> frameBuffers;
+    std::atomic<int> frontBuffer;
+    std::array<std::atomic<uint64_t>, 4> dirtyRows;  // Publicadas a cada troca de frame
+    
+    uint64_t framesQueued;                 // Só a thread da CPU
+    std::atomic<uint64_t> framesRendered;
+    std::atomic<bool> stopping;
+    
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable frameDone;
+    std::thread worker;
+    
+    void push(const PPUEvent& event);
+    void wake();
+    void run();
+    void apply(const PPUEvent& event);
+};
+
+#endif // PIPELINE_H
@@ -2,10 +2,32 @@
 #define PPU_H
 
 #include <cstdint>
+#include <cstddef>
 #include <array>
 
+class Cartridge;
+class StateWriter;
+class StateReader;
+
+/**
+ * Linhas do frame (bit y = linha y) que mudaram desde a última consulta
+ */
+struct DirtyRows {
+    uint64_t bits[4];
+    
+    bool test(int row) const { return (bits[row >> 6] >> (row & 63)) & 1; }
+    // Nenhuma linha mudou: frame idêntico ao último consumido
+    bool none() const { return (bits[0] | bits[1] | bits[2] | bits[3]) == 0; }
+    int count() const;
+};
+
 /**
  * Picture Processing Unit (PPU) do NES
+ *
+ * Renderiza por scanline: no dot 1 de cada linha visível a linha inteira é
+ * avaliada. A composição de pixels é separada do que a CPU consegue observar
+ * (vblank/NMI, sprite 0 hit, sprite overflow), que roda sempre, mesmo com o
+ * vídeo desligado.
  */
 class PPU {
 public:
@@ -15,44 +37,168 @@ public:
     void write(uint16_t addr, uint8_t value);
     
     void step();
+    // Mesmo efeito de 'dots' chamadas a step(), pulando direto os dots em
+    // que nada acontece além do contador
+    void run(uint64_t dots);
     void reset();
     
-    const uint8_t* getFrameBuffer() const { return frameBuffer.data(); }
+    // OAM DMA: copia 256 bytes a partir de oamAddr de uma vez
+    void writeOAM(const uint8_t* data);
+    
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    
+    // Liga as tabelas de páginas do cartucho à CIRAM desta PPU. Depois de
+    // copiar PPU e cartucho, chamar de novo com a cópia do cartucho.
+    void setCartridge(Cartridge* cartridge);
+    
+    // Frame buffer RGB 256x240 pertence ao chamador; nullptr desliga o vídeo
+    static constexpr size_t FRAME_BUFFER_SIZE = 256 * 240 * 3;
+    void setFrameBuffer(uint8_t* buffer) { frameBuffer = buffer; }
+    const uint8_t* getFrameBuffer() const { return frameBuffer; }
     bool isFrameReady() const { return frameReady; }
+    
+    // Cada linha composta tem um hash das cores comparado com o da mesma
+    // linha no frame composto anterior; as diferentes acumulam aqui até
+    // takeDirtyRows. Linhas não compostas (headless) não marcam nada.
+    const DirtyRows& getDirtyRows() const { return dirtyRows; }
+    DirtyRows takeDirtyRows();
+    // O buffer exibido deixou de ser o desta PPU (pipeline ligado/desligado)
+    void markAllRowsDirty() { dirtyRows = {{~0ull, ~0ull, ~0ull, (1ull << (240 - 192)) - 1}}; }
     void resetFrameReady() { frameReady = false; }
     
+    // Modo headless: pula a composição, mantém o timing visível à CPU
+    void setVideoEnabled(bool enabled) { videoEnabled = enabled; }
+    bool isVideoEnabled() const { return videoEnabled; }
+    
     bool nmiRequested() const { return nmiFlag; }
     void resetNMI() { nmiFlag = false; }
+    // Limite inferior de step()s até o próximo início de vblank (que marca
+    // o frame pronto e pode pedir NMI), já descontado o dot pulado da linha
+    // pré-render dos frames ímpares
+    uint32_t dotsUntilVBlank() const {
+        const uint32_t vblank = 241 * 341 + 1;
+        uint32_t position = scanline * 341 + cycle;
+        if (position <= vblank) {
+            return vblank - position + 1;
+        }
+        return 262 * 341 - position + vblank;
+    }
+    
+    // Contador de scanlines do cartucho (MMC3). As subidas de A12 não são
+    // seguidas por busca: com sprites 8x8 e as tabelas de BG e sprites em
+    // metades diferentes há uma por linha renderizada em um dot fixo (260 ou
+    // 324), então o contador só é atualizado quando alguém precisa dele e o
+    // único evento agendado é o dot do próximo IRQ. Nos outros casos (8x16,
+    // mesma tabela) as subidas de cada linha saem do calendário de buscas no
+    // dot 1. Chamar syncMapperIRQ antes de mexer nos registradores de IRQ do
+    // mapper e updateMapperIRQ depois.
+    void syncMapperIRQ();
+    void updateMapperIRQ();
+    // Limite inferior de step()s até o próximo evento do contador
+    // (UINT32_MAX = nenhum)
+    uint32_t dotsUntilMapperEvent() const;
     
+    uint16_t getScanline() const { return scanline; }
+    uint16_t getCycle() const { return cycle; }
+    // Dots executados desde o reset (carimbo de tempo do pipeline)
+    uint64_t getDotCount() const { return dotCount; }
+
 private:
     // Registradores
     uint8_t ppuCtrl;
     uint8_t ppuMask;
     uint8_t ppuStatus;
     uint8_t oamAddr;
-    uint8_t ppuScroll;
-    uint8_t ppuAddr;
-    uint8_t ppuData;
+    uint8_t ppuData;     // Buffer de leitura de $2007
+    
+    // Registradores internos de scroll (v, t, x, w)
+    uint16_t vramAddr;
+    uint16_t tempAddr;
+    uint8_t fineX;
+    bool writeLatch;
     
     // Memória
-    std::array<uint8_t, 0x4000> vram;  // 16KB VRAM
+    std::array<uint8_t, 0x800> vram;   // 2KB CIRAM (nametables)
     std::array<uint8_t, 0x100> oam;    // OAM (Sprite)
     std::array<uint8_t, 0x20> palette; // Paleta
     
-    // Frame buffer
-    std::array<uint8_t, 256 * 240 * 3> frameBuffer;  // RGB
+    Cartridge* cartridge;
+    
+    // Tabelas de páginas de 1KB (do cartucho, ou CIRAM/zeros sem cartucho)
+    const uint8_t* const* chrPages;
+    uint8_t* const* nametablePages;
+    std::array<uint8_t*, 4> ciramPages;
+    
+    // Frame buffer (externo, opcional)
+    uint8_t* frameBuffer;
     
     // Estado interno
     uint16_t scanline;
     uint16_t cycle;
+    uint64_t dotCount;
+    uint16_t sprite0HitCycle;  // Dot em que o sprite 0 hit acontece na linha
     bool frameReady;
     bool nmiFlag;
-    uint8_t scrollX;
-    uint8_t scrollY;
+    bool oddFrame;
+    bool videoEnabled;
+    
+    // Sprites da linha atual, já com os padrões buscados
+    struct LineSprite {
+        uint8_t index;
+        uint8_t x;
+        uint8_t attr;
+        uint8_t patternLo;
+        uint8_t patternHi;
+    };
+    std::array<LineSprite, 8> lineSprites;
+    uint8_t lineSpriteCount;
+    
+    // Índices de paleta do background da linha (0 = transparente)
+    std::array<uint8_t, 256> bgLine;
+    
+    // Contador de scanlines do cartucho (ver syncMapperIRQ)
+    enum A12Mode : uint8_t {
+        A12_NONE,      // Sem renderização ou sem contador no cartucho
+        A12_ANALYTIC,  // Um clock por linha em a12ClockCycle
+        A12_FETCH,     // Subidas calculadas por linha (a12Rises)
+    };
+    uint8_t a12Mode;
+    uint16_t a12ClockCycle;
+    uint16_t a12SyncLine;      // Posição até onde o contador está em dia
+    uint16_t a12SyncCycle;
+    uint64_t a12SyncDot;
+    uint64_t mapperDot;        // dotCount do próximo evento
+    uint64_t a12FallDot;       // Última descida de A12 calculada
+    uint64_t a12PrevFallDot;   // Descida antes da linha atual
+    std::array<uint16_t, 8> a12Rises;  // Dots das subidas filtradas da linha
+    uint8_t a12RiseCount;
+    uint8_t a12RiseNext;
+    
+    // Saída: hash de 32 bits das cores de cada linha composta
+    std::array<uint32_t, 240> rowHashes;
+    DirtyRows dirtyRows;
+    
+    bool renderingEnabled() const { return (ppuMask & 0x18) != 0; }
+    
+    uint16_t nextEventCycle() const;
+    
+    uint32_t scanlineClockIndex(uint16_t line, uint16_t dot) const;
+    uint64_t scanlineClockDot(uint32_t clocks) const;
+    void scheduleScanlineIRQ();
+    void computeA12Rises();
+    void mapperEvent();
+    
+    uint8_t readVRAM(uint16_t addr);
+    void writeVRAM(uint16_t addr, uint8_t value);
     
-    void renderPixel();
-    void renderBackground();
-    void renderSprites();
+    void renderScanline();
+    void evaluateSprites(bool fetchAll);
+    void renderBackground(int x0, int x1);
+    uint8_t spritePixel(const LineSprite& sprite, int x) const;
+    void checkSprite0Hit();
+    void composeLine();
+    void incrementY();
     uint8_t getPaletteColor(uint8_t index);
 };
 
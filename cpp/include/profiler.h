@@ -0,0 +1,85 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+// Ligado com -DNES_PROFILE=1 (opção CMake NES_PROFILING)
+#ifndef NES_PROFILE
+#define NES_PROFILE 0
+#endif
+
+class Cartridge;
+
+/**
+ * Profiler da CPU emulada: execuções e ciclos por opcode e por PC, acessos
+ * por página do barramento e leituras/escritas nos registradores da PPU e
+ * da APU.
+ *
+ * Os pontos de contagem são guardados por Profiler::ENABLED, uma constante
+ * de compilação: com o profiler desligado o compilador remove as chamadas e
+ * o caminho quente não ganha nenhum desvio.
+ *
+ * Contadores por PC: um para cada endereço abaixo de $8000 (código em RAM
+ * ou PRG RAM) e um para cada byte da PRG ROM, de modo que cada banco tem os
+ * seus. Uma cópia do objeto é um snapshot.
+ */
+class Profiler {
+public:
+    static constexpr bool ENABLED = NES_PROFILE != 0;
+    
+    Profiler();
+    
+    // Dimensiona os contadores por PC para a ROM carregada e zera tudo
+    void attach(const Cartridge* cartridge);
+    void reset();
+    
+    // Contador do PC com o banco mapeado agora. A CPU o obtém antes de
+    // executar: uma instrução que troca de banco conta para o banco de onde
+    // foi lida.
+    size_t pcIndex(uint16_t pc) const;
+    
+    void countInstruction(size_t index, uint8_t opcode, uint32_t cycles) {
+        opcodeCounts[opcode]++;
+        opcodeCycles[opcode] += cycles;
+        if (index < pcCounts.size()) {
+            pcCounts[index]++;
+            pcCycles[index] += cycles;
+        }
+    }
+    
+    void countAccess(uint16_t addr, bool write) {
+        pageAccesses[write][addr >> 8]++;
+        if ((addr & 0xE000) == 0x2000) {
+            ppuRegisterHits[write][addr & 0x07]++;
+        } else if (addr >= 0x4000 && addr < 0x4020) {
+            apuRegisterHits[write][addr & 0x1F]++;
+        }
+    }
+    
+    uint64_t getOpcodeCount(uint8_t opcode) const { return opcodeCounts[opcode]; }
+    uint64_t getOpcodeCycles(uint8_t opcode) const { return opcodeCycles[opcode]; }
+    
+    // Binário: "NESP", versão, tamanhos e os vetores de uint64 em sequência
+    bool writeBinary(FILE* file) const;
+    // CSV: secao,banco,endereco,contagem,ciclos (só linhas não nulas).
+    // PC em ROM usa banco de 8KB e offset no banco; demais, banco -1.
+    bool writeCSV(FILE* file) const;
+
+private:
+    static constexpr size_t LOW_PCS = 0x8000;
+    
+    const Cartridge* cartridge;
+    
+    uint64_t opcodeCounts[256];
+    uint64_t opcodeCycles[256];
+    std::vector<uint64_t> pcCounts;
+    std::vector<uint64_t> pcCycles;
+    uint64_t pageAccesses[2][256];     // [escrita][página]
+    uint64_t ppuRegisterHits[2][8];
+    uint64_t apuRegisterHits[2][32];   // $4000-$401F
+};
+
+#endif // PROFILER_H
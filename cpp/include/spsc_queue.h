@@ -0,0 +1,70 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Fila lock-free de produtor único / consumidor único com capacidade fixa
+ *
+ * Cada lado guarda uma cópia do índice do outro e só relê o atômico quando a
+ * fila parece cheia (produtor) ou vazia (consumidor).
+ */
+template <typename T, size_t Capacity>
+class SPSCQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacidade deve ser potência de 2");
+    
+public:
+    SPSCQueue() : head(0), tailCache(0), tail(0), headCache(0) {}
+    
+    // Produtor
+    bool push(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - headCache == Capacity) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t - headCache == Capacity) {
+                return false;
+            }
+        }
+        items[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumidor
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tailCache) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h == tailCache) {
+                return false;
+            }
+        }
+        item = items[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Aproximado quando chamado durante uso concorrente
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    
+    bool empty() const { return size() == 0; }
+    
+    static constexpr size_t capacity() { return Capacity; }
+    
+private:
+    // Lado do consumidor
+    alignas(64) std::atomic<size_t> head;
+    size_t tailCache;
+    
+    // Lado do produtor
+    alignas(64) std::atomic<size_t> tail;
+    size_t headCache;
+    
+    alignas(64) std::array<T, Capacity> items;
+};
+
+#endif // SPSC_QUEUE_H
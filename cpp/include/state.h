@@ -0,0 +1,130 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Serialização de save states direto em um buffer do chamador
+ *
+ * Sem buffer o writer só conta bytes (tamanho do estado). Os valores são
+ * copiados na representação nativa, little-endian em todos os alvos. O
+ * reader aceita dados externos: bools, enums e índices fora da faixa marcam
+ * o estado como inválido (ok() == false) sem deixar valores inválidos.
+ */
+class StateWriter {
+public:
+    StateWriter(uint8_t* buffer = nullptr, size_t capacity = 0)
+        : buffer(buffer), capacity(capacity), position(0), overflow(false) {}
+    
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Tipo não serializável");
+        writeBytes(&value, sizeof(T));
+    }
+    
+    void writeBytes(const void* data, size_t size) {
+        if (buffer && size > 0) {
+            if (position + size > capacity) {
+                overflow = true;
+            } else {
+                std::memcpy(buffer + position, data, size);
+            }
+        }
+        position += size;
+    }
+    
+    size_t size() const { return position; }
+    bool ok() const { return !overflow; }
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t position;
+    bool overflow;
+};
+
+class StateReader {
+public:
+    StateReader(const uint8_t* data, size_t size)
+        : data(data), length(size), position(0), failed(false) {}
+    
+    template <typename T>
+    void read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Tipo não serializável");
+        readBytes(&value, sizeof(T));
+    }
+    
+    // bool só aceita 0 e 1: qualquer outro byte seria um bool inválido
+    void read(bool& value) {
+        uint8_t byte;
+        readBytes(&byte, 1);
+        if (byte > 1) {
+            failed = true;
+        }
+        value = byte == 1;
+    }
+    
+    // Acima de max o estado é inválido e o valor fica em max, para que os
+    // índices nunca saiam da faixa mesmo antes de o chamador desistir
+    template <typename T>
+    void readBounded(T& value, T max) {
+        read(value);
+        if (value > max) {
+            failed = true;
+            value = max;
+        }
+    }
+    
+    // Validação feita pelo chamador
+    void invalidate() { failed = true; }
+    
+    void readBytes(void* out, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        if (position + size > length) {
+            failed = true;
+            std::memset(out, 0, size);
+            return;
+        }
+        std::memcpy(out, data + position, size);
+        position += size;
+    }
+    
+    size_t remaining() const { return length - position; }
+    bool ok() const { return !failed; }
+
+private:
+    const uint8_t* data;
+    size_t length;
+    size_t position;
+    bool failed;
+};
+
+/**
+ * Hash de 64 bits para comparar estados e frames (não criptográfico):
+ * FNV-1a sobre palavras de 8 bytes com mistura final
+ */
+inline uint64_t hashBytes(const uint8_t* data, size_t size, uint64_t seed = 0xCBF29CE484222325ull) {
+    const uint64_t prime = 0x100000001B3ull;
+    uint64_t hash = seed ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * prime;
+    }
+    hash ^= hash >> 32;
+    hash *= 0xD6E8FEB86659FD93ull;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+#endif // STATE_H
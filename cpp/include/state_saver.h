@@ -0,0 +1,111 @@
+#ifndef STATE_SAVER_H
+#define STATE_SAVER_H
+
+#include "spsc_queue.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Console;
+
+/**
+ * Gravação assíncrona de save states em arquivo
+ *
+ * save() roda na thread de emulação e só serializa o estado (e copia o
+ * frame, para a miniatura) em um slot de um pool fixo; compressão, PNG da
+ * miniatura e escrita ficam em uma thread própria. O arquivo é escrito em
+ * "<path>.tmp" e renomeado por cima do destino, então um slot nunca fica
+ * pela metade se o app morrer no meio. Com o pool ocupado save() desiste
+ * na hora (devolve 0) em vez de esperar: um autosave a cada poucos
+ * segundos custa no frame só a serialização e as cópias.
+ *
+ * Formato (little-endian):
+ *   "NESZ", versão, flags, hash da ROM, tamanho do estado, tamanho
+ *   comprimido, tamanho da miniatura, FNV-1a do estado, estado comprimido
+ *   (blocos no formato do LZ4) e, com STATE_FILE_THUMBNAIL, um PNG
+ *   THUMBNAIL_WIDTH x THUMBNAIL_HEIGHT.
+ */
+class StateSaver {
+public:
+    static constexpr int SLOTS = 4;
+    static constexpr size_t MAX_PATH_LENGTH = 1024;
+    static constexpr int THUMBNAIL_WIDTH = 128;
+    static constexpr int THUMBNAIL_HEIGHT = 120;
+    
+    // Chamado na thread de gravação ao fim de cada save (ok = arquivo no lugar)
+    using Completion = void (*)(void* user, uint64_t ticket, bool ok);
+    
+    StateSaver();
+    // Termina de gravar o que já foi aceito antes de encerrar a thread
+    ~StateSaver();
+    
+    StateSaver(const StateSaver&) = delete;
+    StateSaver& operator=(const StateSaver&) = delete;
+    
+    // Definir antes do primeiro save
+    void setCompletion(Completion callback, void* user);
+    
+    // Thread de emulação. Devolve o ticket do save (>= 1) ou 0 se o pool
+    // estiver cheio ou o caminho for longo demais. O primeiro save de cada
+    // slot aloca os buffers; depois não há alocação.
+    uint64_t save(const Console& console, const char* path, bool withThumbnail = true);
+    // Espera todos os saves aceitos terminarem
+    void flush();
+    
+    size_t getPending() const;
+    uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+    
+    // Lê um arquivo gravado (qualquer thread); thumbnail recebe o PNG, se
+    // houver. false para arquivo ausente, truncado ou corrompido.
+    static bool readFile(const char* path, std::vector<uint8_t>& state,
+                         std::vector<uint8_t>* thumbnail = nullptr);
+    
+    // Codec do estado (formato de bloco do LZ4, janela de 64KB)
+    static size_t maxCompressedSize(size_t size) { return size + size / 255 + 16; }
+    static size_t compress(const uint8_t* src, size_t size, uint8_t* out, size_t capacity);
+    // false se os dados não descomprimirem em exatamente size bytes
+    static bool decompress(const uint8_t* src, size_t srcSize, uint8_t* out, size_t size);
+
+private:
+    struct Slot {
+        std::vector<uint8_t> state;
+        std::vector<uint8_t> frame;  // Cópia do vídeo para a miniatura
+        size_t stateSize;
+        uint64_t ticket;
+        uint64_t romHash;
+        bool thumbnail;
+        char path[MAX_PATH_LENGTH];
+    };
+    
+    std::array<Slot, SLOTS> slots;
+    SPSCQueue<uint8_t, SLOTS> freeSlots;   // Gravação -> emulação
+    SPSCQueue<uint8_t, SLOTS> readySlots;  // Emulação -> gravação
+    
+    Completion completion;
+    void* completionUser;
+    
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> completed;
+    std::atomic<uint64_t> dropped;
+    std::atomic<bool> stopping;
+    
+    // Só a thread de gravação
+    std::vector<uint8_t> output;
+    
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable idle;
+    std::thread worker;
+    
+    void wake();
+    void run();
+    bool write(const Slot& slot);
+};
+
+#endif // STATE_SAVER_H
@@ -0,0 +1,101 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Medidas de um frame emulado
+ *
+ * Mapper e saída de frame são medidos diretamente; o resto do frame é
+ * repartido entre CPU, PPU e APU pela proporção medida nas instruções
+ * amostradas (ver Console::setTimingEnabled). A composição de pixels conta
+ * como PPU; outputNs é a entrega do frame (espera pelo pipeline).
+ */
+struct FrameTelemetry {
+    uint64_t frame;          // Console::getFrameCount() ao fim do frame
+    uint64_t timestampNs;    // Relógio monotônico do host ao fim do frame
+    uint64_t frameNs;
+    uint64_t cpuNs;
+    uint64_t ppuNs;
+    uint64_t apuNs;
+    uint64_t mapperNs;       // Escritas em registradores do mapper
+    uint64_t outputNs;
+    uint64_t cycles;         // Ciclos de CPU emulados no frame
+    uint32_t audioFill;      // Amostras no buffer de áudio ao fim do frame
+    uint32_t audioCapacity;
+};
+
+/**
+ * Anel de capacidade fixa com um escritor (thread de emulação) e qualquer
+ * número de leitores sem lock. Cada posição tem um número de sequência
+ * (seqlock): o leitor descarta registros sobrescritos durante a cópia.
+ */
+class TelemetryRing {
+public:
+    static constexpr size_t CAPACITY = 256;
+    
+    TelemetryRing() : head(0) {
+        for (Slot& slot : slots) {
+            slot.sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    // Escritor
+    void push(const FrameTelemetry& record) {
+        uint64_t index = head.load(std::memory_order_relaxed);
+        Slot& slot = slots[index % CAPACITY];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);  // Ímpar: escrevendo
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.record = record;
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        head.store(index + 1, std::memory_order_release);
+    }
+    
+    // Total de frames registrados desde a criação
+    uint64_t count() const { return head.load(std::memory_order_acquire); }
+    
+    // Copia até 'max' registros mais recentes, do mais antigo para o mais
+    // novo; devolve quantos foram copiados
+    size_t read(FrameTelemetry* out, size_t max) const {
+        uint64_t end = count();
+        size_t available = static_cast<size_t>(end < CAPACITY ? end : CAPACITY);
+        size_t wanted = max < available ? max : available;
+        size_t copied = 0;
+        for (uint64_t index = end - wanted; index < end; index++) {
+            if (readSlot(index, out[copied])) {
+                copied++;
+            }
+        }
+        return copied;
+    }
+    
+    bool latest(FrameTelemetry& out) const {
+        uint64_t end = count();
+        return end > 0 && readSlot(end - 1, out);
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence;
+        FrameTelemetry record;
+    };
+    
+    std::array<Slot, CAPACITY> slots;
+    alignas(64) std::atomic<uint64_t> head;
+    
+    bool readSlot(uint64_t index, FrameTelemetry& out) const {
+        const Slot& slot = slots[index % CAPACITY];
+        uint64_t expected = 2 * index + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected) {
+            return false;
+        }
+        out = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == expected;
+    }
+};
+
+#endif // TELEMETRY_H
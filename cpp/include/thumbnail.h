@@ -0,0 +1,38 @@
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Miniaturas e capturas de tela a partir do frame RGB 256x240 da PPU
+ *
+ * A redução é um filtro de caixa (média da área de origem de cada pixel) e
+ * a codificação é sem perdas e sem compressão de verdade: QOI ou PNG com
+ * deflate "stored". Tudo é gerado linha a linha direto no buffer do
+ * chamador, sem alocação, para poder rodar na thread de emulação ao gravar
+ * um slot de save state.
+ */
+enum ThumbnailFormat : uint8_t {
+    THUMBNAIL_QOI = 0,
+    THUMBNAIL_PNG = 1,
+};
+
+// Maior tamanho codificado possível para width x height (0 se inválido)
+size_t thumbnailMaxSize(ThumbnailFormat format, int width, int height);
+
+// Reduz uma imagem RGB para dstWidth x dstHeight (no máximo o tamanho de
+// origem); false se as dimensões forem inválidas
+bool downscaleRGB(const uint8_t* src, int srcWidth, int srcHeight,
+                  uint8_t* dst, int dstWidth, int dstHeight);
+
+// Codifica uma imagem RGB; devolve os bytes escritos ou 0 se o buffer for
+// pequeno ou as dimensões inválidas
+size_t encodeImage(const uint8_t* rgb, int width, int height, ThumbnailFormat format,
+                   uint8_t* out, size_t capacity);
+
+// Reduz o frame 256x240 para width x height e codifica, em uma passada
+size_t encodeThumbnail(const uint8_t* frame, int width, int height, ThumbnailFormat format,
+                       uint8_t* out, size_t capacity);
+
+#endif // THUMBNAIL_H
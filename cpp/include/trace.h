@@ -0,0 +1,86 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+class CPU;
+class PPU;
+class Memory;
+
+// Interrupção atendida antes da instrução registrada
+enum TraceEvent : uint8_t {
+    TRACE_NONE = 0,
+    TRACE_NMI = 1,
+    TRACE_IRQ = 2,
+};
+
+/**
+ * Registro binário de uma instrução, com os registradores antes de executá-la
+ */
+struct TraceRecord {
+    uint64_t cycle;        // Ciclo da CPU no início da instrução
+    uint16_t pc;
+    uint16_t scanline;
+    uint16_t dot;
+    uint8_t opcode;
+    uint8_t operands[2];   // Bytes seguintes ao opcode (usados ou não)
+    uint8_t a;
+    uint8_t x;
+    uint8_t y;
+    uint8_t p;
+    uint8_t sp;
+    uint8_t event;         // TraceEvent
+};
+
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord deve ter tamanho fixo");
+
+/**
+ * Trace de instruções em anel pré-alocado
+ *
+ * Com o trace ligado a CPU chama record() a cada instrução; desligado, o
+ * custo é um único desvio previsível (ponteiro nulo). Nada é formatado
+ * durante a emulação: o dump binário é convertido para o formato do
+ * nestest.log offline (nes_trace_format).
+ */
+class Tracer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 18;  // ~9 frames, 6MB
+    
+    // Capacidade arredondada para potência de 2
+    explicit Tracer(size_t capacity = DEFAULT_CAPACITY);
+    
+    // Fontes dos bytes de operando e de scanline/dot
+    void attach(const Memory* memory, const PPU* ppu);
+    
+    void record(const CPU& cpu, uint8_t opcode, uint8_t event);
+    void clear() { head = 0; }
+    
+    // Instruções registradas desde o último clear (pode exceder a capacidade)
+    uint64_t getTotal() const { return head; }
+    size_t getCount() const { return head < records.size() ? static_cast<size_t>(head) : records.size(); }
+    size_t getCapacity() const { return records.size(); }
+    
+    // Do mais antigo para o mais novo
+    void copyRecords(std::vector<TraceRecord>& out) const;
+    
+    // "NEST", versão, tamanho do registro, total e contagem, seguidos dos
+    // registros do mais antigo para o mais novo
+    bool writeDump(FILE* file) const;
+    static bool readDump(FILE* file, std::vector<TraceRecord>& out);
+
+private:
+    std::vector<TraceRecord> records;
+    size_t mask;
+    uint64_t head;
+    const Memory* memory;
+    const PPU* ppu;
+};
+
+// Linha no formato do nestest.log (sem os valores lidos da memória, que o
+// trace não guarda); devolve o tamanho escrito
+size_t formatTraceRecord(const TraceRecord& record, char* out, size_t size);
+
+#endif // TRACE_H
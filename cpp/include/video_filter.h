@@ -0,0 +1,55 @@
+#ifndef VIDEO_FILTER_H
+#define VIDEO_FILTER_H
+
+#include <cstdint>
+#include <cstddef>
+
+enum VideoFilterType : uint8_t {
+    VIDEO_FILTER_NEAREST = 0,  // Vizinho mais próximo
+    VIDEO_FILTER_SMOOTH = 1,   // Scale2x/Scale3x (4x = Scale2x duas vezes)
+    VIDEO_FILTER_NTSC = 2,     // Sinal composto codificado e decodificado
+};
+
+struct VideoFilterSettings {
+    VideoFilterType type;
+    uint8_t scale;       // 2, 3 ou 4
+    uint8_t scanlines;   // Escurecimento da última linha de cada pixel (0 = sem, 255 = preta)
+};
+
+/**
+ * Pós-processamento do frame RGB 256x240 da PPU para exibição, em RGBA
+ * (mesma ordem de bytes de um Bitmap ARGB_8888 ou textura GL_RGBA)
+ *
+ * apply() não altera o filtro nem guarda estado entre frames: pode rodar em
+ * uma thread de apresentação enquanto a emulação segue no próximo frame
+ * (com o vídeo do Console em buffer duplo), ou em várias threads ao mesmo
+ * tempo. Os caminhos quentes usam SSE2 ou NEON, com fallback escalar.
+ */
+class VideoFilter {
+public:
+    static constexpr int SOURCE_WIDTH = 256;
+    static constexpr int SOURCE_HEIGHT = 240;
+    
+    VideoFilter();
+    
+    // false (sem alterar nada) para tipo ou escala inválidos
+    bool configure(const VideoFilterSettings& settings);
+    const VideoFilterSettings& getSettings() const { return settings; }
+    
+    int getWidth() const { return SOURCE_WIDTH * settings.scale; }
+    int getHeight() const { return SOURCE_HEIGHT * settings.scale; }
+    
+    // pitch em bytes entre linhas de saída (no mínimo getWidth() * 4)
+    void apply(const uint8_t* frame, uint8_t* out, size_t pitch) const;
+
+private:
+    VideoFilterSettings settings;
+    int32_t yiqTable[3][256][3];  // Contribuição de R, G e B para Y, I e Q (x16)
+    
+    void applyNearest(const uint8_t* frame, uint8_t* out, size_t pitch) const;
+    void applySmooth(const uint8_t* frame, uint8_t* out, size_t pitch) const;
+    void applyNTSC(const uint8_t* frame, uint8_t* out, size_t pitch) const;
+    void writeLine(uint8_t* out, size_t pitch, int row, const uint32_t* line) const;
+};
+
+#endif // VIDEO_FILTER_H
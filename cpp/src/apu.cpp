@@ -1,15 +1,39 @@
 #include "apu.h"
+#include "state.h"
+
+#include <algorithm>
+
+// Valores carregados nos length counters (índice = bits 7-3 do registrador)
+static const uint8_t LENGTH_TABLE[32] = {
+    10, 254, 20,  2, 40,  4, 80,  6, 160,  8, 60, 10, 14, 12, 26, 14,
+    12,  16, 24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30,
+};
 
 APU::APU() : pulse1Ctrl(0), pulse1Sweep(0), pulse1Timer(0), pulse1TimerHi(0),
              pulse2Ctrl(0), pulse2Sweep(0), pulse2Timer(0), pulse2TimerHi(0),
              triangleCtrl(0), triangleTimer(0), triangleTimerHi(0),
              noiseCtrl(0), noisePeriod(0), noiseLengthCounter(0),
              dmcCtrl(0), dmcDirect(0), dmcAddr(0), dmcLength(0),
-             statusReg(0), frameCounter(0), cycles(0) {}
+             statusReg(0), frameCounter(0), frameCycle(0), frameIrqFlag(false),
+             synthesisEnabled(true), decimation(1), decimationCount(0),
+             decimationSum(0.0f), audioBuffer(nullptr), audioCapacity(0),
+             audioHead(0), audioCount(0), audioOverruns(0), cycles(0) {
+    lengthCounters.fill(0);
+}
 
 uint8_t APU::read(uint16_t addr) {
     if (addr == 0x4015) {
-        return statusReg;
+        uint8_t status = 0;
+        for (int i = 0; i < 4; i++) {
+            if (lengthCounters[i] > 0) {
+                status |= 1 << i;
+            }
+        }
+        if (frameIrqFlag) {
+            status |= 0x40;
+        }
+        frameIrqFlag = false;
+        return status;
     }
     return 0;
 }
@@ -19,28 +43,51 @@ void APU::write(uint16_t addr, uint8_t value) {
         case 0x4000: pulse1Ctrl = value; break;
         case 0x4001: pulse1Sweep = value; break;
         case 0x4002: pulse1Timer = value; break;
-        case 0x4003: pulse1TimerHi = value; break;
+        case 0x4003: pulse1TimerHi = value; loadLengthCounter(0, value); break;
         case 0x4004: pulse2Ctrl = value; break;
         case 0x4005: pulse2Sweep = value; break;
         case 0x4006: pulse2Timer = value; break;
-        case 0x4007: pulse2TimerHi = value; break;
+        case 0x4007: pulse2TimerHi = value; loadLengthCounter(1, value); break;
         case 0x4008: triangleCtrl = value; break;
         case 0x400A: triangleTimer = value; break;
-        case 0x400B: triangleTimerHi = value; break;
+        case 0x400B: triangleTimerHi = value; loadLengthCounter(2, value); break;
         case 0x400C: noiseCtrl = value; break;
         case 0x400E: noisePeriod = value; break;
-        case 0x400F: noiseLengthCounter = value; break;
+        case 0x400F: noiseLengthCounter = value; loadLengthCounter(3, value); break;
         case 0x4010: dmcCtrl = value; break;
         case 0x4011: dmcDirect = value; break;
         case 0x4012: dmcAddr = value; break;
         case 0x4013: dmcLength = value; break;
-        case 0x4015: statusReg = value; break;
-        case 0x4017: frameCounter = value; break;
+        case 0x4015:
+            statusReg = value;
+            // Desabilitar um canal zera seu length counter
+            for (int i = 0; i < 4; i++) {
+                if (!(value & (1 << i))) {
+                    lengthCounters[i] = 0;
+                }
+            }
+            break;
+        case 0x4017:
+            frameCounter = value;
+            frameCycle = 0;
+            if (value & 0x40) {
+                frameIrqFlag = false;
+            }
+            if (value & 0x80) {
+                quarterFrame();
+                halfFrame();
+            }
+            break;
     }
 }
 
 void APU::step() {
     cycles++;
+    clockFrameSequencer();
+    
+    if (!synthesisEnabled) {
+        return;
+    }
     
     // Gerar amostras de áudio
     float sample = 0.0f;
@@ -50,16 +97,144 @@ void APU::step() {
     sample += generateNoise() * 0.2f;
     sample += generateDMC() * 0.2f;
     
-    audioBuffer.push(sample);
-    
-    if (cycles % 7457 == 0) {
-        updateEnvelopes();
-        updateSweeps();
+    if (decimation > 1) {
+        decimationSum += sample;
+        if (++decimationCount < decimation) {
+            return;
+        }
+        sample = decimationSum / decimation;
+        decimationSum = 0.0f;
+        decimationCount = 0;
     }
+    pushSample(sample);
+}
+
+void APU::run(uint64_t count) {
+    while (count > 0) {
+        if (synthesisEnabled) {
+            step();
+            count--;
+            continue;
+        }
+        // Sem síntese só o frame sequencer tem efeito
+        uint64_t skip = std::min<uint64_t>(count, nextFrameStep() - frameCycle - 1);
+        cycles += skip;
+        frameCycle += static_cast<uint32_t>(skip);
+        count -= skip;
+        if (count > 0) {
+            step();
+            count--;
+        }
+    }
+}
+
+uint32_t APU::nextFrameStep() const {
+    static const uint32_t STEPS_4[] = {7457, 14913, 22371, 29829, 29830};
+    static const uint32_t STEPS_5[] = {7457, 14913, 22371, 37281, 37282};
+    const uint32_t* steps = (frameCounter & 0x80) ? STEPS_5 : STEPS_4;
+    for (int i = 0; i < 5; i++) {
+        if (steps[i] > frameCycle) {
+            return steps[i];
+        }
+    }
+    return frameCycle + 1;
+}
+
+void APU::setDecimation(uint32_t factor) {
+    decimation = factor > 0 ? factor : 1;
+    decimationCount = 0;
+    decimationSum = 0.0f;
+}
+
+void APU::loadLengthCounter(int channel, uint8_t value) {
+    if (statusReg & (1 << channel)) {
+        lengthCounters[channel] = LENGTH_TABLE[value >> 3];
+    }
+}
+
+void APU::clockFrameSequencer() {
+    frameCycle++;
     
-    if (cycles % 14914 == 0) {
-        updateLengthCounters();
+    // Passos em ciclos de CPU (modo 4 passos / modo 5 passos)
+    if (frameCounter & 0x80) {
+        switch (frameCycle) {
+            case 7457: quarterFrame(); break;
+            case 14913: quarterFrame(); halfFrame(); break;
+            case 22371: quarterFrame(); break;
+            case 37281: quarterFrame(); halfFrame(); break;
+            case 37282: frameCycle = 0; break;
+        }
+    } else {
+        switch (frameCycle) {
+            case 7457: quarterFrame(); break;
+            case 14913: quarterFrame(); halfFrame(); break;
+            case 22371: quarterFrame(); break;
+            case 29829:
+                quarterFrame();
+                halfFrame();
+                if (!(frameCounter & 0x40)) {
+                    frameIrqFlag = true;
+                }
+                break;
+            case 29830: frameCycle = 0; break;
+        }
+    }
+}
+
+uint32_t APU::cyclesUntilIRQ() const {
+    if (frameCounter & 0xC0) {
+        return UINT32_MAX;
     }
+    // O passo 29829 marca o IRQ; o seguinte volta o contador a zero
+    return frameCycle < 29829 ? 29829 - frameCycle : 29830;
+}
+
+void APU::quarterFrame() {
+    updateEnvelopes();
+}
+
+void APU::halfFrame() {
+    updateLengthCounters();
+    updateSweeps();
+}
+
+void APU::saveState(StateWriter& out) const {
+    // Buffer de saída e decimação são configuração do host, não estado
+    uint8_t registers[20] = {
+        pulse1Ctrl, pulse1Sweep, pulse1Timer, pulse1TimerHi,
+        pulse2Ctrl, pulse2Sweep, pulse2Timer, pulse2TimerHi,
+        triangleCtrl, triangleTimer, triangleTimerHi,
+        noiseCtrl, noisePeriod, noiseLengthCounter,
+        dmcCtrl, dmcDirect, dmcAddr, dmcLength,
+        statusReg, frameCounter,
+    };
+    out.write(registers);
+    out.write(lengthCounters);
+    out.write(frameCycle);
+    out.write(frameIrqFlag);
+    out.write(cycles);
+}
+
+void APU::loadState(StateReader& in) {
+    uint8_t registers[20];
+    in.read(registers);
+    uint8_t* fields[20] = {
+        &pulse1Ctrl, &pulse1Sweep, &pulse1Timer, &pulse1TimerHi,
+        &pulse2Ctrl, &pulse2Sweep, &pulse2Timer, &pulse2TimerHi,
+        &triangleCtrl, &triangleTimer, &triangleTimerHi,
+        &noiseCtrl, &noisePeriod, &noiseLengthCounter,
+        &dmcCtrl, &dmcDirect, &dmcAddr, &dmcLength,
+        &statusReg, &frameCounter,
+    };
+    for (int i = 0; i < 20; i++) {
+        *fields[i] = registers[i];
+    }
+    in.read(lengthCounters);
+    // O contador volta a zero no último passo do modo (frameCounter já
+    // lido acima): 29830 com 4 passos, 37282 com 5
+    in.readBounded<uint32_t>(frameCycle, (frameCounter & 0x80) ? 37281 : 29829);
+    in.read(frameIrqFlag);
+    in.read(cycles);
 }
 
 void APU::reset() {
@@ -83,17 +258,58 @@ void APU::reset() {
     dmcLength = 0;
     statusReg = 0;
     frameCounter = 0;
+    lengthCounters.fill(0);
+    frameCycle = 0;
+    frameIrqFlag = false;
     cycles = 0;
     
-    while (!audioBuffer.empty()) {
-        audioBuffer.pop();
+    audioHead = 0;
+    audioCount = 0;
+    audioOverruns = 0;
+    decimationCount = 0;
+    decimationSum = 0.0f;
+}
+
+void APU::setAudioBuffer(float* buffer, size_t capacity) {
+    audioBuffer = buffer;
+    audioCapacity = buffer ? capacity : 0;
+    audioHead = 0;
+    audioCount = 0;
+}
+
+void APU::pushSample(float sample) {
+    if (audioCount == audioCapacity) {
+        if (audioBuffer) {
+            audioOverruns++;
+        }
+        return;
+    }
+    size_t tail = audioHead + audioCount;
+    if (tail >= audioCapacity) {
+        tail -= audioCapacity;
+    }
+    audioBuffer[tail] = sample;
+    audioCount++;
+}
+
+void APU::consumeAudio(size_t count) {
+    if (count > audioCount) {
+        count = audioCount;
+    }
+    audioHead += count;
+    if (audioHead >= audioCapacity) {
+        audioHead -= audioCapacity;
     }
+    audioCount -= count;
 }
 
 float APU::getSample() {
-    if (!audioBuffer.empty()) {
-        float sample = audioBuffer.front();
-        audioBuffer.pop();
+    if (audioCount > 0) {
+        float sample = audioBuffer[audioHead];
+        if (++audioHead == audioCapacity) {
+            audioHead = 0;
+        }
+        audioCount--;
         return sample;
     }
     return 0.0f;
@@ -124,5 +340,16 @@ void APU::updateSweeps() {
 }
 
 void APU::updateLengthCounters() {
-    // Implementação básica
+    // Bit de halt: $4000/$4004/$400C bit 5, $4008 bit 7
+    const bool halted[4] = {
+        (pulse1Ctrl & 0x20) != 0,
+        (pulse2Ctrl & 0x20) != 0,
+        (triangleCtrl & 0x80) != 0,
+        (noiseCtrl & 0x20) != 0,
+    };
+    for (int i = 0; i < 4; i++) {
+        if (lengthCounters[i] > 0 && !halted[i]) {
+            lengthCounters[i]--;
+        }
+    }
 }
@@ -1,9 +1,19 @@
 #include "cartridge.h"
+#include "state.h"
 
-Cartridge::Cartridge() : mapperNumber(0), batteryBacked(false), mirroring(0),
-                         irqFlag(false), prgBankLo(0), prgBankHi(0),
+// Leitura de PRG sem ROM carregada
+static const uint8_t EMPTY_PRG[0x2000] = {};
+
+Cartridge::Cartridge() : mapperNumber(0), batteryBacked(false), mirroring(MIRROR_HORIZONTAL),
+                         romHash(0), ciram(nullptr), irqFlag(false), prgBankLo(0), prgBankHi(0),
                          chrBank0(0), chrBank1(0), chrBankA(0), chrBankB(0),
-                         chrBankC(0), chrBankD(0), chrBankE(0), chrBankF(0) {}
+                         chrBankC(0), chrBankD(0), chrBankE(0), chrBankF(0),
+                         mmc1Shift(0x10), mmc1Control(0x0C), mmc3BankSelect(0),
+                         mmc3IrqLatch(0), mmc3IrqCounter(0), mmc3IrqReload(false), mmc3IrqEnabled(false) {
+    prgRam.fill(0);
+    chrRam.fill(0);
+    updateBanks();
+}
 
 bool Cartridge::loadROM(const uint8_t* data, size_t size) {
     if (size < 16) return false;
@@ -19,7 +29,7 @@ bool Cartridge::loadROM(const uint8_t* data, size_t size) {
     uint8_t flags7 = data[7];
     
     mapperNumber = ((flags7 & 0xF0) | (flags6 >> 4));
-    mirroring = flags6 & 0x01;
+    mirroring = (flags6 & 0x08) ? MIRROR_FOUR_SCREEN : (flags6 & 0x01);
     batteryBacked = (flags6 & 0x02) != 0;
     
     size_t offset = 16;
@@ -34,32 +44,122 @@ bool Cartridge::loadROM(const uint8_t* data, size_t size) {
     
     // Carregar CHR ROM
     size_t chrSize = chrRomSize * 8192;
+    chrRom.clear();
     if (chrSize > 0) {
         if (offset + chrSize > size) return false;
         chrRom.resize(chrSize);
         std::copy(data + offset, data + offset + chrSize, chrRom.begin());
+    }
+    
+    romHash = hashBytes(chrRom.data(), chrRom.size(), hashBytes(prgRom.data(), prgRom.size()));
+    
+    // Inicializar PRG RAM e CHR RAM
+    prgRam.fill(0);
+    chrRam.fill(0);
+    if (mirroring == MIRROR_FOUR_SCREEN) {
+        extraVram.assign(0x800, 0);
     } else {
-        chrRam.resize(8192);
+        extraVram.clear();
     }
     
-    // Inicializar PRG RAM
-    prgRam.resize(8192);
+    // Estado de power-on dos mappers
+    prgBankLo = prgBankHi = 0;
+    chrBank0 = chrBank1 = 0;
+    chrBankA = chrBankB = chrBankC = chrBankD = chrBankE = chrBankF = 0;
+    mmc1Shift = 0x10;
+    mmc1Control = 0x0C;
+    mmc3BankSelect = 0;
+    mmc3IrqLatch = mmc3IrqCounter = 0;
+    mmc3IrqReload = mmc3IrqEnabled = false;
+    irqFlag = false;
+    updateBanks();
     
     return true;
 }
 
+void Cartridge::saveState(StateWriter& out) const {
+    // Só o que é mutável; a ROM fica de fora
+    out.write(mirroring);
+    out.write(prgRam);
+    if (chrRom.empty()) {
+        out.write(chrRam);
+    }
+    out.writeBytes(extraVram.data(), extraVram.size());
+    out.write(irqFlag);
+    out.write(prgBankLo);
+    out.write(prgBankHi);
+    out.write(chrBank0);
+    out.write(chrBank1);
+    out.write(chrBankA);
+    out.write(chrBankB);
+    out.write(chrBankC);
+    out.write(chrBankD);
+    out.write(chrBankE);
+    out.write(chrBankF);
+    out.write(mmc1Shift);
+    out.write(mmc1Control);
+    out.write(mmc3BankSelect);
+    out.write(mmc3IrqLatch);
+    out.write(mmc3IrqCounter);
+    out.write(mmc3IrqReload);
+    out.write(mmc3IrqEnabled);
+}
+
+void Cartridge::loadState(StateReader& in) {
+    // Four-screen é fixo no cabeçalho; os outros modos o mapper escolhe
+    int saved;
+    in.read(saved);
+    bool fourScreen = !extraVram.empty();
+    if (fourScreen ? saved != MIRROR_FOUR_SCREEN : (saved < 0 || saved > MIRROR_SINGLE_HIGH)) {
+        in.invalidate();
+    } else {
+        mirroring = saved;
+    }
+    in.read(prgRam);
+    if (chrRom.empty()) {
+        in.read(chrRam);
+    }
+    in.readBytes(extraVram.data(), extraVram.size());
+    in.read(irqFlag);
+    in.read(prgBankLo);
+    in.read(prgBankHi);
+    in.read(chrBank0);
+    in.read(chrBank1);
+    in.read(chrBankA);
+    in.read(chrBankB);
+    in.read(chrBankC);
+    in.read(chrBankD);
+    in.read(chrBankE);
+    in.read(chrBankF);
+    in.read(mmc1Shift);
+    in.read(mmc1Control);
+    in.read(mmc3BankSelect);
+    in.read(mmc3IrqLatch);
+    in.read(mmc3IrqCounter);
+    in.read(mmc3IrqReload);
+    in.read(mmc3IrqEnabled);
+    updateBanks();
+}
+
 uint8_t Cartridge::readPRG(uint16_t addr) {
     if (addr < 0x6000) {
         return 0;
     } else if (addr < 0x8000) {
         return prgRam[addr - 0x6000];
-    } else {
-        size_t prgAddr = addr - 0x8000;
-        if (prgAddr < prgRom.size()) {
-            return prgRom[prgAddr];
-        }
-        return 0;
     }
+    return prgPages[(addr >> 13) & 0x03][addr & 0x1FFF];
+}
+
+const uint8_t* Cartridge::getPRGPointer(uint16_t addr) const {
+    if (addr < 0x6000) {
+        return nullptr;
+    } else if (addr < 0x8000) {
+        return &prgRam[addr - 0x6000];
+    }
+    if (prgRom.empty()) {
+        return nullptr;
+    }
+    return &prgPages[(addr >> 13) & 0x03][addr & 0x1FFF];
 }
 
 void Cartridge::writePRG(uint16_t addr, uint8_t value) {
@@ -77,22 +177,155 @@ void Cartridge::writePRG(uint16_t addr, uint8_t value) {
     }
 }
 
-uint8_t Cartridge::readCHR(uint16_t addr) {
-    if (!chrRom.empty()) {
-        if (addr < chrRom.size()) {
-            return chrRom[addr];
+void Cartridge::writeCHR(uint16_t addr, uint8_t value) {
+    // CHR ROM não é gravável; com CHR RAM as páginas apontam para chrRam
+    if (chrRom.empty()) {
+        chrPages[(addr >> 10) & 0x07][addr & 0x3FF] = value;
+    }
+}
+
+void Cartridge::setCIRAM(uint8_t* ciram) {
+    this->ciram = ciram;
+    updateBanks();
+}
+
+void Cartridge::mapPRG8(int slot, size_t bank) {
+    size_t count = prgRom.size() / 0x2000;
+    prgPages[slot] = count ? &prgRom[(bank % count) * 0x2000] : EMPTY_PRG;
+}
+
+void Cartridge::mapPRG16(int slot, size_t bank) {
+    mapPRG8(slot * 2, bank * 2);
+    mapPRG8(slot * 2 + 1, bank * 2 + 1);
+}
+
+void Cartridge::mapCHR1(int slot, size_t bank) {
+    uint8_t* base = chrRom.empty() ? chrRam.data() : chrRom.data();
+    size_t count = (chrRom.empty() ? chrRam.size() : chrRom.size()) / 0x400;
+    chrPages[slot] = base + (bank % count) * 0x400;
+}
+
+void Cartridge::mapCHR4(int slot, size_t bank) {
+    for (int i = 0; i < 4; i++) {
+        mapCHR1(slot * 4 + i, bank * 4 + i);
+    }
+}
+
+void Cartridge::updateBanks() {
+    size_t prg16 = prgRom.size() / 0x4000;
+    size_t last16 = prg16 ? prg16 - 1 : 0;
+    size_t last8 = last16 * 2 + 1;
+    
+    switch (mapperNumber) {
+        case 1: {
+            // MMC1
+            static const int MMC1_MIRRORING[4] = {
+                MIRROR_SINGLE_LOW, MIRROR_SINGLE_HIGH, MIRROR_VERTICAL, MIRROR_HORIZONTAL
+            };
+            if (mirroring != MIRROR_FOUR_SCREEN) {
+                mirroring = MMC1_MIRRORING[mmc1Control & 0x03];
+            }
+            
+            uint8_t bank = prgBankLo & 0x0F;
+            switch ((mmc1Control >> 2) & 0x03) {
+                case 0:
+                case 1:  // 32KB
+                    mapPRG16(0, bank & 0x0E);
+                    mapPRG16(1, bank | 0x01);
+                    break;
+                case 2:  // $8000 fixo no primeiro banco
+                    mapPRG16(0, 0);
+                    mapPRG16(1, bank);
+                    break;
+                case 3:  // $C000 fixo no último banco
+                    mapPRG16(0, bank);
+                    mapPRG16(1, last16);
+                    break;
+            }
+            
+            if (mmc1Control & 0x10) {
+                mapCHR4(0, chrBank0);
+                mapCHR4(1, chrBank1);
+            } else {
+                mapCHR4(0, chrBank0 & 0x1E);
+                mapCHR4(1, chrBank0 | 0x01);
+            }
+            break;
         }
-    } else if (!chrRam.empty()) {
-        if (addr < chrRam.size()) {
-            return chrRam[addr];
+        case 2:
+            // UNROM
+            mapPRG16(0, prgBankLo);
+            mapPRG16(1, last16);
+            mapCHR4(0, 0);
+            mapCHR4(1, 1);
+            break;
+        case 3:
+            // CNROM
+            mapPRG16(0, 0);
+            mapPRG16(1, last16);
+            mapCHR4(0, chrBank0 * 2);
+            mapCHR4(1, chrBank0 * 2 + 1);
+            break;
+        case 4: {
+            // MMC3: R6/R7 em prgBankLo/Hi, R0-R5 em chrBankA-F
+            if (mmc3BankSelect & 0x40) {
+                mapPRG8(0, last8 - 1);
+                mapPRG8(2, prgBankLo);
+            } else {
+                mapPRG8(0, prgBankLo);
+                mapPRG8(2, last8 - 1);
+            }
+            mapPRG8(1, prgBankHi);
+            mapPRG8(3, last8);
+            
+            // Inversão de A12: bancos de 2KB em $1000 em vez de $0000
+            int big = (mmc3BankSelect & 0x80) ? 4 : 0;
+            int small = big ^ 4;
+            mapCHR1(big + 0, chrBankA & 0xFE);
+            mapCHR1(big + 1, chrBankA | 0x01);
+            mapCHR1(big + 2, chrBankB & 0xFE);
+            mapCHR1(big + 3, chrBankB | 0x01);
+            mapCHR1(small + 0, chrBankC);
+            mapCHR1(small + 1, chrBankD);
+            mapCHR1(small + 2, chrBankE);
+            mapCHR1(small + 3, chrBankF);
+            break;
         }
+        case 7:
+            // AOROM: 32KB
+            mapPRG16(0, prgBankLo * 2);
+            mapPRG16(1, prgBankLo * 2 + 1);
+            mapCHR4(0, 0);
+            mapCHR4(1, 1);
+            break;
+        default:
+            // NROM: 16KB espelhado em $C000
+            mapPRG16(0, 0);
+            mapPRG16(1, last16);
+            mapCHR4(0, 0);
+            mapCHR4(1, 1);
+            break;
     }
-    return 0;
+    
+    updateNametables();
 }
 
-void Cartridge::writeCHR(uint16_t addr, uint8_t value) {
-    if (!chrRam.empty() && addr < chrRam.size()) {
-        chrRam[addr] = value;
+void Cartridge::updateNametables() {
+    if (!ciram) {
+        nametablePages.fill(nullptr);
+        return;
+    }
+    
+    uint8_t* a = ciram;
+    uint8_t* b = ciram + 0x400;
+    switch (mirroring) {
+        case MIRROR_VERTICAL:    nametablePages = {a, b, a, b}; break;
+        case MIRROR_SINGLE_LOW:  nametablePages = {a, a, a, a}; break;
+        case MIRROR_SINGLE_HIGH: nametablePages = {b, b, b, b}; break;
+        case MIRROR_FOUR_SCREEN:
+            nametablePages = {a, b, extraVram.data(), extraVram.data() + 0x400};
+            break;
+        default:                 nametablePages = {a, a, b, b}; break;
     }
 }
 
@@ -101,48 +334,124 @@ void Cartridge::writeMapper0(uint16_t addr, uint8_t value) {
 }
 
 void Cartridge::writeMapper1(uint16_t addr, uint8_t value) {
-    // MMC1 - implementação básica
+    // MMC1: 5 escritas seriais carregam o registrador escolhido por A13-A14
+    if (value & 0x80) {
+        mmc1Shift = 0x10;
+        mmc1Control |= 0x0C;
+        updateBanks();
+        return;
+    }
+    
+    bool complete = (mmc1Shift & 0x01) != 0;
+    mmc1Shift = (mmc1Shift >> 1) | ((value & 0x01) << 4);
+    if (!complete) {
+        return;
+    }
+    
+    switch ((addr >> 13) & 0x03) {
+        case 0: mmc1Control = mmc1Shift; break;
+        case 1: chrBank0 = mmc1Shift; break;
+        case 2: chrBank1 = mmc1Shift; break;
+        case 3: prgBankLo = mmc1Shift & 0x0F; break;
+    }
+    mmc1Shift = 0x10;
+    updateBanks();
 }
 
 void Cartridge::writeMapper2(uint16_t addr, uint8_t value) {
     // UNROM
     prgBankLo = (value & 0x0F);
+    updateBanks();
 }
 
 void Cartridge::writeMapper3(uint16_t addr, uint8_t value) {
     // CNROM
     chrBank0 = (value & 0x03);
+    updateBanks();
 }
 
 void Cartridge::writeMapper4(uint16_t addr, uint8_t value) {
-    // MMC3 - implementação básica
-}
-
-void Cartridge::writeMapper7(uint16_t addr, uint8_t value) {
-    // AOROM
-    prgBankLo = (value & 0x07);
-}
-
-uint8_t Cartridge::readMapper0(uint16_t addr) {
-    return prgRom[addr - 0x8000];
-}
-
-uint8_t Cartridge::readMapper1(uint16_t addr) {
-    return prgRom[addr - 0x8000];
+    // MMC3
+    bool odd = (addr & 0x01) != 0;
+    switch (addr & 0xE000) {
+        case 0x8000:
+            if (!odd) {
+                mmc3BankSelect = value;
+            } else {
+                uint8_t* banks[8] = {
+                    &chrBankA, &chrBankB, &chrBankC, &chrBankD,
+                    &chrBankE, &chrBankF, &prgBankLo, &prgBankHi
+                };
+                *banks[mmc3BankSelect & 0x07] = (mmc3BankSelect & 0x07) >= 6 ? (value & 0x3F) : value;
+            }
+            updateBanks();
+            break;
+        case 0xA000:
+            if (!odd && mirroring != MIRROR_FOUR_SCREEN) {
+                mirroring = (value & 0x01) ? MIRROR_HORIZONTAL : MIRROR_VERTICAL;
+                updateNametables();
+            }
+            break;
+        case 0xC000:
+            if (!odd) {
+                mmc3IrqLatch = value;
+            } else {
+                // Recarrega no próximo clock
+                mmc3IrqCounter = 0;
+                mmc3IrqReload = true;
+            }
+            break;
+        case 0xE000:
+            mmc3IrqEnabled = odd;
+            if (!odd) {
+                irqFlag = false;
+            }
+            break;
+    }
 }
 
-uint8_t Cartridge::readMapper2(uint16_t addr) {
-    return prgRom[addr - 0x8000];
+void Cartridge::clockScanlineCounter() {
+    if (mmc3IrqCounter == 0 || mmc3IrqReload) {
+        mmc3IrqCounter = mmc3IrqLatch;
+        mmc3IrqReload = false;
+    } else {
+        mmc3IrqCounter--;
+    }
+    if (mmc3IrqCounter == 0 && mmc3IrqEnabled) {
+        irqFlag = true;
+    }
 }
 
-uint8_t Cartridge::readMapper3(uint16_t addr) {
-    return prgRom[addr - 0x8000];
+void Cartridge::advanceScanlineCounter(uint32_t clocks) {
+    if (clocks == 0) {
+        return;
+    }
+    clockScanlineCounter();
+    clocks--;
+    if (clocks <= mmc3IrqCounter) {
+        mmc3IrqCounter -= static_cast<uint8_t>(clocks);
+        return;
+    }
+    // Do zero em diante o contador percorre latch, latch - 1, ..., 0
+    clocks -= mmc3IrqCounter;
+    uint32_t period = mmc3IrqLatch + 1u;
+    uint32_t phase = clocks % period;
+    mmc3IrqCounter = phase == 0 ? 0 : static_cast<uint8_t>(period - phase);
 }
 
-uint8_t Cartridge::readMapper4(uint16_t addr) {
-    return prgRom[addr - 0x8000];
+uint32_t Cartridge::scanlineClocksUntilIRQ() const {
+    if (!mmc3IrqEnabled) {
+        return UINT32_MAX;
+    }
+    if (mmc3IrqCounter == 0 || mmc3IrqReload) {
+        return mmc3IrqLatch + 1u;
+    }
+    return mmc3IrqCounter;
 }
 
-uint8_t Cartridge::readMapper7(uint16_t addr) {
-    return prgRom[addr - 0x8000];
+void Cartridge::writeMapper7(uint16_t addr, uint8_t value) {
+    // AOROM
+    prgBankLo = (value & 0x07);
+    mirroring = (value & 0x10) ? MIRROR_SINGLE_HIGH : MIRROR_SINGLE_LOW;
+    updateBanks();
 }
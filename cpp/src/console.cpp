@@ -4,28 +4,94 @@
 #include "apu.h"
 #include "memory.h"
 #include "cartridge.h"
+#include "controller.h"
+#include "decode_cache.h"
+#include "pipeline.h"
+#include "profiler.h"
+#include "spsc_queue.h"
+#include "state.h"
+#include "telemetry.h"
+#include "trace.h"
 
-Console::Console() : frameCount(0), cyclesPerFrame(29780), emulationSpeed(1.0f), 
-                     showFPS(false) {
-    memory = std::make_shared<Memory>();
-    cpu = std::make_shared<CPU>(memory);
-    ppu = std::make_shared<PPU>();
-    apu = std::make_shared<APU>();
-    cartridge = std::make_shared<Cartridge>();
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+/**
+ * Bloco único com todo o estado mutável da instância
+ */
+struct alignas(64) Console::Core {
+    Memory memory;
+    CPU cpu;
+    PPU ppu;
+    APU apu;
+    Cartridge cartridge;
+    Controller controller;
+    
+    Core() : cpu(&memory) {}
+};
+
+Console::Console(bool compact) : frameCount(0), fastForwardFrames(1), batchFrames(0), emulationSpeed(1.0f),
+                                 showFPS(false), compact(compact),
+                                 headlessFlags(HEADLESS_NONE), traceEnabled(false), hasPendingInput(false),
+                                 moviePlayback(false), lastInputTimestamp(0), hostButtons(0), droppedPorts(0), timingEnabled(false),
+                                 timingCountdown(0), timingSeed(0x9E3779B9), clockOverheadNs(0),
+                                 sampledNs{0, 0, 0}, totals() {
+    static_assert(sizeof(Core) <= COMPACT_INSTANCE_BYTES,
+                  "Estado da instância excede o orçamento do modo compacto");
+    static_assert(DEFAULT_AUDIO_CAPACITY >= 2 * APU::SAMPLES_PER_FRAME,
+                  "Anel de áudio padrão menor que dois frames de amostras");
     
+    core = std::make_unique<Core>();
+    memory = &core->memory;
+    cpu = &core->cpu;
+    ppu = &core->ppu;
+    apu = &core->apu;
+    cartridge = &core->cartridge;
+    controller = &core->controller;
+    
+    memory->setCPU(cpu);
     memory->setPPU(ppu);
     memory->setAPU(apu);
     memory->setCartridge(cartridge);
+    memory->setController(controller);
+    ppu->setCartridge(cartridge);
+    setDecodeCacheEnabled(true);
     
-    buttonStates.fill(false);
+    // Fora do bloco de estado: os contadores por PC crescem com a ROM
+    if (Profiler::ENABLED) {
+        profiler = std::make_unique<Profiler>();
+        cpu->setProfiler(profiler.get());
+        memory->setProfiler(profiler.get());
+    }
+    
+    if (!compact) {
+        videoStorage.assign(PPU::FRAME_BUFFER_SIZE, 0);
+        audioStorage.assign(DEFAULT_AUDIO_CAPACITY, 0.0f);
+        ppu->setFrameBuffer(videoStorage.data());
+        apu->setAudioBuffer(audioStorage.data(), audioStorage.size());
+    }
+    
+    inputQueue = std::make_unique<SPSCQueue<InputEvent, INPUT_QUEUE_CAPACITY>>();
 }
 
-Console::~Console() {}
+Console::~Console() {
+    // A thread de renderização para antes do estado ser liberado
+    pipeline.reset();
+}
 
 bool Console::loadROM(const uint8_t* data, size_t size) {
     if (!cartridge->loadROM(data, size)) {
         return false;
     }
+    if (profiler) {
+        profiler->attach(cartridge);
+    }
+    if (decodeCache) {
+        decodeCache->attach(cartridge);
+    }
     reset();
     return true;
 }
@@ -34,38 +100,277 @@ void Console::reset() {
     cpu->reset();
     ppu->reset();
     apu->reset();
+    controller->reset();
     frameCount = 0;
-    buttonStates.fill(false);
+    restartPipeline();
 }
 
 void Console::runFrame() {
+    // Em fast-forward só o último frame é composto
+    bool video = !(headlessFlags & HEADLESS_NO_VIDEO);
+    batchFrames = 0;
+    for (int i = 0; i < fastForwardFrames; i++) {
+        setFrameVideo(video && i == fastForwardFrames - 1);
+        if (timingEnabled) {
+            runEmulatedFrameTimed();
+        } else {
+            runEmulatedFrame();
+            if (pipeline) {
+                pipeline->endFrame(ppu->getDotCount());
+            }
+        }
+    }
+    setFrameVideo(video);
+}
+
+void Console::runEmulatedFrameTimed() {
+    // Relógio lido só nas fronteiras do frame e da entrega; a divisão entre
+    // CPU, PPU e APU vem das instruções amostradas durante este frame
+    using Clock = std::chrono::steady_clock;
+    auto toNs = [](Clock::duration d) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    };
+    
     uint64_t startCycles = cpu->cycles;
-    uint64_t targetCycles = startCycles + (cyclesPerFrame / emulationSpeed);
+    uint64_t startMapperNs = memory->getMapperNs();
+    uint64_t startSampled[3] = {sampledNs[0], sampledNs[1], sampledNs[2]};
+    
+    auto t0 = Clock::now();
+    runEmulatedFrame();
+    auto t1 = Clock::now();
+    if (pipeline) {
+        pipeline->endFrame(ppu->getDotCount());
+    }
+    auto t2 = Clock::now();
     
-    while (cpu->cycles < targetCycles) {
-        runCycle();
+    FrameTelemetry record = {};
+    record.frame = frameCount;
+    record.timestampNs = toNs(t2.time_since_epoch());
+    uint64_t emulatedNs = toNs(t1 - t0);
+    record.outputNs = toNs(t2 - t1);
+    record.frameNs = emulatedNs + record.outputNs;
+    // O mapper roda dentro das instruções da CPU: sai da parcela dela
+    record.mapperNs = std::min(memory->getMapperNs() - startMapperNs, emulatedNs);
+    uint64_t remaining = emulatedNs - record.mapperNs;
+    uint64_t delta[3];
+    for (int i = 0; i < 3; i++) {
+        delta[i] = sampledNs[i] - startSampled[i];
+    }
+    uint64_t sampled = delta[0] + delta[1] + delta[2];
+    if (sampled > 0) {
+        double scale = static_cast<double>(remaining) / sampled;
+        record.ppuNs = static_cast<uint64_t>(delta[1] * scale);
+        record.apuNs = static_cast<uint64_t>(delta[2] * scale);
+        record.cpuNs = remaining - std::min(remaining, record.ppuNs + record.apuNs);
+    } else {
+        record.cpuNs = remaining;
     }
+    record.cycles = cpu->cycles - startCycles;
+    record.audioFill = static_cast<uint32_t>(apu->getAudioCount());
+    record.audioCapacity = static_cast<uint32_t>(apu->getAudioCapacity());
+    
+    totals.frameNs += record.frameNs;
+    totals.cpuNs += record.cpuNs;
+    totals.ppuNs += record.ppuNs;
+    totals.apuNs += record.apuNs;
+    totals.mapperNs += record.mapperNs;
+    totals.outputNs += record.outputNs;
+    telemetry->push(record);
+}
+
+void Console::setFrameVideo(bool compose) {
+    // No pipeline a PPU local só mantém o timing; quem compõe é a outra thread
+    if (pipeline) {
+        ppu->setVideoEnabled(false);
+        pipeline->setVideoEnabled(ppu->getDotCount(), compose);
+    } else {
+        ppu->setVideoEnabled(compose);
+    }
+}
+
+void Console::setPipelined(bool enabled) {
+    // Com um núcleo só as duas threads se revezam: a composição custa o
+    // mesmo e ainda paga as trocas de contexto
+    if (std::thread::hardware_concurrency() == 1) {
+        enabled = false;
+    }
+    if (enabled == (pipeline != nullptr)) {
+        return;
+    }
+    memory->setPipeline(nullptr);
+    pipeline.reset();
+    ppu->markAllRowsDirty();
+    if (enabled) {
+        pipeline = std::make_unique<RenderPipeline>(*ppu, *cartridge);
+        memory->setPipeline(pipeline.get());
+    }
+    setFrameVideo(!(headlessFlags & HEADLESS_NO_VIDEO));
+}
+
+void Console::restartPipeline() {
+    // Estado mudou fora do log (reset, load state): recomeça da cópia atual
+    if (pipeline) {
+        setPipelined(false);
+        setPipelined(true);
+    }
+}
+
+void Console::runEmulatedFrame() {
+    // Um frame emulado termina no início do vblank
+    applyInput();
+    if (batchFrames < MAX_FAST_FORWARD) {
+        batchButtons[batchFrames++] = controller->getAllButtons();
+    }
+    ppu->resetFrameReady();
+    
+    // PPU e APU só alcançam a CPU antes de um acesso a I/O (Memory) ou
+    // quando um vblank, evento do mapper ou IRQ de frame pode ter chegado;
+    // até lá a checagem de interrupções de runCycle daria o mesmo resultado
+    // da última vez, e a linha de IRQ (sensível a nível) continua igual
+    memory->takeDeviceAccess();
+    uint64_t budget = deviceBudget();
+    bool irqLine = apu->irqRequested() || cartridge->irqRequested();
+    while (!ppu->isFrameReady()) {
+        if (timingEnabled && --timingCountdown == 0) {
+            memory->syncDevices();
+            runCycleTimed();
+        } else {
+            uint64_t startCycles = cpu->cycles;
+            cpu->step();
+            memory->deferCycles(cpu->cycles - startCycles);
+            if (!memory->takeDeviceAccess() && memory->getPendingCycles() < budget) {
+                cpu->irqRequested = irqLine;
+                continue;
+            }
+            memory->syncDevices();
+            handleInterrupts();
+        }
+        memory->takeDeviceAccess();
+        budget = deviceBudget();
+        irqLine = cpu->irqRequested;
+    }
+    frameCount++;
+}
+
+uint64_t Console::deviceBudget() const {
+    // O trace grava scanline e dot antes de cada instrução
+    if (traceEnabled) {
+        return 0;
+    }
+    uint64_t vblank = (ppu->dotsUntilVBlank() + 2) / 3;
+    uint64_t mapper = (static_cast<uint64_t>(ppu->dotsUntilMapperEvent()) + 2) / 3;
+    return std::min<uint64_t>(std::min(vblank, mapper), apu->cyclesUntilIRQ());
+}
+
+void Console::setEmulationSpeed(float speed) {
+    setFastForward(static_cast<int>(std::lround(speed)));
+}
+
+void Console::setFastForward(int frames) {
+    fastForwardFrames = std::max(1, std::min(frames, MAX_FAST_FORWARD));
+    emulationSpeed = static_cast<float>(fastForwardFrames);
+    // Áudio comprimido no tempo: a taxa de saída continua a mesma
+    apu->setDecimation(fastForwardFrames);
 }
 
 void Console::runCycle() {
-    // CPU executa 1 ciclo
+    if (timingEnabled && --timingCountdown == 0) {
+        runCycleTimed();
+        return;
+    }
+    
+    // CPU executa 1 instrução; PPU e APU alcançam a CPU logo em seguida
+    uint64_t startCycles = cpu->cycles;
     cpu->step();
+    memory->deferCycles(cpu->cycles - startCycles);
+    memory->syncDevices();
+    handleInterrupts();
+}
+
+void Console::runCycleTimed() {
+    // Mesma sequência de runCycle, com o relógio lido só nas fronteiras
+    using Clock = std::chrono::steady_clock;
     
-    // PPU executa 3 ciclos (PPU é 3x mais rápido que CPU)
-    for (int i = 0; i < 3; i++) {
-        ppu->step();
-    }
+    // Próximo intervalo uniforme em [1, 2 * TIMING_SAMPLE_INTERVAL - 1]
+    timingSeed = timingSeed * 1664525 + 1013904223;
+    timingCountdown = 1 + (timingSeed >> 16) % (2 * TIMING_SAMPLE_INTERVAL - 1);
     
-    // APU executa 1 ciclo
-    apu->step();
+    auto t0 = Clock::now();
+    uint64_t startCycles = cpu->cycles;
+    cpu->step();
+    uint64_t elapsed = cpu->cycles - startCycles;
+    auto t1 = Clock::now();
+    
+    ppu->run(elapsed * 3);
+    auto t2 = Clock::now();
+    
+    apu->run(elapsed);
+    auto t3 = Clock::now();
     
     handleInterrupts();
+    
+    // Cada intervalo inclui uma leitura do relógio
+    auto net = [this](Clock::duration d) {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        return ns > clockOverheadNs ? ns - clockOverheadNs : 0;
+    };
+    sampledNs[0] += net(t1 - t0);
+    sampledNs[1] += net(t2 - t1);
+    sampledNs[2] += net(t3 - t2);
+    totals.samples++;
+}
+
+void Console::setTimingEnabled(bool enabled) {
+    timingEnabled = enabled;
+    timingCountdown = TIMING_SAMPLE_INTERVAL;
+    memory->setMapperTiming(enabled);
+    if (enabled && !telemetry) {
+        telemetry = std::make_unique<TelemetryRing>();
+    }
+    if (enabled && clockOverheadNs == 0) {
+        // Menor intervalo entre duas leituras consecutivas
+        using Clock = std::chrono::steady_clock;
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 256; i++) {
+            auto t0 = Clock::now();
+            auto t1 = Clock::now();
+            uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+            best = std::min(best, ns);
+        }
+        clockOverheadNs = static_cast<uint32_t>(best);
+    }
+}
+
+ComponentTimings Console::getTimings() const {
+    return totals;
+}
+
+void Console::resetTimings() {
+    // O anel de telemetria continua: os leitores acompanham por count()
+    totals = ComponentTimings();
 }
 
 const uint8_t* Console::getFrameBuffer() const {
+    if (pipeline) {
+        return pipeline->getFrameBuffer();
+    }
     return ppu->getFrameBuffer();
 }
 
+DirtyRows Console::takeDirtyRows() {
+    if (pipeline) {
+        return pipeline->takeDirtyRows();
+    }
+    return ppu->takeDirtyRows();
+}
+
+bool Console::isFrameIdentical() const {
+    if (pipeline) {
+        return !pipeline->hasDirtyRows();
+    }
+    return ppu->getDirtyRows().none();
+}
+
 float Console::getAudioSample() {
     return apu->getSample();
 }
@@ -74,48 +379,230 @@ bool Console::hasAudioData() const {
     return apu->hasAudioData();
 }
 
+size_t Console::getAudioAvailable(size_t& head) const {
+    head = apu->getAudioHead();
+    return apu->getAudioCount();
+}
+
+void Console::consumeAudio(size_t count) {
+    apu->consumeAudio(count);
+}
+
+uint64_t Console::getAudioOverruns() const {
+    return apu->getAudioOverruns();
+}
+
+void Console::setFrameBuffer(uint8_t* buffer) {
+    ppu->setFrameBuffer(buffer);
+}
+
+void Console::setAudioBuffer(float* buffer, size_t capacity) {
+    apu->setAudioBuffer(buffer, capacity);
+}
+
+size_t Console::getMemoryFootprint() const {
+    return sizeof(Console) + sizeof(Core) +
+           videoStorage.capacity() + audioStorage.capacity() * sizeof(float) +
+           cartridge->getROMBytes() + (decodeCache ? decodeCache->getMemoryUsage() : 0);
+}
+
+void Console::setDecodeCacheEnabled(bool enabled) {
+    if (enabled == (decodeCache != nullptr)) {
+        return;
+    }
+    if (enabled) {
+        decodeCache = std::make_unique<DecodeCache>();
+        decodeCache->attach(cartridge);
+    } else {
+        decodeCache.reset();
+    }
+    cpu->setDecodeCache(decodeCache.get());
+}
+
+void Console::setHeadless(uint8_t flags) {
+    headlessFlags = flags & HEADLESS_ALL;
+    setFrameVideo(!(headlessFlags & HEADLESS_NO_VIDEO));
+    apu->setSynthesisEnabled(!(headlessFlags & HEADLESS_NO_AUDIO));
+}
+
 void Console::setButtonState(int button, bool pressed) {
-    if (button >= 0 && button < 8) {
-        buttonStates[button] = pressed;
+    if (button < 0 || button >= 8) {
+        return;
     }
+    uint8_t buttons = static_cast<uint8_t>(hostButtons.load(std::memory_order_relaxed));
+    uint8_t mask = 1 << button;
+    setButtons(0, pressed ? (buttons | mask) : (buttons & ~mask));
 }
 
-std::vector<uint8_t> Console::getState() const {
-    std::vector<uint8_t> state;
-    
-    // Salvar estado da CPU
-    state.push_back(cpu->pc >> 8);
-    state.push_back(cpu->pc & 0xFF);
-    state.push_back(cpu->sp);
-    state.push_back(cpu->a);
-    state.push_back(cpu->x);
-    state.push_back(cpu->y);
-    state.push_back(cpu->getStatus());
-    
-    // Salvar estado da PPU
-    // ... (implementação simplificada)
+void Console::setButtons(int port, uint8_t buttons) {
+    port &= 0x01;
+    // Uma thread produtora: ler e gravar em separado não perde nada
+    int shift = port * 8;
+    uint16_t latest = hostButtons.load(std::memory_order_relaxed);
+    latest = static_cast<uint16_t>((latest & ~(0xFF << shift)) | (buttons << shift));
+    hostButtons.store(latest, std::memory_order_release);
+    if (!pushInput({0, 0, static_cast<uint8_t>(port), buttons})) {
+        droppedPorts.fetch_or(static_cast<uint8_t>(1 << port), std::memory_order_release);
+    }
+}
+
+bool Console::pushInput(const InputEvent& event) {
+    return inputQueue->push(event);
+}
+
+void Console::setMoviePlayback(bool enabled) {
+    moviePlayback = enabled;
+}
+
+void Console::setMovieButtons(uint16_t buttons) {
+    controller->setButtons(0, static_cast<uint8_t>(buttons & 0xFF));
+    controller->setButtons(1, static_cast<uint8_t>(buttons >> 8));
+}
+
+uint16_t Console::getButtons() const {
+    return controller->getAllButtons();
+}
+
+uint16_t Console::getBatchButtons(int frame) const {
+    return batchButtons[frame];
+}
+
+void Console::applyInput() {
+    // O filme manda nos controles: a fila só é esvaziada
+    if (moviePlayback) {
+        while (inputQueue->pop(pendingInput)) {
+            // Evento da UI descartado
+        }
+        hasPendingInput = false;
+        droppedPorts.store(0, std::memory_order_relaxed);
+        return;
+    }
     
-    // Salvar estado da memória RAM
-    const uint8_t* ram = memory->getRam();
-    for (int i = 0; i < 0x800; i++) {
-        state.push_back(ram[i]);
+    // Eventos com frame futuro ficam retidos até o frame chegar
+    for (;;) {
+        if (!hasPendingInput) {
+            if (!inputQueue->pop(pendingInput)) {
+                break;
+            }
+            hasPendingInput = true;
+        }
+        if (pendingInput.frame > frameCount) {
+            break;
+        }
+        controller->setButtons(pendingInput.port & 0x01, pendingInput.buttons);
+        lastInputTimestamp = pendingInput.timestamp;
+        hasPendingInput = false;
     }
     
+    // Estados que não couberam na fila são mais novos que tudo o que está nela
+    uint8_t dropped = droppedPorts.exchange(0, std::memory_order_acquire);
+    if (dropped) {
+        uint16_t latest = hostButtons.load(std::memory_order_acquire);
+        for (int port = 0; port < 2; port++) {
+            if (dropped & (1 << port)) {
+                controller->setButtons(port, static_cast<uint8_t>(latest >> (port * 8)));
+            }
+        }
+    }
+}
+
+// Cabeçalho do save state: "NESS", versão, hash da ROM
+static const uint8_t STATE_MAGIC[4] = {'N', 'E', 'S', 'S'};
+static const uint8_t STATE_VERSION = 2;
+
+void Console::writeState(StateWriter& out) const {
+    out.write(STATE_MAGIC);
+    out.write(STATE_VERSION);
+    out.write(cartridge->getROMHash());
+    out.write(frameCount);
+    cpu->saveState(out);
+    memory->saveState(out);
+    ppu->saveState(out);
+    apu->saveState(out);
+    cartridge->saveState(out);
+    controller->saveState(out);
+}
+
+size_t Console::getStateSize() const {
+    StateWriter counter;
+    writeState(counter);
+    return counter.size();
+}
+
+size_t Console::saveState(uint8_t* buffer, size_t capacity) const {
+    StateWriter out(buffer, capacity);
+    writeState(out);
+    return out.ok() ? out.size() : 0;
+}
+
+std::vector<uint8_t> Console::getState() const {
+    std::vector<uint8_t> state(getStateSize());
+    saveState(state.data(), state.size());
     return state;
 }
 
 bool Console::setState(const uint8_t* data, size_t size) {
-    if (size < 7) return false;
+    // Valida tudo antes de tocar no estado
+    if (size != getStateSize()) return false;
     
-    // Restaurar estado da CPU
-    cpu->pc = (data[0] << 8) | data[1];
-    cpu->sp = data[2];
-    cpu->a = data[3];
-    cpu->x = data[4];
-    cpu->y = data[5];
-    cpu->setStatus(data[6]);
+    // Campos inválidos só aparecem no meio da leitura: guarda o estado atual
+    // para desfazer. Por thread, para não pesar no orçamento da instância.
+    static thread_local std::vector<uint8_t> rollback;
+    rollback.resize(size);
+    saveState(rollback.data(), rollback.size());
     
-    return true;
+    bool loaded = readState(data, size);
+    if (!loaded) {
+        readState(rollback.data(), rollback.size());
+    }
+    
+    // A cópia da thread de renderização precisa recomeçar deste estado
+    restartPipeline();
+    return loaded;
+}
+
+bool Console::readState(const uint8_t* data, size_t size) {
+    StateReader in(data, size);
+    uint8_t magic[4];
+    uint8_t version;
+    uint64_t romHash;
+    in.read(magic);
+    in.read(version);
+    in.read(romHash);
+    if (std::memcmp(magic, STATE_MAGIC, 4) != 0 || version != STATE_VERSION ||
+        romHash != cartridge->getROMHash()) {
+        return false;
+    }
+    
+    in.read(frameCount);
+    cpu->loadState(in);
+    memory->loadState(in);
+    ppu->loadState(in);
+    apu->loadState(in);
+    cartridge->loadState(in);
+    controller->loadState(in);
+    return in.ok();
+}
+
+uint64_t Console::getROMHash() const {
+    return cartridge->getROMHash();
+}
+
+Profiler* Console::getProfiler() {
+    return profiler.get();
+}
+
+void Console::setTraceEnabled(bool enabled, size_t capacity) {
+    traceEnabled = enabled;
+    if (enabled) {
+        size_t wanted = capacity ? capacity : Tracer::DEFAULT_CAPACITY;
+        if (!tracer || tracer->getCapacity() < wanted) {
+            tracer = std::make_unique<Tracer>(wanted);
+            tracer->attach(memory, ppu);
+        }
+        tracer->clear();
+    }
+    cpu->setTracer(enabled ? tracer.get() : nullptr);
 }
 
 uint64_t Console::getCycles() const {
@@ -128,7 +615,7 @@ void Console::handleInterrupts() {
         ppu->resetNMI();
     }
     
-    if (cpu->irqRequested) {
-        // Processar IRQ
-    }
+    // IRQ é sensível a nível: permanece enquanto alguma fonte estiver ativa
+    // e cai com o reconhecimento ($4015, $E000 do MMC3) antes de ser atendido
+    cpu->irqRequested = apu->irqRequested() || cartridge->irqRequested();
 }
@@ -0,0 +1,51 @@
+#include "controller.h"
+#include "state.h"
+
+Controller::Controller() : buttonState(0), shift{0, 0}, strobe(false) {
+}
+
+void Controller::write(uint8_t value) {
+    strobe = (value & 0x01) != 0;
+    if (strobe) {
+        shift[0] = getButtons(0);
+        shift[1] = getButtons(1);
+    }
+}
+
+uint8_t Controller::read(int port) {
+    if (strobe) {
+        shift[port] = getButtons(port);
+    }
+    uint8_t bit = shift[port] & 0x01;
+    // Depois do oitavo bit o controle oficial devolve 1
+    shift[port] = (shift[port] >> 1) | 0x80;
+    // Bits 5-7 são open bus (normalmente o byte alto do endereço, $40)
+    return 0x40 | bit;
+}
+
+void Controller::reset() {
+    shift[0] = 0;
+    shift[1] = 0;
+    strobe = false;
+}
+
+void Controller::setButtons(int port, uint8_t buttons) {
+    uint16_t state = buttonState.load(std::memory_order_relaxed);
+    int bits = port * 8;
+    state = (state & ~(0xFF << bits)) | (buttons << bits);
+    buttonState.store(state, std::memory_order_relaxed);
+}
+
+void Controller::saveState(StateWriter& out) const {
+    out.write(getAllButtons());
+    out.write(shift);
+    out.write(strobe);
+}
+
+void Controller::loadState(StateReader& in) {
+    uint16_t buttons;
+    in.read(buttons);
+    in.read(shift);
+    in.read(strobe);
+    buttonState.store(buttons, std::memory_order_relaxed);
+}
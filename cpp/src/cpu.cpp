@@ -1,30 +1,600 @@
 #include "cpu.h"
 #include "memory.h"
-
-CPU::CPU(std::shared_ptr<Memory> memory) 
-    : pc(0), sp(0xFF), a(0), x(0), y(0),
-      flagC(false), flagZ(false), flagI(false), flagD(false),
+#include "decode_cache.h"
+#include "opcodes.h"
+#include "profiler.h"
+#include "state.h"
+#include "trace.h"
+
+/**
+ * Handlers dos 256 opcodes. O modo de endereçamento é parâmetro de template,
+ * então cada entrada da tabela é uma função especializada sem switch.
+ */
+struct CPUOps {
+    // Endereço efetivo; 'penalty' soma o ciclo extra de página cruzada
+    template <AddressingMode M>
+    static uint16_t address(CPU& cpu, uint16_t operand, bool penalty) {
+        if constexpr (M == MODE_ZERO_PAGE_X) {
+            return (operand + cpu.x) & 0xFF;
+        } else if constexpr (M == MODE_ZERO_PAGE_Y) {
+            return (operand + cpu.y) & 0xFF;
+        } else if constexpr (M == MODE_ABSOLUTE_X) {
+            return indexed(cpu, operand, cpu.x, penalty);
+        } else if constexpr (M == MODE_ABSOLUTE_Y) {
+            return indexed(cpu, operand, cpu.y, penalty);
+        } else if constexpr (M == MODE_INDIRECT_X) {
+            return cpu.readZeroPageWord((operand + cpu.x) & 0xFF);
+        } else if constexpr (M == MODE_INDIRECT_Y) {
+            return indexed(cpu, cpu.readZeroPageWord(operand & 0xFF), cpu.y, penalty);
+        } else {
+            return operand;  // Página zero e absoluto
+        }
+    }
+    
+    static uint16_t indexed(CPU& cpu, uint16_t base, uint8_t index, bool penalty) {
+        uint16_t addr = base + index;
+        if (penalty && ((base ^ addr) & 0xFF00)) {
+            cpu.cycles++;
+        }
+        return addr;
+    }
+    
+    template <AddressingMode M>
+    static uint8_t load(CPU& cpu, uint16_t operand) {
+        if constexpr (M == MODE_IMMEDIATE) {
+            return operand & 0xFF;
+        } else {
+            return cpu.memory->read(address<M>(cpu, operand, true));
+        }
+    }
+    
+    template <AddressingMode M>
+    static void store(CPU& cpu, uint16_t operand, uint8_t value) {
+        cpu.memory->write(address<M>(cpu, operand, false), value);
+    }
+    
+    // Leitura
+    template <AddressingMode M> static void opLDA(CPU& cpu, uint16_t op) { cpu.a = load<M>(cpu, op); cpu.setZN(cpu.a); }
+    template <AddressingMode M> static void opLDX(CPU& cpu, uint16_t op) { cpu.x = load<M>(cpu, op); cpu.setZN(cpu.x); }
+    template <AddressingMode M> static void opLDY(CPU& cpu, uint16_t op) { cpu.y = load<M>(cpu, op); cpu.setZN(cpu.y); }
+    template <AddressingMode M> static void opLAX(CPU& cpu, uint16_t op) { cpu.a = cpu.x = load<M>(cpu, op); cpu.setZN(cpu.a); }
+    template <AddressingMode M> static void opORA(CPU& cpu, uint16_t op) { cpu.a |= load<M>(cpu, op); cpu.setZN(cpu.a); }
+    template <AddressingMode M> static void opAND(CPU& cpu, uint16_t op) { cpu.a &= load<M>(cpu, op); cpu.setZN(cpu.a); }
+    template <AddressingMode M> static void opEOR(CPU& cpu, uint16_t op) { cpu.a ^= load<M>(cpu, op); cpu.setZN(cpu.a); }
+    template <AddressingMode M> static void opADC(CPU& cpu, uint16_t op) { cpu.adc(load<M>(cpu, op)); }
+    template <AddressingMode M> static void opSBC(CPU& cpu, uint16_t op) { cpu.sbc(load<M>(cpu, op)); }
+    template <AddressingMode M> static void opCMP(CPU& cpu, uint16_t op) { cpu.cmp(cpu.a, load<M>(cpu, op)); }
+    template <AddressingMode M> static void opCPX(CPU& cpu, uint16_t op) { cpu.cmp(cpu.x, load<M>(cpu, op)); }
+    template <AddressingMode M> static void opCPY(CPU& cpu, uint16_t op) { cpu.cmp(cpu.y, load<M>(cpu, op)); }
+    template <AddressingMode M> static void opBIT(CPU& cpu, uint16_t op) { cpu.bit(load<M>(cpu, op)); }
+    
+    template <AddressingMode M>
+    static void opLAS(CPU& cpu, uint16_t op) {
+        cpu.a = cpu.x = cpu.sp = load<M>(cpu, op) & cpu.sp;
+        cpu.setZN(cpu.a);
+    }
+    
+    // NOPs com operando ainda fazem a leitura (efeitos colaterais de I/O)
+    template <AddressingMode M>
+    static void opNOP(CPU& cpu, uint16_t op) {
+        if constexpr (M != MODE_IMPLIED && M != MODE_IMMEDIATE) {
+            load<M>(cpu, op);
+        }
+    }
+    
+    // Escrita
+    template <AddressingMode M> static void opSTA(CPU& cpu, uint16_t op) { store<M>(cpu, op, cpu.a); }
+    template <AddressingMode M> static void opSTX(CPU& cpu, uint16_t op) { store<M>(cpu, op, cpu.x); }
+    template <AddressingMode M> static void opSTY(CPU& cpu, uint16_t op) { store<M>(cpu, op, cpu.y); }
+    template <AddressingMode M> static void opSAX(CPU& cpu, uint16_t op) { store<M>(cpu, op, cpu.a & cpu.x); }
+    
+    // Escritas instáveis: valor AND (byte alto do endereço base + 1)
+    static void opSHY(CPU& cpu, uint16_t op) {
+        cpu.memory->write(op + cpu.x, cpu.y & ((op >> 8) + 1));
+    }
+    
+    static void opSHX(CPU& cpu, uint16_t op) {
+        cpu.memory->write(op + cpu.y, cpu.x & ((op >> 8) + 1));
+    }
+    
+    template <AddressingMode M>
+    static void opAHX(CPU& cpu, uint16_t op) {
+        uint16_t base = M == MODE_INDIRECT_Y ? cpu.readZeroPageWord(op & 0xFF) : op;
+        cpu.memory->write(base + cpu.y, cpu.a & cpu.x & ((base >> 8) + 1));
+    }
+    
+    static void opTAS(CPU& cpu, uint16_t op) {
+        cpu.sp = cpu.a & cpu.x;
+        cpu.memory->write(op + cpu.y, cpu.sp & ((op >> 8) + 1));
+    }
+    
+    // Leitura-modificação-escrita; F devolve o novo valor
+    using Modifier = uint8_t (*)(CPU& cpu, uint8_t value);
+    
+    template <AddressingMode M, Modifier F>
+    static void modify(CPU& cpu, uint16_t op) {
+        if constexpr (M == MODE_ACCUMULATOR) {
+            cpu.a = F(cpu, cpu.a);
+        } else {
+            uint16_t addr = address<M>(cpu, op, false);
+            cpu.memory->write(addr, F(cpu, cpu.memory->read(addr)));
+        }
+    }
+    
+    static uint8_t asl(CPU& cpu, uint8_t value) {
+        cpu.flagC = (value & 0x80) != 0;
+        value <<= 1;
+        cpu.setZN(value);
+        return value;
+    }
+    
+    static uint8_t lsr(CPU& cpu, uint8_t value) {
+        cpu.flagC = (value & 0x01) != 0;
+        value >>= 1;
+        cpu.setZN(value);
+        return value;
+    }
+    
+    static uint8_t rol(CPU& cpu, uint8_t value) {
+        uint8_t result = (value << 1) | (cpu.flagC ? 0x01 : 0);
+        cpu.flagC = (value & 0x80) != 0;
+        cpu.setZN(result);
+        return result;
+    }
+    
+    static uint8_t ror(CPU& cpu, uint8_t value) {
+        uint8_t result = (value >> 1) | (cpu.flagC ? 0x80 : 0);
+        cpu.flagC = (value & 0x01) != 0;
+        cpu.setZN(result);
+        return result;
+    }
+    
+    static uint8_t inc(CPU& cpu, uint8_t value) { cpu.setZN(++value); return value; }
+    static uint8_t dec(CPU& cpu, uint8_t value) { cpu.setZN(--value); return value; }
+    
+    static uint8_t slo(CPU& cpu, uint8_t value) { value = asl(cpu, value); cpu.a |= value; cpu.setZN(cpu.a); return value; }
+    static uint8_t rla(CPU& cpu, uint8_t value) { value = rol(cpu, value); cpu.a &= value; cpu.setZN(cpu.a); return value; }
+    static uint8_t sre(CPU& cpu, uint8_t value) { value = lsr(cpu, value); cpu.a ^= value; cpu.setZN(cpu.a); return value; }
+    static uint8_t rra(CPU& cpu, uint8_t value) { value = ror(cpu, value); cpu.adc(value); return value; }
+    static uint8_t dcp(CPU& cpu, uint8_t value) { value--; cpu.cmp(cpu.a, value); return value; }
+    static uint8_t isb(CPU& cpu, uint8_t value) { value++; cpu.sbc(value); return value; }
+    
+    // Imediatos não documentados
+    static void opANC(CPU& cpu, uint16_t op) {
+        cpu.a &= op;
+        cpu.setZN(cpu.a);
+        cpu.flagC = cpu.flagN;
+    }
+    
+    static void opALR(CPU& cpu, uint16_t op) {
+        cpu.a = lsr(cpu, cpu.a & op);
+    }
+    
+    static void opARR(CPU& cpu, uint16_t op) {
+        cpu.a = ((cpu.a & op) >> 1) | (cpu.flagC ? 0x80 : 0);
+        cpu.setZN(cpu.a);
+        cpu.flagC = (cpu.a & 0x40) != 0;
+        cpu.flagV = (((cpu.a >> 6) ^ (cpu.a >> 5)) & 0x01) != 0;
+    }
+    
+    static void opAXS(CPU& cpu, uint16_t op) {
+        uint8_t masked = cpu.a & cpu.x;
+        cpu.flagC = masked >= (op & 0xFF);
+        cpu.x = masked - op;
+        cpu.setZN(cpu.x);
+    }
+    
+    static void opXAA(CPU& cpu, uint16_t op) {
+        cpu.a = (cpu.a | 0xEE) & cpu.x & op;
+        cpu.setZN(cpu.a);
+    }
+    
+    // Desvios: o operando é o deslocamento com sinal estendido (a mesma
+    // entrada do cache serve para bancos espelhados em outro endereço);
+    // +1 ciclo se tomado, +1 se muda de página
+    template <bool CPU::*Flag, bool Value>
+    static void branch(CPU& cpu, uint16_t offset) {
+        if (cpu.*Flag == Value) {
+            uint16_t target = cpu.pc + offset;
+            cpu.cycles += ((cpu.pc ^ target) & 0xFF00) ? 2 : 1;
+            cpu.pc = target;
+        }
+    }
+    
+    // Saltos e pilha
+    static void opJMP(CPU& cpu, uint16_t op) { cpu.pc = op; }
+    
+    static void opJMPIndirect(CPU& cpu, uint16_t op) {
+        // Bug do 6502: o byte alto do ponteiro não cruza a página
+        uint8_t lo = cpu.memory->read(op);
+        uint8_t hi = cpu.memory->read((op & 0xFF00) | ((op + 1) & 0x00FF));
+        cpu.pc = (hi << 8) | lo;
+    }
+    
+    static void opJSR(CPU& cpu, uint16_t op) {
+        cpu.pushWord(cpu.pc - 1);
+        cpu.pc = op;
+    }
+    
+    static void opRTS(CPU& cpu, uint16_t) { cpu.pc = cpu.popWord() + 1; }
+    
+    static void opRTI(CPU& cpu, uint16_t) {
+        cpu.setStatus(cpu.pop());
+        cpu.flagB = false;
+        cpu.pc = cpu.popWord();
+    }
+    
+    static void opBRK(CPU& cpu, uint16_t) {
+        cpu.pushWord(cpu.pc + 1);  // Pula o byte de assinatura
+        cpu.push(cpu.getStatus() | 0x30);
+        cpu.flagI = true;
+        cpu.pc = cpu.memory->readWord(0xFFFE);
+    }
+    
+    static void opPHP(CPU& cpu, uint16_t) { cpu.push(cpu.getStatus() | 0x30); }
+    
+    static void opPLP(CPU& cpu, uint16_t) {
+        cpu.setStatus(cpu.pop());
+        cpu.flagB = false;
+    }
+    
+    static void opPHA(CPU& cpu, uint16_t) { cpu.push(cpu.a); }
+    static void opPLA(CPU& cpu, uint16_t) { cpu.a = cpu.pop(); cpu.setZN(cpu.a); }
+    
+    // Registradores e flags
+    static void opTAX(CPU& cpu, uint16_t) { cpu.x = cpu.a; cpu.setZN(cpu.x); }
+    static void opTAY(CPU& cpu, uint16_t) { cpu.y = cpu.a; cpu.setZN(cpu.y); }
+    static void opTXA(CPU& cpu, uint16_t) { cpu.a = cpu.x; cpu.setZN(cpu.a); }
+    static void opTYA(CPU& cpu, uint16_t) { cpu.a = cpu.y; cpu.setZN(cpu.a); }
+    static void opTSX(CPU& cpu, uint16_t) { cpu.x = cpu.sp; cpu.setZN(cpu.x); }
+    static void opTXS(CPU& cpu, uint16_t) { cpu.sp = cpu.x; }
+    static void opINX(CPU& cpu, uint16_t) { cpu.setZN(++cpu.x); }
+    static void opINY(CPU& cpu, uint16_t) { cpu.setZN(++cpu.y); }
+    static void opDEX(CPU& cpu, uint16_t) { cpu.setZN(--cpu.x); }
+    static void opDEY(CPU& cpu, uint16_t) { cpu.setZN(--cpu.y); }
+    static void opCLC(CPU& cpu, uint16_t) { cpu.flagC = false; }
+    static void opSEC(CPU& cpu, uint16_t) { cpu.flagC = true; }
+    static void opCLI(CPU& cpu, uint16_t) { cpu.flagI = false; }
+    static void opSEI(CPU& cpu, uint16_t) { cpu.flagI = true; }
+    static void opCLV(CPU& cpu, uint16_t) { cpu.flagV = false; }
+    static void opCLD(CPU& cpu, uint16_t) { cpu.flagD = false; }
+    static void opSED(CPU& cpu, uint16_t) { cpu.flagD = true; }
+    
+    // Trava a CPU: o PC volta para o próprio opcode
+    static void opSTP(CPU& cpu, uint16_t) { cpu.pc--; }
+};
+
+static const InstructionHandler HANDLERS[256] = {
+    &CPUOps::opBRK,  // $00
+    &CPUOps::opORA<MODE_INDIRECT_X>,  // $01
+    &CPUOps::opSTP,  // $02
+    &CPUOps::modify<MODE_INDIRECT_X, &CPUOps::slo>,  // $03
+    &CPUOps::opNOP<MODE_ZERO_PAGE>,  // $04
+    &CPUOps::opORA<MODE_ZERO_PAGE>,  // $05
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::asl>,  // $06
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::slo>,  // $07
+    &CPUOps::opPHP,  // $08
+    &CPUOps::opORA<MODE_IMMEDIATE>,  // $09
+    &CPUOps::modify<MODE_ACCUMULATOR, &CPUOps::asl>,  // $0A
+    &CPUOps::opANC,  // $0B
+    &CPUOps::opNOP<MODE_ABSOLUTE>,  // $0C
+    &CPUOps::opORA<MODE_ABSOLUTE>,  // $0D
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::asl>,  // $0E
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::slo>,  // $0F
+    &CPUOps::branch<&CPU::flagN, false>,  // $10
+    &CPUOps::opORA<MODE_INDIRECT_Y>,  // $11
+    &CPUOps::opSTP,  // $12
+    &CPUOps::modify<MODE_INDIRECT_Y, &CPUOps::slo>,  // $13
+    &CPUOps::opNOP<MODE_ZERO_PAGE_X>,  // $14
+    &CPUOps::opORA<MODE_ZERO_PAGE_X>,  // $15
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::asl>,  // $16
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::slo>,  // $17
+    &CPUOps::opCLC,  // $18
+    &CPUOps::opORA<MODE_ABSOLUTE_Y>,  // $19
+    &CPUOps::opNOP<MODE_IMPLIED>,  // $1A
+    &CPUOps::modify<MODE_ABSOLUTE_Y, &CPUOps::slo>,  // $1B
+    &CPUOps::opNOP<MODE_ABSOLUTE_X>,  // $1C
+    &CPUOps::opORA<MODE_ABSOLUTE_X>,  // $1D
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::asl>,  // $1E
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::slo>,  // $1F
+    &CPUOps::opJSR,  // $20
+    &CPUOps::opAND<MODE_INDIRECT_X>,  // $21
+    &CPUOps::opSTP,  // $22
+    &CPUOps::modify<MODE_INDIRECT_X, &CPUOps::rla>,  // $23
+    &CPUOps::opBIT<MODE_ZERO_PAGE>,  // $24
+    &CPUOps::opAND<MODE_ZERO_PAGE>,  // $25
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::rol>,  // $26
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::rla>,  // $27
+    &CPUOps::opPLP,  // $28
+    &CPUOps::opAND<MODE_IMMEDIATE>,  // $29
+    &CPUOps::modify<MODE_ACCUMULATOR, &CPUOps::rol>,  // $2A
+    &CPUOps::opANC,  // $2B
+    &CPUOps::opBIT<MODE_ABSOLUTE>,  // $2C
+    &CPUOps::opAND<MODE_ABSOLUTE>,  // $2D
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::rol>,  // $2E
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::rla>,  // $2F
+    &CPUOps::branch<&CPU::flagN, true>,  // $30
+    &CPUOps::opAND<MODE_INDIRECT_Y>,  // $31
+    &CPUOps::opSTP,  // $32
+    &CPUOps::modify<MODE_INDIRECT_Y, &CPUOps::rla>,  // $33
+    &CPUOps::opNOP<MODE_ZERO_PAGE_X>,  // $34
+    &CPUOps::opAND<MODE_ZERO_PAGE_X>,  // $35
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::rol>,  // $36
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::rla>,  // $37
+    &CPUOps::opSEC,  // $38
+    &CPUOps::opAND<MODE_ABSOLUTE_Y>,  // $39
+    &CPUOps::opNOP<MODE_IMPLIED>,  // $3A
+    &CPUOps::modify<MODE_ABSOLUTE_Y, &CPUOps::rla>,  // $3B
+    &CPUOps::opNOP<MODE_ABSOLUTE_X>,  // $3C
+    &CPUOps::opAND<MODE_ABSOLUTE_X>,  // $3D
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::rol>,  // $3E
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::rla>,  // $3F
+    &CPUOps::opRTI,  // $40
+    &CPUOps::opEOR<MODE_INDIRECT_X>,  // $41
+    &CPUOps::opSTP,  // $42
+    &CPUOps::modify<MODE_INDIRECT_X, &CPUOps::sre>,  // $43
+    &CPUOps::opNOP<MODE_ZERO_PAGE>,  // $44
+    &CPUOps::opEOR<MODE_ZERO_PAGE>,  // $45
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::lsr>,  // $46
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::sre>,  // $47
+    &CPUOps::opPHA,  // $48
+    &CPUOps::opEOR<MODE_IMMEDIATE>,  // $49
+    &CPUOps::modify<MODE_ACCUMULATOR, &CPUOps::lsr>,  // $4A
+    &CPUOps::opALR,  // $4B
+    &CPUOps::opJMP,  // $4C
+    &CPUOps::opEOR<MODE_ABSOLUTE>,  // $4D
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::lsr>,  // $4E
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::sre>,  // $4F
+    &CPUOps::branch<&CPU::flagV, false>,  // $50
+    &CPUOps::opEOR<MODE_INDIRECT_Y>,  // $51
+    &CPUOps::opSTP,  // $52
+    &CPUOps::modify<MODE_INDIRECT_Y, &CPUOps::sre>,  // $53
+    &CPUOps::opNOP<MODE_ZERO_PAGE_X>,  // $54
+    &CPUOps::opEOR<MODE_ZERO_PAGE_X>,  // $55
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::lsr>,  // $56
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::sre>,  // $57
+    &CPUOps::opCLI,  // $58
+    &CPUOps::opEOR<MODE_ABSOLUTE_Y>,  // $59
+    &CPUOps::opNOP<MODE_IMPLIED>,  // $5A
+    &CPUOps::modify<MODE_ABSOLUTE_Y, &CPUOps::sre>,  // $5B
+    &CPUOps::opNOP<MODE_ABSOLUTE_X>,  // $5C
+    &CPUOps::opEOR<MODE_ABSOLUTE_X>,  // $5D
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::lsr>,  // $5E
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::sre>,  // $5F
+    &CPUOps::opRTS,  // $60
+    &CPUOps::opADC<MODE_INDIRECT_X>,  // $61
+    &CPUOps::opSTP,  // $62
+    &CPUOps::modify<MODE_INDIRECT_X, &CPUOps::rra>,  // $63
+    &CPUOps::opNOP<MODE_ZERO_PAGE>,  // $64
+    &CPUOps::opADC<MODE_ZERO_PAGE>,  // $65
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::ror>,  // $66
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::rra>,  // $67
+    &CPUOps::opPLA,  // $68
+    &CPUOps::opADC<MODE_IMMEDIATE>,  // $69
+    &CPUOps::modify<MODE_ACCUMULATOR, &CPUOps::ror>,  // $6A
+    &CPUOps::opARR,  // $6B
+    &CPUOps::opJMPIndirect,  // $6C
+    &CPUOps::opADC<MODE_ABSOLUTE>,  // $6D
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::ror>,  // $6E
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::rra>,  // $6F
+    &CPUOps::branch<&CPU::flagV, true>,  // $70
+    &CPUOps::opADC<MODE_INDIRECT_Y>,  // $71
+    &CPUOps::opSTP,  // $72
+    &CPUOps::modify<MODE_INDIRECT_Y, &CPUOps::rra>,  // $73
+    &CPUOps::opNOP<MODE_ZERO_PAGE_X>,  // $74
+    &CPUOps::opADC<MODE_ZERO_PAGE_X>,  // $75
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::ror>,  // $76
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::rra>,  // $77
+    &CPUOps::opSEI,  // $78
+    &CPUOps::opADC<MODE_ABSOLUTE_Y>,  // $79
+    &CPUOps::opNOP<MODE_IMPLIED>,  // $7A
+    &CPUOps::modify<MODE_ABSOLUTE_Y, &CPUOps::rra>,  // $7B
+    &CPUOps::opNOP<MODE_ABSOLUTE_X>,  // $7C
+    &CPUOps::opADC<MODE_ABSOLUTE_X>,  // $7D
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::ror>,  // $7E
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::rra>,  // $7F
+    &CPUOps::opNOP<MODE_IMMEDIATE>,  // $80
+    &CPUOps::opSTA<MODE_INDIRECT_X>,  // $81
+    &CPUOps::opNOP<MODE_IMMEDIATE>,  // $82
+    &CPUOps::opSAX<MODE_INDIRECT_X>,  // $83
+    &CPUOps::opSTY<MODE_ZERO_PAGE>,  // $84
+    &CPUOps::opSTA<MODE_ZERO_PAGE>,  // $85
+    &CPUOps::opSTX<MODE_ZERO_PAGE>,  // $86
+    &CPUOps::opSAX<MODE_ZERO_PAGE>,  // $87
+    &CPUOps::opDEY,  // $88
+    &CPUOps::opNOP<MODE_IMMEDIATE>,  // $89
+    &CPUOps::opTXA,  // $8A
+    &CPUOps::opXAA,  // $8B
+    &CPUOps::opSTY<MODE_ABSOLUTE>,  // $8C
+    &CPUOps::opSTA<MODE_ABSOLUTE>,  // $8D
+    &CPUOps::opSTX<MODE_ABSOLUTE>,  // $8E
+    &CPUOps::opSAX<MODE_ABSOLUTE>,  // $8F
+    &CPUOps::branch<&CPU::flagC, false>,  // $90
+    &CPUOps::opSTA<MODE_INDIRECT_Y>,  // $91
+    &CPUOps::opSTP,  // $92
+    &CPUOps::opAHX<MODE_INDIRECT_Y>,  // $93
+    &CPUOps::opSTY<MODE_ZERO_PAGE_X>,  // $94
+    &CPUOps::opSTA<MODE_ZERO_PAGE_X>,  // $95
+    &CPUOps::opSTX<MODE_ZERO_PAGE_Y>,  // $96
+    &CPUOps::opSAX<MODE_ZERO_PAGE_Y>,  // $97
+    &CPUOps::opTYA,  // $98
+    &CPUOps::opSTA<MODE_ABSOLUTE_Y>,  // $99
+    &CPUOps::opTXS,  // $9A
+    &CPUOps::opTAS,  // $9B
+    &CPUOps::opSHY,  // $9C
+    &CPUOps::opSTA<MODE_ABSOLUTE_X>,  // $9D
+    &CPUOps::opSHX,  // $9E
+    &CPUOps::opAHX<MODE_ABSOLUTE_Y>,  // $9F
+    &CPUOps::opLDY<MODE_IMMEDIATE>,  // $A0
+    &CPUOps::opLDA<MODE_INDIRECT_X>,  // $A1
+    &CPUOps::opLDX<MODE_IMMEDIATE>,  // $A2
+    &CPUOps::opLAX<MODE_INDIRECT_X>,  // $A3
+    &CPUOps::opLDY<MODE_ZERO_PAGE>,  // $A4
+    &CPUOps::opLDA<MODE_ZERO_PAGE>,  // $A5
+    &CPUOps::opLDX<MODE_ZERO_PAGE>,  // $A6
+    &CPUOps::opLAX<MODE_ZERO_PAGE>,  // $A7
+    &CPUOps::opTAY,  // $A8
+    &CPUOps::opLDA<MODE_IMMEDIATE>,  // $A9
+    &CPUOps::opTAX,  // $AA
+    &CPUOps::opLAX<MODE_IMMEDIATE>,  // $AB
+    &CPUOps::opLDY<MODE_ABSOLUTE>,  // $AC
+    &CPUOps::opLDA<MODE_ABSOLUTE>,  // $AD
+    &CPUOps::opLDX<MODE_ABSOLUTE>,  // $AE
+    &CPUOps::opLAX<MODE_ABSOLUTE>,  // $AF
+    &CPUOps::branch<&CPU::flagC, true>,  // $B0
+    &CPUOps::opLDA<MODE_INDIRECT_Y>,  // $B1
+    &CPUOps::opSTP,  // $B2
+    &CPUOps::opLAX<MODE_INDIRECT_Y>,  // $B3
+    &CPUOps::opLDY<MODE_ZERO_PAGE_X>,  // $B4
+    &CPUOps::opLDA<MODE_ZERO_PAGE_X>,  // $B5
+    &CPUOps::opLDX<MODE_ZERO_PAGE_Y>,  // $B6
+    &CPUOps::opLAX<MODE_ZERO_PAGE_Y>,  // $B7
+    &CPUOps::opCLV,  // $B8
+    &CPUOps::opLDA<MODE_ABSOLUTE_Y>,  // $B9
+    &CPUOps::opTSX,  // $BA
+    &CPUOps::opLAS<MODE_ABSOLUTE_Y>,  // $BB
+    &CPUOps::opLDY<MODE_ABSOLUTE_X>,  // $BC
+    &CPUOps::opLDA<MODE_ABSOLUTE_X>,  // $BD
+    &CPUOps::opLDX<MODE_ABSOLUTE_Y>,  // $BE
+    &CPUOps::opLAX<MODE_ABSOLUTE_Y>,  // $BF
+    &CPUOps::opCPY<MODE_IMMEDIATE>,  // $C0
+    &CPUOps::opCMP<MODE_INDIRECT_X>,  // $C1
+    &CPUOps::opNOP<MODE_IMMEDIATE>,  // $C2
+    &CPUOps::modify<MODE_INDIRECT_X, &CPUOps::dcp>,  // $C3
+    &CPUOps::opCPY<MODE_ZERO_PAGE>,  // $C4
+    &CPUOps::opCMP<MODE_ZERO_PAGE>,  // $C5
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::dec>,  // $C6
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::dcp>,  // $C7
+    &CPUOps::opINY,  // $C8
+    &CPUOps::opCMP<MODE_IMMEDIATE>,  // $C9
+    &CPUOps::opDEX,  // $CA
+    &CPUOps::opAXS,  // $CB
+    &CPUOps::opCPY<MODE_ABSOLUTE>,  // $CC
+    &CPUOps::opCMP<MODE_ABSOLUTE>,  // $CD
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::dec>,  // $CE
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::dcp>,  // $CF
+    &CPUOps::branch<&CPU::flagZ, false>,  // $D0
+    &CPUOps::opCMP<MODE_INDIRECT_Y>,  // $D1
+    &CPUOps::opSTP,  // $D2
+    &CPUOps::modify<MODE_INDIRECT_Y, &CPUOps::dcp>,  // $D3
+    &CPUOps::opNOP<MODE_ZERO_PAGE_X>,  // $D4
+    &CPUOps::opCMP<MODE_ZERO_PAGE_X>,  // $D5
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::dec>,  // $D6
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::dcp>,  // $D7
+    &CPUOps::opCLD,  // $D8
+    &CPUOps::opCMP<MODE_ABSOLUTE_Y>,  // $D9
+    &CPUOps::opNOP<MODE_IMPLIED>,  // $DA
+    &CPUOps::modify<MODE_ABSOLUTE_Y, &CPUOps::dcp>,  // $DB
+    &CPUOps::opNOP<MODE_ABSOLUTE_X>,  // $DC
+    &CPUOps::opCMP<MODE_ABSOLUTE_X>,  // $DD
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::dec>,  // $DE
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::dcp>,  // $DF
+    &CPUOps::opCPX<MODE_IMMEDIATE>,  // $E0
+    &CPUOps::opSBC<MODE_INDIRECT_X>,  // $E1
+    &CPUOps::opNOP<MODE_IMMEDIATE>,  // $E2
+    &CPUOps::modify<MODE_INDIRECT_X, &CPUOps::isb>,  // $E3
+    &CPUOps::opCPX<MODE_ZERO_PAGE>,  // $E4
+    &CPUOps::opSBC<MODE_ZERO_PAGE>,  // $E5
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::inc>,  // $E6
+    &CPUOps::modify<MODE_ZERO_PAGE, &CPUOps::isb>,  // $E7
+    &CPUOps::opINX,  // $E8
+    &CPUOps::opSBC<MODE_IMMEDIATE>,  // $E9
+    &CPUOps::opNOP<MODE_IMPLIED>,  // $EA
+    &CPUOps::opSBC<MODE_IMMEDIATE>,  // $EB
+    &CPUOps::opCPX<MODE_ABSOLUTE>,  // $EC
+    &CPUOps::opSBC<MODE_ABSOLUTE>,  // $ED
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::inc>,  // $EE
+    &CPUOps::modify<MODE_ABSOLUTE, &CPUOps::isb>,  // $EF
+    &CPUOps::branch<&CPU::flagZ, true>,  // $F0
+    &CPUOps::opSBC<MODE_INDIRECT_Y>,  // $F1
+    &CPUOps::opSTP,  // $F2
+    &CPUOps::modify<MODE_INDIRECT_Y, &CPUOps::isb>,  // $F3
+    &CPUOps::opNOP<MODE_ZERO_PAGE_X>,  // $F4
+    &CPUOps::opSBC<MODE_ZERO_PAGE_X>,  // $F5
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::inc>,  // $F6
+    &CPUOps::modify<MODE_ZERO_PAGE_X, &CPUOps::isb>,  // $F7
+    &CPUOps::opSED,  // $F8
+    &CPUOps::opSBC<MODE_ABSOLUTE_Y>,  // $F9
+    &CPUOps::opNOP<MODE_IMPLIED>,  // $FA
+    &CPUOps::modify<MODE_ABSOLUTE_Y, &CPUOps::isb>,  // $FB
+    &CPUOps::opNOP<MODE_ABSOLUTE_X>,  // $FC
+    &CPUOps::opSBC<MODE_ABSOLUTE_X>,  // $FD
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::inc>,  // $FE
+    &CPUOps::modify<MODE_ABSOLUTE_X, &CPUOps::isb>,  // $FF
+};
+
+CPU::CPU(Memory* memory)
+    : pc(0), sp(0xFD), a(0), x(0), y(0),
+      flagC(false), flagZ(false), flagI(true), flagD(false),
       flagB(false), flagV(false), flagN(false),
       cycles(0), nmiRequested(false), irqRequested(false),
-      memory(memory) {}
+      memory(memory), profiler(nullptr), tracer(nullptr), decodeCache(nullptr) {}
 
 void CPU::step() {
+    uint8_t event = TRACE_NONE;
     if (nmiRequested) {
         nmi();
         nmiRequested = false;
+        event = TRACE_NMI;
     } else if (irqRequested && !flagI) {
         irq();
         irqRequested = false;
+        event = TRACE_IRQ;
+    }
+    
+    // PRG ROM: instrução já decodificada; resto: busca pelo barramento
+    DecodedInstruction fetched;
+    const DecodedInstruction* instruction = decodeCache ? decodeCache->lookup(pc) : nullptr;
+    if (!instruction) {
+        fetch(fetched);
+        instruction = &fetched;
+    } else if (Profiler::ENABLED && profiler) {
+        for (int i = 0; i < instruction->length; i++) {
+            profiler->countAccess(pc + i, false);
+        }
+    }
+    if (tracer) {
+        tracer->record(*this, instruction->opcode, event);
     }
     
-    uint8_t opcode = memory->read(pc);
-    pc++;
-    execute(opcode);
+    size_t profileIndex = Profiler::ENABLED && profiler ? profiler->pcIndex(pc) : 0;
+    uint64_t startCycles = cycles;
+    pc += instruction->length;
+    cycles += instruction->cycles;
+    instruction->handler(*this, instruction->operand);
+    
+    if (Profiler::ENABLED && profiler) {
+        profiler->countInstruction(profileIndex, instruction->opcode, static_cast<uint32_t>(cycles - startCycles));
+    }
+}
+
+void CPU::decode(const uint8_t* bytes, DecodedInstruction& out) {
+    const OpcodeInfo& info = OPCODE_TABLE[bytes[0]];
+    out.handler = HANDLERS[bytes[0]];
+    out.opcode = bytes[0];
+    out.length = instructionLength(info.mode);
+    out.cycles = info.cycles;
+    if (out.length == 3) {
+        out.operand = bytes[1] | (bytes[2] << 8);
+    } else if (info.mode == MODE_RELATIVE) {
+        out.operand = static_cast<uint16_t>(static_cast<int8_t>(bytes[1]));
+    } else {
+        out.operand = out.length == 2 ? bytes[1] : 0;
+    }
+}
+
+void CPU::fetch(DecodedInstruction& out) {
+    // Só os bytes da instrução passam pelo barramento (I/O tem efeitos)
+    uint8_t bytes[3] = {memory->read(pc), 0, 0};
+    uint8_t length = instructionLength(OPCODE_TABLE[bytes[0]].mode);
+    for (uint8_t i = 1; i < length; i++) {
+        bytes[i] = memory->read(pc + i);
+    }
+    decode(bytes, out);
 }
 
 void CPU::reset() {
-    pc = 0x8000;
-    sp = 0xFF;
+    sp = 0xFD;
     a = 0;
     x = 0;
     y = 0;
@@ -35,7 +605,10 @@ void CPU::reset() {
     flagB = false;
     flagV = false;
     flagN = false;
-    cycles = 0;
+    nmiRequested = false;
+    irqRequested = false;
+    pc = memory->readWord(0xFFFC);
+    cycles = 7;  // Sequência de reset
 }
 
 uint8_t CPU::getStatus() const {
@@ -60,6 +633,32 @@ void CPU::setStatus(uint8_t status) {
     flagN = (status & 0x80) != 0;
 }
 
+void CPU::saveState(StateWriter& out) const {
+    out.write(pc);
+    out.write(sp);
+    out.write(a);
+    out.write(x);
+    out.write(y);
+    out.write(getStatus());
+    out.write(cycles);
+    out.write(nmiRequested);
+    out.write(irqRequested);
+}
+
+void CPU::loadState(StateReader& in) {
+    uint8_t status;
+    in.read(pc);
+    in.read(sp);
+    in.read(a);
+    in.read(x);
+    in.read(y);
+    in.read(status);
+    in.read(cycles);
+    in.read(nmiRequested);
+    in.read(irqRequested);
+    setStatus(status);
+}
+
 void CPU::push(uint8_t value) {
     memory->write(0x100 + sp, value);
     sp--;
@@ -81,19 +680,21 @@ uint16_t CPU::popWord() {
     return (hi << 8) | lo;
 }
 
+uint16_t CPU::readZeroPageWord(uint8_t addr) {
+    // O ponteiro dá a volta dentro da página zero
+    uint8_t lo = memory->read(addr);
+    uint8_t hi = memory->read(static_cast<uint8_t>(addr + 1));
+    return (hi << 8) | lo;
+}
+
 void CPU::setZN(uint8_t value) {
     flagZ = (value == 0);
     flagN = (value & 0x80) != 0;
 }
 
-void CPU::execute(uint8_t opcode) {
-    // Implementação básica - será expandida
-    cycles += 2;
-}
-
 void CPU::nmi() {
     pushWord(pc);
-    push(getStatus());
+    push((getStatus() & ~0x10) | 0x20);
     flagI = true;
     pc = memory->readWord(0xFFFA);
     cycles += 7;
@@ -101,93 +702,12 @@ void CPU::nmi() {
 
 void CPU::irq() {
     pushWord(pc);
-    push(getStatus());
+    push((getStatus() & ~0x10) | 0x20);
     flagI = true;
     pc = memory->readWord(0xFFFE);
     cycles += 7;
 }
 
-uint8_t CPU::immediate() {
-    return memory->read(pc++);
-}
-
-uint8_t CPU::zeroPage() {
-    return memory->read(memory->read(pc++));
-}
-
-uint8_t CPU::zeroPageX() {
-    return memory->read((memory->read(pc++) + x) & 0xFF);
-}
-
-uint8_t CPU::zeroPageY() {
-    return memory->read((memory->read(pc++) + y) & 0xFF);
-}
-
-uint8_t CPU::absolute() {
-    return memory->read(memory->readWord(pc));
-}
-
-uint8_t CPU::absoluteX() {
-    return memory->read(memory->readWord(pc) + x);
-}
-
-uint8_t CPU::absoluteY() {
-    return memory->read(memory->readWord(pc) + y);
-}
-
-uint8_t CPU::indirectX() {
-    uint8_t addr = memory->read(pc++) + x;
-    return memory->read(memory->readWord(addr));
-}
-
-uint8_t CPU::indirectY() {
-    uint8_t addr = memory->read(pc++);
-    return memory->read(memory->readWord(addr) + y);
-}
-
-uint16_t CPU::zeroPageAddr() {
-    return memory->read(pc++);
-}
-
-uint16_t CPU::zeroPageXAddr() {
-    return (memory->read(pc++) + x) & 0xFF;
-}
-
-uint16_t CPU::zeroPageYAddr() {
-    return (memory->read(pc++) + y) & 0xFF;
-}
-
-uint16_t CPU::absoluteAddr() {
-    return memory->readWord(pc);
-}
-
-uint16_t CPU::absoluteXAddr() {
-    return memory->readWord(pc) + x;
-}
-
-uint16_t CPU::absoluteYAddr() {
-    return memory->readWord(pc) + y;
-}
-
-uint16_t CPU::indirectXAddr() {
-    uint8_t addr = memory->read(pc++) + x;
-    return memory->readWord(addr);
-}
-
-uint16_t CPU::indirectYAddr() {
-    uint8_t addr = memory->read(pc++);
-    return memory->readWord(addr) + y;
-}
-
-uint16_t CPU::indirectAddr() {
-    return memory->readWord(memory->readWord(pc));
-}
-
-void CPU::branch() {
-    int8_t offset = memory->read(pc++);
-    pc += offset;
-}
-
 void CPU::adc(uint8_t value) {
     uint16_t result = a + value + (flagC ? 1 : 0);
     flagC = (result > 0xFF);
@@ -0,0 +1,91 @@
+#include "decode_cache.h"
+#include "cartridge.h"
+#include "opcodes.h"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+/**
+ * Páginas de uma ROM. Publicadas com compare-exchange: duas threads que
+ * decodificam a mesma página ao mesmo tempo chegam ao mesmo conteúdo e a
+ * perdedora descarta a sua.
+ */
+struct DecodeCache::Pages {
+    std::unique_ptr<std::atomic<const Page*>[]> slots;  // Uma por 256 bytes da PRG ROM
+    size_t count;
+    std::atomic<size_t> allocated;
+    
+    explicit Pages(size_t count) : slots(new std::atomic<const Page*>[count]), count(count), allocated(0) {
+        for (size_t i = 0; i < count; i++) {
+            slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    ~Pages() {
+        for (size_t i = 0; i < count; i++) {
+            delete slots[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// Páginas vivas por ROM (hash + tamanho da PRG); somem com a última instância
+static std::mutex registryMutex;
+static std::map<std::pair<uint64_t, size_t>, std::weak_ptr<void>> registry;
+
+DecodeCache::DecodeCache() : cartridge(nullptr), slots(nullptr) {}
+
+void DecodeCache::attach(const Cartridge* cartridge) {
+    this->cartridge = cartridge;
+    pages.reset();
+    slots = nullptr;
+    if (!cartridge || !cartridge->getPRGSize()) {
+        return;
+    }
+    
+    std::pair<uint64_t, size_t> key(cartridge->getROMHash(), cartridge->getPRGSize());
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::weak_ptr<void>& entry = registry[key];
+    pages = std::static_pointer_cast<Pages>(entry.lock());
+    if (!pages) {
+        pages = std::make_shared<Pages>((cartridge->getPRGSize() + 0xFF) >> 8);
+        entry = pages;
+    }
+    slots = pages->slots.get();
+    // Entradas de ROMs que não estão mais carregadas
+    for (auto it = registry.begin(); it != registry.end();) {
+        it = it->second.expired() ? registry.erase(it) : std::next(it);
+    }
+}
+
+size_t DecodeCache::getMemoryUsage() const {
+    if (!pages) {
+        return 0;
+    }
+    size_t bytes = pages->allocated.load(std::memory_order_relaxed) * sizeof(Page) +
+                   pages->count * sizeof(pages->slots[0]);
+    return bytes / static_cast<size_t>(pages.use_count());
+}
+
+const DecodeCache::Page* DecodeCache::fill(size_t index) {
+    // A página inteira de uma vez: o conteúdo depende só da ROM
+    std::unique_ptr<Page> page = std::make_unique<Page>();
+    const uint8_t* rom = cartridge->getPRGData();
+    size_t size = cartridge->getPRGSize();
+    for (size_t i = 0; i < 256; i++) {
+        size_t offset = (index << 8) + i;
+        DecodedInstruction& entry = page->entries[i];
+        uint8_t length = offset < size ? instructionLength(OPCODE_TABLE[rom[offset]].mode) : 0;
+        if (offset + length > size || length == 0 || (offset & 0x1FFF) + length > 0x2000) {
+            entry.handler = nullptr;
+        } else {
+            CPU::decode(rom + offset, entry);
+        }
+    }
+    
+    const Page* expected = nullptr;
+    if (slots[index].compare_exchange_strong(expected, page.get(), std::memory_order_acq_rel)) {
+        pages->allocated.fetch_add(1, std::memory_order_relaxed);
+        return page.release();
+    }
+    return expected;
+}
@@ -0,0 +1,179 @@
+#include "frame_pacer.h"
+#include "console.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(_WIN32) || defined(__APPLE__)
+#include <thread>
+#else
+#include <cerrno>
+#include <time.h>
+#endif
+
+uint64_t FramePacer::nowNs() {
+#if defined(_WIN32) || defined(__APPLE__)
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+    // Mesmo relógio de System.nanoTime e do Choreographer no Android
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+static void sleepUntil(uint64_t targetNs) {
+#if defined(_WIN32) || defined(__APPLE__)
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(targetNs))));
+#else
+    // Prazo absoluto: sinais e preempção não acumulam erro
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(targetNs / 1000000000ull);
+    ts.tv_nsec = static_cast<long>(targetNs % 1000000000ull);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#endif
+}
+
+FramePacer::FramePacer(Console& console, double refreshHz)
+    : console(console), periodNs(1e9 / NTSC_REFRESH_HZ), anchorNs(nowNs()), nextIndex(1),
+      marginNs(DEFAULT_MARGIN_NS), emulateAvgNs(0), emulateDevNs(0), wakeLateNs(0),
+      hasEstimate(false), waitDeadlineNs(0), waitWakeNs(0), current(), previous(),
+      seenInputTimestamp(console.getLastInputTimestamp()), currentEventNs(0), previousEventNs(0) {
+    setRefreshRate(refreshHz);
+    // Sem medida ainda: meio frame é conservador sem atrasar o primeiro
+    emulateAvgNs = static_cast<int64_t>(periodNs / 2);
+    resetStats();
+}
+
+uint64_t FramePacer::deadline(uint64_t index) const {
+    return anchorNs + static_cast<uint64_t>(std::llround(static_cast<double>(index) * periodNs));
+}
+
+void FramePacer::setRefreshRate(double hz) {
+    if (!(hz > 0.0 && hz <= 1000.0)) {
+        return;
+    }
+    // O deadline pendente fica onde está; a nova taxa vale a partir dele
+    anchorNs = deadline(nextIndex);
+    nextIndex = 0;
+    periodNs = 1e9 / hz;
+}
+
+void FramePacer::onVsync(uint64_t vsyncNs, uint64_t vsyncPeriodNs) {
+    if (vsyncPeriodNs >= 1000000) {
+        periodNs = static_cast<double>(vsyncPeriodNs);
+    }
+    // Próximo vsync da grade depois de agora
+    uint64_t now = nowNs();
+    anchorNs = vsyncNs;
+    nextIndex = now < vsyncNs ? 0 : static_cast<uint64_t>((now - vsyncNs) / periodNs) + 1;
+}
+
+uint64_t FramePacer::waitForFrame() {
+    uint64_t now = nowNs();
+    uint64_t target = deadline(nextIndex);
+    if (now >= target) {
+        // Atrasado (pausa, troca de app, frame longo): segue a grade
+        nextIndex += static_cast<uint64_t>((now - target) / periodNs) + 1;
+        target = deadline(nextIndex);
+    }
+    
+    uint64_t budget = static_cast<uint64_t>(emulateAvgNs + 4 * emulateDevNs + wakeLateNs) + marginNs;
+    uint64_t wake = now;
+    if (target > now + budget) {
+        uint64_t start = target - budget;
+        sleepUntil(start);
+        wake = nowNs();
+        int64_t late = static_cast<int64_t>(wake - start);
+        wakeLateNs += (late - wakeLateNs) / 8;
+    }
+    waitDeadlineNs = target;
+    waitWakeNs = wake;
+    return wake;
+}
+
+void FramePacer::runFrame() {
+    uint64_t start = nowNs();
+    console.runFrame();
+    uint64_t end = nowNs();
+    
+    // Média e desvio médio com os pesos do RTO do TCP (1/8 e 1/4)
+    int64_t sample = static_cast<int64_t>(end - start);
+    if (!hasEstimate) {
+        emulateAvgNs = sample;
+        emulateDevNs = sample / 2;
+        hasEstimate = true;
+    } else {
+        int64_t error = sample - emulateAvgNs;
+        emulateAvgNs += error / 8;
+        emulateDevNs += (std::llabs(error) - emulateDevNs) / 4;
+    }
+    
+    previous = current;
+    previousEventNs = currentEventNs;
+    current = FramePacing();
+    current.frame = console.getFrameCount();
+    current.deadlineNs = waitWakeNs ? waitDeadlineNs : deadline(nextIndex);
+    current.wakeNs = waitWakeNs ? waitWakeNs : start;
+    current.emulateNs = end - start;
+    
+    // Só conta o evento no frame em que foi aplicado
+    uint64_t inputTimestamp = console.getLastInputTimestamp();
+    currentEventNs = inputTimestamp != seenInputTimestamp ? inputTimestamp : 0;
+    seenInputTimestamp = inputTimestamp;
+    
+    waitWakeNs = 0;
+    nextIndex++;
+}
+
+FramePacing FramePacer::framePresented(uint64_t presentNs) {
+    if (presentNs == 0) {
+        presentNs = nowNs();
+    }
+    // No pipeline a tela mostra o frame anterior, entregue no deadline atual
+    bool pipelined = console.isPipelined();
+    FramePacing shown = pipelined ? previous : current;
+    uint64_t eventNs = pipelined ? previousEventNs : currentEventNs;
+    if (shown.wakeNs == 0) {
+        return shown;
+    }
+    shown.deadlineNs = current.deadlineNs;
+    shown.presentNs = presentNs;
+    shown.inputLatencyNs = presentNs > shown.wakeNs ? presentNs - shown.wakeNs : 0;
+    shown.eventLatencyNs = eventNs != 0 && presentNs > eventNs ? presentNs - eventNs : 0;
+    shown.missed = presentNs > shown.deadlineNs;
+    
+    stats.frames++;
+    stats.missed += shown.missed ? 1 : 0;
+    inputLatencySumNs += shown.inputLatencyNs;
+    if (shown.inputLatencyNs > stats.inputLatencyMaxNs) {
+        stats.inputLatencyMaxNs = shown.inputLatencyNs;
+    }
+    if (shown.eventLatencyNs != 0) {
+        stats.events++;
+        eventLatencySumNs += shown.eventLatencyNs;
+        if (shown.eventLatencyNs > stats.eventLatencyMaxNs) {
+            stats.eventLatencyMaxNs = shown.eventLatencyNs;
+        }
+    }
+    return shown;
+}
+
+PacerStats FramePacer::getStats() const {
+    PacerStats result = stats;
+    result.emulateAvgNs = static_cast<uint64_t>(emulateAvgNs);
+    result.emulateJitterNs = static_cast<uint64_t>(emulateDevNs);
+    result.inputLatencyAvgNs = stats.frames ? inputLatencySumNs / stats.frames : 0;
+    result.eventLatencyAvgNs = stats.events ? eventLatencySumNs / stats.events : 0;
+    return result;
+}
+
+void FramePacer::resetStats() {
+    stats = PacerStats();
+    inputLatencySumNs = 0;
+    eventLatencySumNs = 0;
+}
@@ -0,0 +1,864 @@
+#include "lockstep.h"
+#include "apu.h"
+#include "cartridge.h"
+#include "console.h"
+#include "cpu.h"
+#include "decode_cache.h"
+#include "memory.h"
+#include "opcodes.h"
+#include "ppu.h"
+
+#include <algorithm>
+#include <cstring>
+
+template <typename F>
+static void forEachLane(uint32_t mask, F f) {
+    for (int lane = 0; mask; lane++, mask >>= 1) {
+        if (mask & 1) {
+            f(lane);
+        }
+    }
+}
+
+static int lowestLane(uint32_t mask) {
+    int lane = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        lane++;
+    }
+    return lane;
+}
+
+// Endereço efetivo de cada lane; 'uniform' quando é o mesmo no grupo todo
+struct LaneAddress {
+    uint16_t lane[lanes::WIDTH];
+    uint16_t value;
+    bool uniform;
+};
+
+/**
+ * Executor das instruções em estrutura de arrays. Cada operação é escrita
+ * uma vez sobre a política L: Vector (grupo de 2+ lanes, bytes em
+ * lanes::Bytes e escritas mascaradas) ou Scalar (uma lane, uint8_t). Os
+ * registradores de 16/64 bits (PC, ciclos) e os acessos por lane ficam em
+ * laços sobre as lanes do grupo.
+ */
+struct LaneOps {
+    struct Vector {
+        using V = lanes::Bytes;
+        
+        LockstepEngine& e;
+        uint32_t mask;
+        V active;
+        int first;
+        
+        static V constant(uint8_t value) { return lanes::splat(value); }
+        V get(const uint8_t* reg) const { return lanes::load(reg); }
+        void put(uint8_t* reg, V value) const { lanes::store(reg, lanes::select(active, value, lanes::load(reg))); }
+        void spill(V value, uint8_t* out) const { lanes::store(out, value); }
+        
+        template <typename F>
+        void forEach(F f) const { forEachLane(mask, f); }
+        
+        void finish(LaneAddress& address) const {
+            address.value = address.lane[first];
+            address.uniform = true;
+            forEach([&](int lane) { address.uniform = address.uniform && address.lane[lane] == address.value; });
+        }
+        
+        // Endereço comum na RAM vira uma linha inteira de ram[][]; o resto
+        // passa lane a lane pelo barramento de cada Console
+        V read(const LaneAddress& address) const {
+            if (address.uniform && address.value < 0x2000) {
+                return lanes::load(e.ram[address.value & 0x7FF]);
+            }
+            alignas(16) uint8_t values[lanes::WIDTH] = {};
+            forEach([&](int lane) { values[lane] = e.readLane(lane, address.lane[lane]); });
+            return lanes::load(values);
+        }
+        
+        void write(const LaneAddress& address, V value) const {
+            if (address.uniform && address.value < 0x2000) {
+                put(e.ram[address.value & 0x7FF], value);
+                return;
+            }
+            alignas(16) uint8_t values[lanes::WIDTH];
+            lanes::store(values, value);
+            forEach([&](int lane) { e.writeLane(lane, address.lane[lane], values[lane]); });
+        }
+    };
+    
+    struct Scalar {
+        using V = uint8_t;
+        
+        LockstepEngine& e;
+        int first;  // A única lane
+        
+        static V constant(uint8_t value) { return value; }
+        V get(const uint8_t* reg) const { return reg[first]; }
+        void put(uint8_t* reg, V value) const { reg[first] = value; }
+        void spill(V value, uint8_t* out) const { out[first] = value; }
+        
+        template <typename F>
+        void forEach(F f) const { f(first); }
+        
+        void finish(LaneAddress& address) const {
+            address.value = address.lane[first];
+            address.uniform = true;
+        }
+        
+        V read(const LaneAddress& address) const { return e.readLane(first, address.value); }
+        void write(const LaneAddress& address, V value) const { e.writeLane(first, address.value, value); }
+    };
+    
+    // Mesma sequência de CPU::step depois da busca: PC e ciclos base já
+    // somados, operação pelo modo de endereçamento
+    static void execute(LockstepEngine& e, uint32_t group, const DecodedInstruction& instruction) {
+        forEachLane(group, [&](int lane) {
+            e.pc[lane] += instruction.length;
+            e.cycles[lane] += instruction.cycles;
+        });
+        
+        int first = lowestLane(group);
+        if (group & (group - 1)) {
+            alignas(16) uint8_t active[lanes::WIDTH] = {};
+            forEachLane(group, [&](int lane) { active[lane] = 0xFF; });
+            Vector l{e, group, lanes::load(active), first};
+            run(l, instruction);
+            e.stats.vectorSteps++;
+        } else {
+            Scalar l{e, first};
+            run(l, instruction);
+            e.stats.scalarSteps++;
+        }
+    }
+    
+    // NMI/IRQ de uma lane, como CPU::nmi/irq
+    static void interrupt(LockstepEngine& e, int lane, uint16_t vector) {
+        Scalar l{e, lane};
+        push(l, e.pc[lane] >> 8);
+        push(l, e.pc[lane] & 0xFF);
+        push(l, static_cast<uint8_t>((status(l) & ~0x10) | 0x20));
+        e.flagI[lane] = 0xFF;
+        e.pc[lane] = e.readLane(lane, vector) | (e.readLane(lane, vector + 1) << 8);
+        e.cycles[lane] += 7;
+    }
+    
+    // Endereçamento
+    static uint16_t indexed(LockstepEngine& e, int lane, uint16_t base, uint8_t index, bool penalty) {
+        uint16_t addr = base + index;
+        if (penalty && ((base ^ addr) & 0xFF00)) {
+            e.cycles[lane]++;
+        }
+        return addr;
+    }
+    
+    // O ponteiro dá a volta dentro da página zero (sempre RAM)
+    static uint16_t zeroPageWord(const LockstepEngine& e, int lane, uint8_t addr) {
+        return e.ram[addr][lane] | (e.ram[static_cast<uint8_t>(addr + 1)][lane] << 8);
+    }
+    
+    template <typename L>
+    static LaneAddress address(const L& l, AddressingMode mode, uint16_t operand, bool penalty) {
+        LockstepEngine& e = l.e;
+        LaneAddress address;
+        switch (mode) {
+            case MODE_ZERO_PAGE_X:
+                l.forEach([&](int lane) { address.lane[lane] = (operand + e.x[lane]) & 0xFF; });
+                break;
+            case MODE_ZERO_PAGE_Y:
+                l.forEach([&](int lane) { address.lane[lane] = (operand + e.y[lane]) & 0xFF; });
+                break;
+            case MODE_ABSOLUTE_X:
+                l.forEach([&](int lane) { address.lane[lane] = indexed(e, lane, operand, e.x[lane], penalty); });
+                break;
+            case MODE_ABSOLUTE_Y:
+                l.forEach([&](int lane) { address.lane[lane] = indexed(e, lane, operand, e.y[lane], penalty); });
+                break;
+            case MODE_INDIRECT_X:
+                l.forEach([&](int lane) { address.lane[lane] = zeroPageWord(e, lane, operand + e.x[lane]); });
+                break;
+            case MODE_INDIRECT_Y:
+                l.forEach([&](int lane) {
+                    address.lane[lane] = indexed(e, lane, zeroPageWord(e, lane, operand), e.y[lane], penalty);
+                });
+                break;
+            default:  // Página zero e absoluto
+                l.forEach([&](int lane) { address.lane[lane] = operand; });
+                break;
+        }
+        l.finish(address);
+        return address;
+    }
+    
+    template <typename L>
+    static typename L::V load(const L& l, AddressingMode mode, uint16_t operand) {
+        if (mode == MODE_IMMEDIATE) {
+            return L::constant(operand & 0xFF);
+        }
+        return l.read(address(l, mode, operand, true));
+    }
+    
+    template <typename L>
+    static void store(const L& l, AddressingMode mode, uint16_t operand, typename L::V value) {
+        l.write(address(l, mode, operand, false), value);
+    }
+    
+    // Pilha
+    template <typename L>
+    static LaneAddress stackAddress(const L& l) {
+        LaneAddress address;
+        l.forEach([&](int lane) { address.lane[lane] = 0x100 + l.e.sp[lane]; });
+        l.finish(address);
+        return address;
+    }
+    
+    template <typename L>
+    static void push(const L& l, typename L::V value) {
+        l.write(stackAddress(l), value);
+        l.put(l.e.sp, l.get(l.e.sp) - L::constant(1));
+    }
+    
+    template <typename L>
+    static typename L::V pop(const L& l) {
+        l.put(l.e.sp, l.get(l.e.sp) + L::constant(1));
+        return l.read(stackAddress(l));
+    }
+    
+    // Carrega o PC de cada lane a partir de dois bytes por lane
+    template <typename L>
+    static void jumpTo(const L& l, typename L::V lo, typename L::V hi, uint16_t delta) {
+        alignas(16) uint8_t low[lanes::WIDTH];
+        alignas(16) uint8_t high[lanes::WIDTH];
+        l.spill(lo, low);
+        l.spill(hi, high);
+        l.forEach([&](int lane) { l.e.pc[lane] = ((high[lane] << 8) | low[lane]) + delta; });
+    }
+    
+    // Flags
+    template <typename L>
+    static void setZN(const L& l, typename L::V value) {
+        l.put(l.e.flagZ, lanes::isZero(value));
+        l.put(l.e.flagN, lanes::testBit(value, 7));
+    }
+    
+    template <typename L>
+    static typename L::V status(const L& l) {
+        LockstepEngine& e = l.e;
+        return (l.get(e.flagC) & L::constant(0x01)) | (l.get(e.flagZ) & L::constant(0x02)) |
+               (l.get(e.flagI) & L::constant(0x04)) | (l.get(e.flagD) & L::constant(0x08)) |
+               (l.get(e.flagB) & L::constant(0x10)) | (l.get(e.flagV) & L::constant(0x40)) |
+               (l.get(e.flagN) & L::constant(0x80));
+    }
+    
+    template <typename L>
+    static void setStatus(const L& l, typename L::V value) {
+        LockstepEngine& e = l.e;
+        l.put(e.flagC, lanes::testBit(value, 0));
+        l.put(e.flagZ, lanes::testBit(value, 1));
+        l.put(e.flagI, lanes::testBit(value, 2));
+        l.put(e.flagD, lanes::testBit(value, 3));
+        l.put(e.flagB, lanes::testBit(value, 4));
+        l.put(e.flagV, lanes::testBit(value, 6));
+        l.put(e.flagN, lanes::testBit(value, 7));
+    }
+    
+    // Aritmética: carry de a + v + c em 8 bits sem alargar (t < a ou soma < t)
+    template <typename L>
+    static void adc(const L& l, typename L::V value) {
+        using V = typename L::V;
+        LockstepEngine& e = l.e;
+        V a = l.get(e.a);
+        V partial = a + value;
+        V sum = partial + (l.get(e.flagC) & L::constant(1));
+        V notCarry = lanes::greaterEqual(partial, a) & lanes::greaterEqual(sum, partial);
+        l.put(e.flagC, notCarry ^ L::constant(0xFF));
+        l.put(e.flagV, lanes::testBit((a ^ sum) & (value ^ sum), 7));
+        l.put(e.a, sum);
+        setZN(l, sum);
+    }
+    
+    template <typename L>
+    static void cmp(const L& l, typename L::V reg, typename L::V value) {
+        typename L::V result = reg - value;
+        l.put(l.e.flagC, lanes::greaterEqual(reg, value));
+        setZN(l, result);
+    }
+    
+    // Leitura-modificação-escrita: novo valor da operação
+    template <typename L>
+    static typename L::V modified(const L& l, Operation operation, typename L::V value) {
+        using V = typename L::V;
+        LockstepEngine& e = l.e;
+        V result;
+        switch (operation) {
+            case OP_ASL:
+            case OP_SLO:
+                result = lanes::shiftLeft1(value);
+                l.put(e.flagC, lanes::testBit(value, 7));
+                break;
+            case OP_LSR:
+            case OP_SRE:
+                result = lanes::shiftRight1(value);
+                l.put(e.flagC, lanes::testBit(value, 0));
+                break;
+            case OP_ROL:
+            case OP_RLA:
+                result = lanes::shiftLeft1(value) | (l.get(e.flagC) & L::constant(0x01));
+                l.put(e.flagC, lanes::testBit(value, 7));
+                break;
+            case OP_ROR:
+            case OP_RRA:
+                result = lanes::shiftRight1(value) | (l.get(e.flagC) & L::constant(0x80));
+                l.put(e.flagC, lanes::testBit(value, 0));
+                break;
+            case OP_INC:
+            case OP_ISB:
+                result = value + L::constant(1);
+                break;
+            default:  // DEC, DCP
+                result = value - L::constant(1);
+                break;
+        }
+        
+        switch (operation) {
+            case OP_SLO: l.put(e.a, l.get(e.a) | result); setZN(l, l.get(e.a)); break;
+            case OP_RLA: l.put(e.a, l.get(e.a) & result); setZN(l, l.get(e.a)); break;
+            case OP_SRE: l.put(e.a, l.get(e.a) ^ result); setZN(l, l.get(e.a)); break;
+            case OP_RRA: adc(l, result); break;
+            case OP_DCP: cmp(l, l.get(e.a), result); break;
+            case OP_ISB: adc(l, result ^ L::constant(0xFF)); break;
+            default: setZN(l, result); break;
+        }
+        return result;
+    }
+    
+    template <typename L>
+    static void modify(const L& l, Operation operation, AddressingMode mode, uint16_t operand) {
+        if (mode == MODE_ACCUMULATOR) {
+            l.put(l.e.a, modified(l, operation, l.get(l.e.a)));
+        } else {
+            LaneAddress target = address(l, mode, operand, false);
+            typename L::V value = l.read(target);
+            l.write(target, modified(l, operation, value));
+        }
+    }
+    
+    // +1 ciclo se tomado, +1 se muda de página
+    template <typename L>
+    static void branch(const L& l, typename L::V taken, uint16_t offset) {
+        LockstepEngine& e = l.e;
+        alignas(16) uint8_t condition[lanes::WIDTH];
+        l.spill(taken, condition);
+        l.forEach([&](int lane) {
+            if (condition[lane]) {
+                uint16_t target = e.pc[lane] + offset;
+                e.cycles[lane] += ((e.pc[lane] ^ target) & 0xFF00) ? 2 : 1;
+                e.pc[lane] = target;
+            }
+        });
+    }
+    
+    template <typename L>
+    static void run(const L& l, const DecodedInstruction& instruction) {
+        using V = typename L::V;
+        LockstepEngine& e = l.e;
+        const OpcodeInfo& info = OPCODE_TABLE[instruction.opcode];
+        AddressingMode mode = info.mode;
+        uint16_t op = instruction.operand;
+        const V ones = L::constant(0xFF);
+        
+        switch (info.operation) {
+            // Leitura
+            case OP_LDA: { V v = load(l, mode, op); l.put(e.a, v); setZN(l, v); break; }
+            case OP_LDX: { V v = load(l, mode, op); l.put(e.x, v); setZN(l, v); break; }
+            case OP_LDY: { V v = load(l, mode, op); l.put(e.y, v); setZN(l, v); break; }
+            case OP_LAX: { V v = load(l, mode, op); l.put(e.a, v); l.put(e.x, v); setZN(l, v); break; }
+            case OP_ORA: { V v = l.get(e.a) | load(l, mode, op); l.put(e.a, v); setZN(l, v); break; }
+            case OP_AND: { V v = l.get(e.a) & load(l, mode, op); l.put(e.a, v); setZN(l, v); break; }
+            case OP_EOR: { V v = l.get(e.a) ^ load(l, mode, op); l.put(e.a, v); setZN(l, v); break; }
+            case OP_ADC: adc(l, load(l, mode, op)); break;
+            case OP_SBC: adc(l, load(l, mode, op) ^ ones); break;
+            case OP_CMP: cmp(l, l.get(e.a), load(l, mode, op)); break;
+            case OP_CPX: cmp(l, l.get(e.x), load(l, mode, op)); break;
+            case OP_CPY: cmp(l, l.get(e.y), load(l, mode, op)); break;
+            case OP_BIT: {
+                V v = load(l, mode, op);
+                l.put(e.flagZ, lanes::isZero(l.get(e.a) & v));
+                l.put(e.flagN, lanes::testBit(v, 7));
+                l.put(e.flagV, lanes::testBit(v, 6));
+                break;
+            }
+            case OP_LAS: {
+                V v = load(l, mode, op) & l.get(e.sp);
+                l.put(e.a, v);
+                l.put(e.x, v);
+                l.put(e.sp, v);
+                setZN(l, v);
+                break;
+            }
+            case OP_NOP:
+                // NOPs com operando ainda fazem a leitura (efeitos colaterais de I/O)
+                if (mode != MODE_IMPLIED && mode != MODE_IMMEDIATE) {
+                    load(l, mode, op);
+                }
+                break;
+            
+            // Escrita
+            case OP_STA: store(l, mode, op, l.get(e.a)); break;
+            case OP_STX: store(l, mode, op, l.get(e.x)); break;
+            case OP_STY: store(l, mode, op, l.get(e.y)); break;
+            case OP_SAX: store(l, mode, op, l.get(e.a) & l.get(e.x)); break;
+            
+            // Escritas instáveis: valor AND (byte alto do endereço base + 1)
+            case OP_SHY:
+                l.forEach([&](int lane) { e.writeLane(lane, op + e.x[lane], e.y[lane] & ((op >> 8) + 1)); });
+                break;
+            case OP_SHX:
+                l.forEach([&](int lane) { e.writeLane(lane, op + e.y[lane], e.x[lane] & ((op >> 8) + 1)); });
+                break;
+            case OP_AHX:
+                l.forEach([&](int lane) {
+                    uint16_t base = mode == MODE_INDIRECT_Y ? zeroPageWord(e, lane, op) : op;
+                    e.writeLane(lane, base + e.y[lane], e.a[lane] & e.x[lane] & ((base >> 8) + 1));
+                });
+                break;
+            case OP_TAS:
+                l.forEach([&](int lane) {
+                    e.sp[lane] = e.a[lane] & e.x[lane];
+                    e.writeLane(lane, op + e.y[lane], e.sp[lane] & ((op >> 8) + 1));
+                });
+                break;
+            
+            // Leitura-modificação-escrita
+            case OP_ASL: case OP_LSR: case OP_ROL: case OP_ROR: case OP_INC: case OP_DEC:
+            case OP_SLO: case OP_RLA: case OP_SRE: case OP_RRA: case OP_DCP: case OP_ISB:
+                modify(l, info.operation, mode, op);
+                break;
+            
+            // Imediatos não documentados
+            case OP_ANC: {
+                V v = l.get(e.a) & L::constant(op & 0xFF);
+                l.put(e.a, v);
+                setZN(l, v);
+                l.put(e.flagC, lanes::testBit(v, 7));
+                break;
+            }
+            case OP_ALR:
+                l.put(e.a, modified(l, OP_LSR, l.get(e.a) & L::constant(op & 0xFF)));
+                break;
+            case OP_ARR: {
+                V v = lanes::shiftRight1(l.get(e.a) & L::constant(op & 0xFF)) | (l.get(e.flagC) & L::constant(0x80));
+                l.put(e.a, v);
+                setZN(l, v);
+                l.put(e.flagC, lanes::testBit(v, 6));
+                l.put(e.flagV, lanes::testBit(v, 6) ^ lanes::testBit(v, 5));
+                break;
+            }
+            case OP_AXS: {
+                V masked = l.get(e.a) & l.get(e.x);
+                V v = masked - L::constant(op & 0xFF);
+                l.put(e.flagC, lanes::greaterEqual(masked, L::constant(op & 0xFF)));
+                l.put(e.x, v);
+                setZN(l, v);
+                break;
+            }
+            case OP_XAA: {
+                V v = (l.get(e.a) | L::constant(0xEE)) & l.get(e.x) & L::constant(op & 0xFF);
+                l.put(e.a, v);
+                setZN(l, v);
+                break;
+            }
+            
+            // Desvios
+            case OP_BPL: branch(l, l.get(e.flagN) ^ ones, op); break;
+            case OP_BMI: branch(l, l.get(e.flagN), op); break;
+            case OP_BVC: branch(l, l.get(e.flagV) ^ ones, op); break;
+            case OP_BVS: branch(l, l.get(e.flagV), op); break;
+            case OP_BCC: branch(l, l.get(e.flagC) ^ ones, op); break;
+            case OP_BCS: branch(l, l.get(e.flagC), op); break;
+            case OP_BNE: branch(l, l.get(e.flagZ) ^ ones, op); break;
+            case OP_BEQ: branch(l, l.get(e.flagZ), op); break;
+            
+            // Saltos e pilha (o PC é o mesmo em todo o grupo)
+            case OP_JMP:
+                if (mode == MODE_INDIRECT) {
+                    // Bug do 6502: o byte alto do ponteiro não cruza a página
+                    l.forEach([&](int lane) {
+                        uint8_t lo = e.readLane(lane, op);
+                        uint8_t hi = e.readLane(lane, (op & 0xFF00) | ((op + 1) & 0x00FF));
+                        e.pc[lane] = (hi << 8) | lo;
+                    });
+                } else {
+                    l.forEach([&](int lane) { e.pc[lane] = op; });
+                }
+                break;
+            case OP_JSR: {
+                uint16_t ret = e.pc[l.first] - 1;
+                push(l, L::constant(ret >> 8));
+                push(l, L::constant(ret & 0xFF));
+                l.forEach([&](int lane) { e.pc[lane] = op; });
+                break;
+            }
+            case OP_RTS: {
+                V lo = pop(l);
+                V hi = pop(l);
+                jumpTo(l, lo, hi, 1);
+                break;
+            }
+            case OP_RTI: {
+                setStatus(l, pop(l));
+                l.put(e.flagB, L::constant(0));
+                V lo = pop(l);
+                V hi = pop(l);
+                jumpTo(l, lo, hi, 0);
+                break;
+            }
+            case OP_BRK: {
+                uint16_t ret = e.pc[l.first] + 1;  // Pula o byte de assinatura
+                push(l, L::constant(ret >> 8));
+                push(l, L::constant(ret & 0xFF));
+                push(l, status(l) | L::constant(0x30));
+                l.put(e.flagI, ones);
+                l.forEach([&](int lane) { e.pc[lane] = e.readLane(lane, 0xFFFE) | (e.readLane(lane, 0xFFFF) << 8); });
+                break;
+            }
+            case OP_PHP: push(l, status(l) | L::constant(0x30)); break;
+            case OP_PLP: setStatus(l, pop(l)); l.put(e.flagB, L::constant(0)); break;
+            case OP_PHA: push(l, l.get(e.a)); break;
+            case OP_PLA: { V v = pop(l); l.put(e.a, v); setZN(l, v); break; }
+            
+            // Registradores e flags
+            case OP_TAX: { V v = l.get(e.a); l.put(e.x, v); setZN(l, v); break; }
+            case OP_TAY: { V v = l.get(e.a); l.put(e.y, v); setZN(l, v); break; }
+            case OP_TXA: { V v = l.get(e.x); l.put(e.a, v); setZN(l, v); break; }
+            case OP_TYA: { V v = l.get(e.y); l.put(e.a, v); setZN(l, v); break; }
+            case OP_TSX: { V v = l.get(e.sp); l.put(e.x, v); setZN(l, v); break; }
+            case OP_TXS: l.put(e.sp, l.get(e.x)); break;
+            case OP_INX: { V v = l.get(e.x) + L::constant(1); l.put(e.x, v); setZN(l, v); break; }
+            case OP_INY: { V v = l.get(e.y) + L::constant(1); l.put(e.y, v); setZN(l, v); break; }
+            case OP_DEX: { V v = l.get(e.x) - L::constant(1); l.put(e.x, v); setZN(l, v); break; }
+            case OP_DEY: { V v = l.get(e.y) - L::constant(1); l.put(e.y, v); setZN(l, v); break; }
+            case OP_CLC: l.put(e.flagC, L::constant(0)); break;
+            case OP_SEC: l.put(e.flagC, ones); break;
+            case OP_CLI: l.put(e.flagI, L::constant(0)); break;
+            case OP_SEI: l.put(e.flagI, ones); break;
+            case OP_CLV: l.put(e.flagV, L::constant(0)); break;
+            case OP_CLD: l.put(e.flagD, L::constant(0)); break;
+            case OP_SED: l.put(e.flagD, ones); break;
+            
+            // Trava a CPU: o PC volta para o próprio opcode
+            case OP_STP:
+                l.forEach([&](int lane) { e.pc[lane]--; });
+                break;
+        }
+    }
+};
+
+LockstepEngine::LockstepEngine()
+    : touchedIO(0), irqLines(0), laneCount(0), stats{} {
+    std::memset(ram, 0, sizeof(ram));
+    std::memset(a, 0, sizeof(a));
+    std::memset(x, 0, sizeof(x));
+    std::memset(y, 0, sizeof(y));
+    std::memset(sp, 0, sizeof(sp));
+    std::memset(flagC, 0, sizeof(flagC));
+    std::memset(flagZ, 0, sizeof(flagZ));
+    std::memset(flagI, 0, sizeof(flagI));
+    std::memset(flagD, 0, sizeof(flagD));
+    std::memset(flagB, 0, sizeof(flagB));
+    std::memset(flagV, 0, sizeof(flagV));
+    std::memset(flagN, 0, sizeof(flagN));
+    std::memset(pc, 0, sizeof(pc));
+    std::memset(cycles, 0, sizeof(cycles));
+    std::memset(stepStart, 0, sizeof(stepStart));
+    std::memset(pending, 0, sizeof(pending));
+    std::memset(budget, 0, sizeof(budget));
+    std::memset(nmiRequested, 0, sizeof(nmiRequested));
+    std::memset(irqRequested, 0, sizeof(irqRequested));
+    detach();
+}
+
+bool LockstepEngine::attach(Console* const* list, int count) {
+    if (count <= 0 || count > MAX_LANES) {
+        return false;
+    }
+    for (int lane = 0; lane < count; lane++) {
+        const Console* console = list[lane];
+        if (!console || console->pipeline || !console->cartridge->getPRGSize() ||
+            console->getROMHash() != list[0]->getROMHash()) {
+            return false;
+        }
+    }
+    
+    detach();
+    for (int lane = 0; lane < count; lane++) {
+        Console* console = list[lane];
+        consoles[lane] = console;
+        cpus[lane] = console->cpu;
+        ppus[lane] = console->ppu;
+        apus[lane] = console->apu;
+        memories[lane] = console->memory;
+        cartridges[lane] = console->cartridge;
+    }
+    laneCount = count;
+    return true;
+}
+
+void LockstepEngine::detach() {
+    for (int lane = 0; lane < MAX_LANES; lane++) {
+        consoles[lane] = nullptr;
+        cpus[lane] = nullptr;
+        ppus[lane] = nullptr;
+        apus[lane] = nullptr;
+        memories[lane] = nullptr;
+        cartridges[lane] = nullptr;
+    }
+    laneCount = 0;
+}
+
+void LockstepEngine::runFrame() {
+    if (laneCount == 0) {
+        return;
+    }
+    
+    // Um frame emulado termina no início do vblank, lane a lane
+    for (int lane = 0; lane < laneCount; lane++) {
+        consoles[lane]->applyInput();
+        ppus[lane]->resetFrameReady();
+    }
+    loadLanes();
+    
+    uint32_t running = (1u << laneCount) - 1;
+    uint32_t open = 0;  // Lanes com instrução em curso (interrupção já tratada)
+    while (running) {
+        forEachLane(running & ~open, [this](int lane) { beginStep(lane); });
+        open = running;
+        
+        DecodedInstruction instruction;
+        touchedIO = 0;
+        uint32_t group = selectGroup(running, instruction);
+        LaneOps::execute(*this, group, instruction);
+        forEachLane(group, [&](int lane) {
+            stats.laneSteps++;
+            finishStep(lane, running);
+        });
+        open &= ~group;
+    }
+    
+    storeLanes();
+    for (int lane = 0; lane < laneCount; lane++) {
+        consoles[lane]->frameCount++;
+    }
+}
+
+void LockstepEngine::beginStep(int lane) {
+    stepStart[lane] = cycles[lane];
+    if (nmiRequested[lane]) {
+        LaneOps::interrupt(*this, lane, 0xFFFA);
+        nmiRequested[lane] = false;
+    } else if (irqRequested[lane] && !flagI[lane]) {
+        LaneOps::interrupt(*this, lane, 0xFFFE);
+        irqRequested[lane] = false;
+    }
+}
+
+void LockstepEngine::finishStep(int lane, uint32_t& running) {
+    // Enquanto nenhum evento pode ter acontecido a checagem de interrupções
+    // de Console::runCycle dá o mesmo resultado da última vez: só acumula.
+    // Uma linha de IRQ ativa só cai por acesso a I/O, então continua ativa.
+    uint32_t bit = 1u << lane;
+    pending[lane] += cycles[lane] - stepStart[lane];
+    if (!(touchedIO & bit) && pending[lane] < budget[lane]) {
+        if (irqLines & bit) {
+            irqRequested[lane] = true;
+        }
+        return;
+    }
+    catchUp(lane);
+    
+    PPU* ppu = ppus[lane];
+    if (ppu->nmiRequested()) {
+        nmiRequested[lane] = true;
+        ppu->resetNMI();
+    }
+    // IRQ é sensível a nível: permanece enquanto alguma fonte estiver ativa
+    irqLines &= ~bit;
+    irqRequested[lane] = apus[lane]->irqRequested() || cartridges[lane]->irqRequested();
+    if (irqRequested[lane]) {
+        irqLines |= bit;
+    }
+    if (ppu->isFrameReady()) {
+        running &= ~bit;
+    }
+    updateBudget(lane);
+}
+
+void LockstepEngine::catchUp(int lane) {
+    // PPU executa 3 ciclos por ciclo de CPU; APU, 1
+    ppus[lane]->run(pending[lane] * 3);
+    apus[lane]->run(pending[lane]);
+    pending[lane] = 0;
+}
+
+void LockstepEngine::updateBudget(int lane) {
+    uint64_t vblank = (ppus[lane]->dotsUntilVBlank() + 2) / 3;
+    uint64_t mapper = (static_cast<uint64_t>(ppus[lane]->dotsUntilMapperEvent()) + 2) / 3;
+    budget[lane] = std::min<uint64_t>(std::min(vblank, mapper), apus[lane]->cyclesUntilIRQ());
+}
+
+uint32_t LockstepEngine::selectGroup(uint32_t running, DecodedInstruction& instruction) {
+    // A lane mais atrasada no tempo emulado vai, com todas as que estão no
+    // mesmo PC: quem divergiu alcança as outras em laços de espera e as
+    // lanes adiantadas não ficam rodando sozinhas
+    int leader = lowestLane(running);
+    forEachLane(running, [&](int lane) {
+        if (cycles[lane] < cycles[leader]) {
+            leader = lane;
+        }
+    });
+    uint32_t samePC = 0;
+    forEachLane(running, [&](int lane) {
+        if (pc[lane] == pc[leader]) {
+            samePC |= 1u << lane;
+        }
+    });
+    
+    // Mesmo PC só basta com os mesmos bytes: na PRG ROM, o mesmo offset
+    // (banco); fora dela, comparação byte a byte
+    uint16_t addr = pc[leader];
+    uint32_t group = 1u << leader;
+    samePC &= ~group;
+    if (addr >= 0x8000 && (addr & 0x1FFF) <= 0x1FFD) {
+        DecodeCache* cache = consoles[leader]->decodeCache.get();
+        const DecodedInstruction* cached = cache ? cache->lookup(addr) : nullptr;
+        if (cached) {
+            instruction = *cached;
+        } else {
+            CPU::decode(cartridges[leader]->getPRGPointer(addr), instruction);
+        }
+        size_t offset = cartridges[leader]->getPRGOffset(addr);
+        forEachLane(samePC, [&](int lane) {
+            if (cartridges[lane]->getPRGOffset(addr) == offset) {
+                group |= 1u << lane;
+            }
+        });
+    } else {
+        uint8_t bytes[3] = {};
+        fetch(leader, addr, bytes);
+        CPU::decode(bytes, instruction);
+        // Buscar em registradores de I/O tem efeitos: lá cada lane vai sozinha
+        if (addr < 0x2000 || addr >= 0x6000) {
+            forEachLane(samePC, [&](int lane) {
+                uint8_t other[3] = {};
+                fetch(lane, addr, other);
+                if (std::memcmp(bytes, other, sizeof(bytes)) == 0) {
+                    group |= 1u << lane;
+                }
+            });
+        }
+    }
+    return group;
+}
+
+void LockstepEngine::fetch(int lane, uint16_t addr, uint8_t* bytes) {
+    bytes[0] = readLane(lane, addr);
+    uint8_t length = instructionLength(OPCODE_TABLE[bytes[0]].mode);
+    for (uint8_t i = 1; i < length; i++) {
+        bytes[i] = readLane(lane, addr + i);
+    }
+}
+
+uint8_t LockstepEngine::readLane(int lane, uint16_t addr) {
+    if (addr < 0x2000) {
+        return ram[addr & 0x7FF][lane];
+    }
+    // Leituras de PRG não dependem da PPU nem da APU
+    if (addr < 0x6000) {
+        catchUp(lane);
+        touchedIO |= 1u << lane;
+    }
+    return memories[lane]->read(addr);
+}
+
+void LockstepEngine::writeLane(int lane, uint16_t addr, uint8_t value) {
+    if (addr < 0x2000) {
+        ram[addr & 0x7FF][lane] = value;
+        return;
+    }
+    // Registradores de mapper mudam bancos de CHR usados pela PPU
+    catchUp(lane);
+    touchedIO |= 1u << lane;
+    if (addr == 0x4014) {
+        // A DMA lê a página pela RAM do Console e soma o stall na CPU dele
+        if (value < 0x20) {
+            uint8_t* page = memories[lane]->getRam() + ((value & 0x07) << 8);
+            for (int i = 0; i < 0x100; i++) {
+                page[i] = ram[((value & 0x07) << 8) | i][lane];
+            }
+        }
+        cpus[lane]->cycles = cycles[lane];
+        memories[lane]->write(addr, value);
+        cycles[lane] = cpus[lane]->cycles;
+        return;
+    }
+    memories[lane]->write(addr, value);
+}
+
+void LockstepEngine::loadLanes() {
+    irqLines = 0;
+    for (int lane = 0; lane < laneCount; lane++) {
+        const CPU* cpu = cpus[lane];
+        pc[lane] = cpu->pc;
+        sp[lane] = cpu->sp;
+        a[lane] = cpu->a;
+        x[lane] = cpu->x;
+        y[lane] = cpu->y;
+        flagC[lane] = cpu->flagC ? 0xFF : 0x00;
+        flagZ[lane] = cpu->flagZ ? 0xFF : 0x00;
+        flagI[lane] = cpu->flagI ? 0xFF : 0x00;
+        flagD[lane] = cpu->flagD ? 0xFF : 0x00;
+        flagB[lane] = cpu->flagB ? 0xFF : 0x00;
+        flagV[lane] = cpu->flagV ? 0xFF : 0x00;
+        flagN[lane] = cpu->flagN ? 0xFF : 0x00;
+        cycles[lane] = cpu->cycles;
+        nmiRequested[lane] = cpu->nmiRequested;
+        irqRequested[lane] = cpu->irqRequested;
+        pending[lane] = 0;
+        updateBudget(lane);
+        if (apus[lane]->irqRequested() || cartridges[lane]->irqRequested()) {
+            irqLines |= 1u << lane;
+        }
+        
+        const uint8_t* source = memories[lane]->getRam();
+        for (int addr = 0; addr < 0x800; addr++) {
+            ram[addr][lane] = source[addr];
+        }
+    }
+}
+
+void LockstepEngine::storeLanes() {
+    for (int lane = 0; lane < laneCount; lane++) {
+        CPU* cpu = cpus[lane];
+        cpu->pc = pc[lane];
+        cpu->sp = sp[lane];
+        cpu->a = a[lane];
+        cpu->x = x[lane];
+        cpu->y = y[lane];
+        cpu->flagC = flagC[lane] != 0;
+        cpu->flagZ = flagZ[lane] != 0;
+        cpu->flagI = flagI[lane] != 0;
+        cpu->flagD = flagD[lane] != 0;
+        cpu->flagB = flagB[lane] != 0;
+        cpu->flagV = flagV[lane] != 0;
+        cpu->flagN = flagN[lane] != 0;
+        cpu->cycles = cycles[lane];
+        cpu->nmiRequested = nmiRequested[lane];
+        cpu->irqRequested = irqRequested[lane];
+        
+        uint8_t* target = memories[lane]->getRam();
+        for (int addr = 0; addr < 0x800; addr++) {
+            target[addr] = ram[addr][lane];
+        }
+    }
+}
@@ -1,16 +1,34 @@
 #include "memory.h"
 #include "cartridge.h"
+#include "cpu.h"
 #include "ppu.h"
 #include "apu.h"
+#include "controller.h"
+#include "pipeline.h"
+#include "profiler.h"
+#include "state.h"
 
-Memory::Memory() {
+#include <chrono>
+
+Memory::Memory() : cartridge(nullptr), cpu(nullptr), ppu(nullptr), apu(nullptr),
+                   controller(nullptr), pipeline(nullptr),
+                   profiler(nullptr), mapperTiming(false), deviceAccess(false), mapperNs(0),
+                   pendingCycles(0) {
     ram.fill(0);
 }
 
 uint8_t Memory::read(uint16_t addr) {
+    if (Profiler::ENABLED && profiler) {
+        profiler->countAccess(addr, false);
+    }
     if (addr < 0x2000) {
         return ram[addr & 0x7FF];
-    } else if (addr < 0x4000) {
+    }
+    // Leituras de PRG não dependem da PPU nem da APU
+    if (addr < 0x6000) {
+        syncDevices();
+    }
+    if (addr < 0x4000) {
         return readPPU(addr);
     } else if (addr < 0x4020) {
         return readAPU(addr);
@@ -30,10 +48,19 @@ uint8_t Memory::read(uint16_t addr) {
 }
 
 void Memory::write(uint16_t addr, uint8_t value) {
+    if (Profiler::ENABLED && profiler) {
+        profiler->countAccess(addr, true);
+    }
     if (addr < 0x2000) {
         ram[addr & 0x7FF] = value;
-    } else if (addr < 0x4000) {
+        return;
+    }
+    // Registradores de mapper mudam bancos de CHR usados pela PPU
+    syncDevices();
+    if (addr < 0x4000) {
         writePPU(addr, value);
+    } else if (addr == 0x4014) {
+        oamDMA(value);
     } else if (addr < 0x4020) {
         writeAPU(addr, value);
     } else if (addr < 0x6000) {
@@ -43,12 +70,51 @@ void Memory::write(uint16_t addr, uint8_t value) {
             cartridge->writePRG(addr, value);
         }
     } else {
+        if (pipeline) {
+            pipeline->logWrite(ppu->getDotCount(), addr, value);
+        }
         if (cartridge) {
-            cartridge->writePRG(addr, value);
+            // Registradores de IRQ do MMC3: contador em dia antes, novo
+            // agendamento depois
+            bool scanlineIRQ = ppu && addr >= 0xC000 && cartridge->hasScanlineIRQ();
+            if (scanlineIRQ) {
+                ppu->syncMapperIRQ();
+            }
+            if (mapperTiming) {
+                writeMapper(addr, value);
+            } else {
+                cartridge->writePRG(addr, value);
+            }
+            if (scanlineIRQ) {
+                ppu->updateMapperIRQ();
+            }
         }
     }
 }
 
+void Memory::syncDevices() {
+    deviceAccess = true;
+    if (pendingCycles == 0) {
+        return;
+    }
+    // PPU executa 3 ciclos por ciclo de CPU; APU, 1
+    if (ppu) {
+        ppu->run(pendingCycles * 3);
+    }
+    if (apu) {
+        apu->run(pendingCycles);
+    }
+    pendingCycles = 0;
+}
+
+void Memory::writeMapper(uint16_t addr, uint8_t value) {
+    // Escritas no mapper são raras; o relógio só é lido em volta delas
+    auto start = std::chrono::steady_clock::now();
+    cartridge->writePRG(addr, value);
+    mapperNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
 uint16_t Memory::readWord(uint16_t addr) {
     uint8_t lo = read(addr);
     uint8_t hi = read(addr + 1);
@@ -60,19 +126,39 @@ void Memory::writeWord(uint16_t addr, uint16_t value) {
     write(addr + 1, (value >> 8) & 0xFF);
 }
 
-void Memory::setCartridge(std::shared_ptr<Cartridge> cartridge) {
+void Memory::saveState(StateWriter& out) const {
+    out.write(ram);
+}
+
+void Memory::loadState(StateReader& in) {
+    in.read(ram);
+}
+
+void Memory::setCartridge(Cartridge* cartridge) {
     this->cartridge = cartridge;
 }
 
-void Memory::setPPU(std::shared_ptr<class PPU> ppu) {
+void Memory::setCPU(CPU* cpu) {
+    this->cpu = cpu;
+}
+
+void Memory::setPPU(PPU* ppu) {
     this->ppu = ppu;
 }
 
-void Memory::setAPU(std::shared_ptr<class APU> apu) {
+void Memory::setAPU(APU* apu) {
     this->apu = apu;
 }
 
+void Memory::setController(Controller* controller) {
+    this->controller = controller;
+}
+
 uint8_t Memory::readPPU(uint16_t addr) {
+    // $2002 e $2007 alteram estado interno da PPU
+    if (pipeline && ((addr & 0x7) == 0x2 || (addr & 0x7) == 0x7)) {
+        pipeline->logRead(ppu->getDotCount(), addr);
+    }
     if (ppu) {
         return ppu->read(addr);
     }
@@ -80,12 +166,19 @@ uint8_t Memory::readPPU(uint16_t addr) {
 }
 
 void Memory::writePPU(uint16_t addr, uint8_t value) {
+    if (pipeline) {
+        pipeline->logWrite(ppu->getDotCount(), addr, value);
+    }
     if (ppu) {
         ppu->write(addr, value);
     }
 }
 
 uint8_t Memory::readAPU(uint16_t addr) {
+    // $4016/$4017 leem as portas de controle, não a APU
+    if (addr == 0x4016 || addr == 0x4017) {
+        return controller ? controller->read(addr & 0x01) : 0x40;
+    }
     if (apu) {
         return apu->read(addr);
     }
@@ -93,7 +186,47 @@ uint8_t Memory::readAPU(uint16_t addr) {
 }
 
 void Memory::writeAPU(uint16_t addr, uint8_t value) {
+    // $4016 é o strobe dos controles; $4017 (escrita) é o frame counter da APU
+    if (addr == 0x4016) {
+        if (controller) {
+            controller->write(value);
+        }
+        return;
+    }
     if (apu) {
         apu->write(addr, value);
     }
 }
+
+const uint8_t* Memory::getPagePointer(uint8_t page) const {
+    if (page < 0x20) {
+        return &ram[(page & 0x07) << 8];
+    } else if (page >= 0x60 && cartridge) {
+        return cartridge->getPRGPointer(page << 8);
+    }
+    return nullptr;
+}
+
+void Memory::oamDMA(uint8_t page) {
+    // Cópia em bloco direto para a OAM; registradores de I/O caem no caminho lento
+    const uint8_t* source = getPagePointer(page);
+    std::array<uint8_t, 0x100> buffer;
+    if (!source) {
+        for (int i = 0; i < 0x100; i++) {
+            buffer[i] = read((page << 8) | i);
+        }
+        source = buffer.data();
+    }
+    
+    if (pipeline) {
+        pipeline->logOAMDMA(ppu->getDotCount(), source);
+    }
+    if (ppu) {
+        ppu->writeOAM(source);
+    }
+    
+    // 513 ciclos de stall, +1 se a DMA começa em ciclo ímpar
+    if (cpu) {
+        cpu->cycles += 513 + (cpu->cycles & 1);
+    }
+}
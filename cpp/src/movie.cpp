@@ -0,0 +1,245 @@
+#include "movie.h"
+#include "console.h"
+#include "ppu.h"
+#include "state.h"
+
+#include <cstring>
+
+static const uint8_t MOVIE_MAGIC[4] = {'N', 'E', 'S', 'M'};
+static const uint8_t MOVIE_VERSION = 1;
+static const uint8_t MOVIE_HASHES = 0x01;
+static const size_t MOVIE_HEADER_SIZE = 4 + 1 + 1 + 8 + 4 + 4 + 4;
+
+// Hashes do frame atual (0 = indisponível)
+static void frameHashes(const Console& console, std::vector<uint8_t>& scratch,
+                        uint64_t& stateHash, uint64_t& videoHash) {
+    size_t size = console.saveState(scratch.data(), scratch.size());
+    stateHash = size ? (hashBytes(scratch.data(), size) | 1) : 0;
+    
+    // No pipeline o frame buffer visível é o do frame anterior
+    const uint8_t* video = console.getFrameBuffer();
+    bool composed = video && !console.isPipelined() &&
+                    !(console.getHeadless() & HEADLESS_NO_VIDEO);
+    videoHash = composed ? (hashBytes(video, PPU::FRAME_BUFFER_SIZE) | 1) : 0;
+}
+
+MovieRecorder::MovieRecorder() : recording(false), withHashes(false), romHash(0),
+                                 lastFrame(0), frameCount(0), runButtons(0), runLength(0) {
+}
+
+bool MovieRecorder::begin(const Console& console, bool withHashes) {
+    this->withHashes = withHashes;
+    romHash = console.getROMHash();
+    lastFrame = console.getFrameCount();
+    frameCount = 0;
+    startState = console.getState();
+    scratch.assign(startState.size(), 0);
+    input.clear();
+    hashes.clear();
+    runButtons = 0;
+    runLength = 0;
+    recording = !startState.empty();
+    return recording;
+}
+
+void MovieRecorder::recordFrame(const Console& console) {
+    if (!recording) {
+        return;
+    }
+    
+    // Os frames do último runFrame têm os botões que cada um viu; frames
+    // anteriores a ele (recordFrame não chamado) ficam com os atuais
+    uint64_t frames = console.getFrameCount() - lastFrame;
+    lastFrame = console.getFrameCount();
+    int batch = console.getBatchFrames();
+    
+    for (uint64_t i = 0; i < frames; i++) {
+        uint64_t fromEnd = frames - i;
+        uint16_t buttons = fromEnd <= static_cast<uint64_t>(batch)
+            ? console.getBatchButtons(batch - static_cast<int>(fromEnd))
+            : console.getButtons();
+        if (runLength > 0 && buttons != runButtons) {
+            flushRun();
+        }
+        runButtons = buttons;
+        runLength++;
+        frameCount++;
+        
+        if (withHashes) {
+            uint64_t stateHash = 0;
+            uint64_t videoHash = 0;
+            if (i == frames - 1) {
+                frameHashes(console, scratch, stateHash, videoHash);
+            }
+            hashes.push_back(stateHash);
+            hashes.push_back(videoHash);
+        }
+    }
+}
+
+void MovieRecorder::flushRun() {
+    // Comprimento em varint (7 bits por byte)
+    uint32_t length = runLength;
+    while (length >= 0x80) {
+        input.push_back(static_cast<uint8_t>(length | 0x80));
+        length >>= 7;
+    }
+    input.push_back(static_cast<uint8_t>(length));
+    input.push_back(runButtons & 0xFF);
+    input.push_back(runButtons >> 8);
+    runLength = 0;
+}
+
+std::vector<uint8_t> MovieRecorder::finish() {
+    std::vector<uint8_t> movie;
+    if (!recording) {
+        return movie;
+    }
+    if (runLength > 0) {
+        flushRun();
+    }
+    recording = false;
+    
+    uint8_t flags = withHashes ? MOVIE_HASHES : 0;
+    uint32_t stateSize = static_cast<uint32_t>(startState.size());
+    uint32_t inputSize = static_cast<uint32_t>(input.size());
+    
+    movie.resize(MOVIE_HEADER_SIZE + startState.size() + input.size() +
+                 hashes.size() * sizeof(uint64_t));
+    StateWriter out(movie.data(), movie.size());
+    out.write(MOVIE_MAGIC);
+    out.write(MOVIE_VERSION);
+    out.write(flags);
+    out.write(romHash);
+    out.write(frameCount);
+    out.write(stateSize);
+    out.write(inputSize);
+    out.writeBytes(startState.data(), startState.size());
+    out.writeBytes(input.data(), input.size());
+    out.writeBytes(hashes.data(), hashes.size() * sizeof(uint64_t));
+    return movie;
+}
+
+MoviePlayer::MoviePlayer() : romHash(0), frameCount(0), withHashes(false), stateOffset(0),
+                             stateSize(0), inputOffset(0), inputSize(0), hashOffset(0),
+                             inputPos(0), runRemaining(0), runButtons(0),
+                             currentFrame(0), desynced(false), desyncFrame(0) {
+}
+
+bool MoviePlayer::load(const uint8_t* data, size_t size) {
+    StateReader in(data, size);
+    uint8_t magic[4];
+    uint8_t version;
+    uint8_t flags;
+    uint32_t frames;
+    uint32_t stateBytes;
+    uint32_t inputBytes;
+    in.read(magic);
+    in.read(version);
+    in.read(flags);
+    in.read(romHash);
+    in.read(frames);
+    in.read(stateBytes);
+    in.read(inputBytes);
+    if (!in.ok() || std::memcmp(magic, MOVIE_MAGIC, 4) != 0 || version != MOVIE_VERSION) {
+        return false;
+    }
+    
+    withHashes = (flags & MOVIE_HASHES) != 0;
+    size_t hashBytesTotal = withHashes ? static_cast<size_t>(frames) * 2 * sizeof(uint64_t) : 0;
+    if (MOVIE_HEADER_SIZE + stateBytes + inputBytes + hashBytesTotal != size) {
+        return false;
+    }
+    
+    this->data.assign(data, data + size);
+    frameCount = frames;
+    stateOffset = MOVIE_HEADER_SIZE;
+    stateSize = stateBytes;
+    inputOffset = stateOffset + stateSize;
+    inputSize = inputBytes;
+    hashOffset = inputOffset + inputSize;
+    currentFrame = frameCount;
+    return true;
+}
+
+bool MoviePlayer::begin(Console& console) {
+    if (data.empty() || console.getROMHash() != romHash) {
+        return false;
+    }
+    if (!console.setState(data.data() + stateOffset, stateSize)) {
+        return false;
+    }
+    console.setFastForward(1);
+    console.setMoviePlayback(true);
+    
+    // Toda a memória da reprodução é reservada aqui
+    scratch.assign(stateSize, 0);
+    inputPos = 0;
+    runRemaining = 0;
+    runButtons = 0;
+    currentFrame = 0;
+    desynced = false;
+    desyncFrame = 0;
+    return true;
+}
+
+bool MoviePlayer::nextInput(uint16_t& buttons) {
+    if (runRemaining == 0) {
+        const uint8_t* input = data.data() + inputOffset;
+        uint32_t length = 0;
+        int shift = 0;
+        while (inputPos < inputSize && shift < 32) {
+            uint8_t byte = input[inputPos++];
+            length |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) {
+                break;
+            }
+        }
+        if (length == 0 || inputPos + 2 > inputSize) {
+            return false;
+        }
+        runButtons = input[inputPos] | (input[inputPos + 1] << 8);
+        inputPos += 2;
+        runRemaining = length;
+    }
+    runRemaining--;
+    buttons = runButtons;
+    return true;
+}
+
+bool MoviePlayer::step(Console& console) {
+    uint16_t buttons;
+    if (desynced || isFinished() || !nextInput(buttons)) {
+        end(console);
+        return false;
+    }
+    
+    // Direto nos controles: a fila de entrada é da UI
+    console.setMovieButtons(buttons);
+    console.runFrame();
+    
+    if (withHashes) {
+        uint64_t expected[2];
+        std::memcpy(expected, data.data() + hashOffset + currentFrame * sizeof(expected), sizeof(expected));
+        uint64_t stateHash;
+        uint64_t videoHash;
+        frameHashes(console, scratch, stateHash, videoHash);
+        bool stateMismatch = expected[0] && stateHash != expected[0];
+        bool videoMismatch = expected[1] && videoHash && videoHash != expected[1];
+        if (stateMismatch || videoMismatch) {
+            desynced = true;
+            desyncFrame = currentFrame;
+        }
+    }
+    
+    currentFrame++;
+    if (desynced || isFinished()) {
+        end(console);
+    }
+    return !desynced;
+}
+
+void MoviePlayer::end(Console& console) {
+    console.setMoviePlayback(false);
+}
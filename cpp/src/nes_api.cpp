@@ -0,0 +1,406 @@
+#include "nes_api.h"
+#include "apu.h"
+#include "console.h"
+#include "frame_pacer.h"
+#include "ppu.h"
+#include "state_saver.h"
+#include "thumbnail.h"
+#include "video_filter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <new>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static_assert(NES_FRAME_BYTES == PPU::FRAME_BUFFER_SIZE, "Formato de vídeo da API diverge da PPU");
+static_assert(NES_AUDIO_SAMPLE_RATE == APU::SAMPLE_RATE &&
+              NES_AUDIO_MIN_CAPACITY == APU::SAMPLES_PER_FRAME, "Formato de áudio da API diverge da APU");
+static_assert(static_cast<int>(NES_IMAGE_QOI) == THUMBNAIL_QOI &&
+              static_cast<int>(NES_IMAGE_PNG) == THUMBNAIL_PNG, "Formatos de imagem divergem");
+
+static_assert(static_cast<int>(NES_FILTER_NEAREST) == VIDEO_FILTER_NEAREST &&
+              static_cast<int>(NES_FILTER_SMOOTH) == VIDEO_FILTER_SMOOTH &&
+              static_cast<int>(NES_FILTER_NTSC) == VIDEO_FILTER_NTSC, "Tipos de filtro divergem");
+
+// O handle opaco é o próprio Console. Nenhuma exceção atravessa a fronteira
+// C: falhas de alocação viram NULL ou NES_ERROR_OUT_OF_MEMORY.
+struct nes_console : Console {
+    explicit nes_console(bool compact) : Console(compact) {}
+};
+
+struct nes_video_filter : VideoFilter {};
+
+struct nes_state_saver : StateSaver {
+    nes_save_callback callback;
+    void* user;
+    
+    static void complete(void* self, uint64_t ticket, bool ok) {
+        nes_state_saver* saver = static_cast<nes_state_saver*>(self);
+        saver->callback(saver->user, ticket, ok ? 1 : 0);
+    }
+};
+
+struct nes_frame_pacer : FramePacer {
+    nes_frame_pacer(nes_console& console, double refreshHz) : FramePacer(console, refreshHz) {}
+};
+
+uint32_t nes_api_version(void) {
+    return NES_API_VERSION;
+}
+
+nes_console* nes_create(int compact) {
+    try {
+        return new nes_console(compact != 0);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void nes_destroy(nes_console* console) {
+    delete console;
+}
+
+nes_result nes_load_rom(nes_console* console, const uint8_t* data, size_t size) {
+    if (!console || !data) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        return console->loadROM(data, size) ? NES_OK : NES_ERROR_INVALID_ROM;
+    } catch (const std::bad_alloc&) {
+        return NES_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+nes_result nes_load_rom_fd(nes_console* console, int fd) {
+    if (!console || fd < 0) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        std::vector<uint8_t> data;
+        uint8_t chunk[16384];
+        for (;;) {
+#if defined(_WIN32)
+            int count = _read(fd, chunk, sizeof(chunk));
+#else
+            ssize_t count = read(fd, chunk, sizeof(chunk));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+#endif
+            if (count < 0) {
+                return NES_ERROR_IO;
+            }
+            if (count == 0) {
+                break;
+            }
+            data.insert(data.end(), chunk, chunk + count);
+        }
+        return nes_load_rom(console, data.data(), data.size());
+    } catch (const std::bad_alloc&) {
+        return NES_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+void nes_reset(nes_console* console) {
+    if (console) {
+        console->reset();
+    }
+}
+
+nes_result nes_set_video_buffer(nes_console* console, uint8_t* rgb, size_t size) {
+    if (!console) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    if (rgb && size < NES_FRAME_BYTES) {
+        return NES_ERROR_BUFFER_TOO_SMALL;
+    }
+    console->setFrameBuffer(rgb);
+    return NES_OK;
+}
+
+nes_result nes_set_audio_buffer(nes_console* console, float* samples, size_t capacity) {
+    if (!console) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    if (samples && capacity < NES_AUDIO_MIN_CAPACITY) {
+        return NES_ERROR_BUFFER_TOO_SMALL;
+    }
+    console->setAudioBuffer(samples, capacity);
+    return NES_OK;
+}
+
+void nes_run_frame(nes_console* console) {
+    if (console) {
+        console->runFrame();
+    }
+}
+
+uint64_t nes_get_frame_count(const nes_console* console) {
+    return console ? console->getFrameCount() : 0;
+}
+
+int nes_take_dirty_rows(nes_console* console, uint64_t rows[4]) {
+    if (!console) {
+        return 0;
+    }
+    DirtyRows dirty = console->takeDirtyRows();
+    if (rows) {
+        for (int i = 0; i < 4; i++) {
+            rows[i] = dirty.bits[i];
+        }
+    }
+    return dirty.count();
+}
+
+size_t nes_audio_available(const nes_console* console, size_t* head) {
+    size_t start = 0;
+    size_t count = console ? console->getAudioAvailable(start) : 0;
+    if (head) {
+        *head = start;
+    }
+    return count;
+}
+
+void nes_consume_audio(nes_console* console, size_t count) {
+    if (console) {
+        console->consumeAudio(count);
+    }
+}
+
+uint64_t nes_audio_overruns(const nes_console* console) {
+    return console ? console->getAudioOverruns() : 0;
+}
+
+nes_result nes_set_buttons(nes_console* console, int port, uint8_t buttons) {
+    if (!console || port < 0 || port > 1) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    console->setButtons(port, buttons);
+    return NES_OK;
+}
+
+nes_result nes_push_input(nes_console* console, uint64_t frame, uint64_t timestamp_ns,
+                          int port, uint8_t buttons) {
+    if (!console || port < 0 || port > 1) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    InputEvent event = {frame, timestamp_ns, static_cast<uint8_t>(port), buttons};
+    return console->pushInput(event) ? NES_OK : NES_ERROR_BUFFER_TOO_SMALL;
+}
+
+size_t nes_state_size(const nes_console* console) {
+    return console ? console->getStateSize() : 0;
+}
+
+size_t nes_save_state(const nes_console* console, uint8_t* buffer, size_t capacity) {
+    if (!console || !buffer) {
+        return 0;
+    }
+    return console->saveState(buffer, capacity);
+}
+
+nes_result nes_load_state(nes_console* console, const uint8_t* data, size_t size) {
+    if (!console || !data) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    return console->setState(data, size) ? NES_OK : NES_ERROR_INVALID_STATE;
+}
+
+nes_state_saver* nes_saver_create(nes_save_callback callback, void* user) {
+    try {
+        nes_state_saver* saver = new nes_state_saver();
+        saver->callback = callback;
+        saver->user = user;
+        if (callback) {
+            saver->setCompletion(&nes_state_saver::complete, saver);
+        }
+        return saver;
+    } catch (const std::exception&) {
+        return nullptr;  // Sem memória ou sem thread
+    }
+}
+
+void nes_saver_destroy(nes_state_saver* saver) {
+    delete saver;
+}
+
+uint64_t nes_saver_save(nes_state_saver* saver, const nes_console* console, const char* path,
+                        int thumbnail) {
+    if (!saver || !console) {
+        return 0;
+    }
+    try {
+        return saver->save(*console, path, thumbnail != 0);
+    } catch (const std::bad_alloc&) {
+        return 0;
+    }
+}
+
+void nes_saver_flush(nes_state_saver* saver) {
+    if (saver) {
+        saver->flush();
+    }
+}
+
+nes_result nes_load_state_file(nes_console* console, const char* path) {
+    if (!console || !path) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    try {
+        std::vector<uint8_t> state;
+        if (!StateSaver::readFile(path, state)) {
+            return NES_ERROR_IO;
+        }
+        return console->setState(state.data(), state.size()) ? NES_OK : NES_ERROR_INVALID_STATE;
+    } catch (const std::bad_alloc&) {
+        return NES_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+size_t nes_read_state_thumbnail(const char* path, uint8_t* buffer, size_t capacity) {
+    if (!path || !buffer) {
+        return 0;
+    }
+    try {
+        std::vector<uint8_t> state;
+        std::vector<uint8_t> thumbnail;
+        if (!StateSaver::readFile(path, state, &thumbnail) || thumbnail.size() > capacity) {
+            return 0;
+        }
+        std::copy(thumbnail.begin(), thumbnail.end(), buffer);
+        return thumbnail.size();
+    } catch (const std::bad_alloc&) {
+        return 0;
+    }
+}
+
+size_t nes_thumbnail_max_size(nes_image_format format, int width, int height) {
+    return thumbnailMaxSize(static_cast<ThumbnailFormat>(format), width, height);
+}
+
+size_t nes_encode_thumbnail(const nes_console* console, nes_image_format format,
+                            int width, int height, uint8_t* buffer, size_t capacity) {
+    if (!console || !buffer) {
+        return 0;
+    }
+    return encodeThumbnail(console->getFrameBuffer(), width, height,
+                           static_cast<ThumbnailFormat>(format), buffer, capacity);
+}
+
+nes_video_filter* nes_filter_create(nes_filter_type type, int scale, uint8_t scanlines) {
+    if (scale < 2 || scale > 4) {
+        return nullptr;
+    }
+    VideoFilterSettings settings = {static_cast<VideoFilterType>(type), static_cast<uint8_t>(scale),
+                                    scanlines};
+    nes_video_filter* filter = new (std::nothrow) nes_video_filter();
+    if (filter && !filter->configure(settings)) {
+        delete filter;
+        return nullptr;
+    }
+    return filter;
+}
+
+void nes_filter_destroy(nes_video_filter* filter) {
+    delete filter;
+}
+
+void nes_filter_get_size(const nes_video_filter* filter, int* width, int* height) {
+    if (width) {
+        *width = filter ? filter->getWidth() : 0;
+    }
+    if (height) {
+        *height = filter ? filter->getHeight() : 0;
+    }
+}
+
+nes_result nes_filter_apply(const nes_video_filter* filter, const uint8_t* rgb,
+                            uint8_t* out, size_t pitch, size_t size) {
+    if (!filter || !rgb || !out) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    size_t rowBytes = static_cast<size_t>(filter->getWidth()) * 4;
+    if (pitch < rowBytes) {
+        return NES_ERROR_INVALID_ARGUMENT;
+    }
+    if (size < pitch * (filter->getHeight() - 1) + rowBytes) {
+        return NES_ERROR_BUFFER_TOO_SMALL;
+    }
+    filter->apply(rgb, out, pitch);
+    return NES_OK;
+}
+
+uint64_t nes_now_ns(void) {
+    return FramePacer::nowNs();
+}
+
+nes_frame_pacer* nes_pacer_create(nes_console* console, double refresh_hz) {
+    if (!console) {
+        return nullptr;
+    }
+    return new (std::nothrow) nes_frame_pacer(*console, refresh_hz);
+}
+
+void nes_pacer_destroy(nes_frame_pacer* pacer) {
+    delete pacer;
+}
+
+void nes_pacer_set_refresh_rate(nes_frame_pacer* pacer, double refresh_hz) {
+    if (pacer) {
+        pacer->setRefreshRate(refresh_hz);
+    }
+}
+
+void nes_pacer_on_vsync(nes_frame_pacer* pacer, uint64_t vsync_ns, uint64_t period_ns) {
+    if (pacer) {
+        pacer->onVsync(vsync_ns, period_ns);
+    }
+}
+
+uint64_t nes_pacer_wait(nes_frame_pacer* pacer) {
+    return pacer ? pacer->waitForFrame() : 0;
+}
+
+void nes_pacer_run_frame(nes_frame_pacer* pacer) {
+    if (pacer) {
+        pacer->runFrame();
+    }
+}
+
+uint64_t nes_pacer_frame_presented(nes_frame_pacer* pacer, uint64_t present_ns) {
+    return pacer ? pacer->framePresented(present_ns).inputLatencyNs : 0;
+}
+
+void nes_pacer_get_stats(const nes_frame_pacer* pacer, nes_pacer_stats* stats) {
+    if (!stats) {
+        return;
+    }
+    PacerStats source = pacer ? pacer->getStats() : PacerStats();
+    stats->frames = source.frames;
+    stats->missed = source.missed;
+    stats->events = source.events;
+    stats->emulate_avg_ns = source.emulateAvgNs;
+    stats->emulate_jitter_ns = source.emulateJitterNs;
+    stats->input_latency_avg_ns = source.inputLatencyAvgNs;
+    stats->input_latency_max_ns = source.inputLatencyMaxNs;
+    stats->event_latency_avg_ns = source.eventLatencyAvgNs;
+    stats->event_latency_max_ns = source.eventLatencyMaxNs;
+}
+
+void nes_set_headless(nes_console* console, uint8_t flags) {
+    if (console) {
+        console->setHeadless(flags);
+    }
+}
+
+void nes_set_fast_forward(nes_console* console, int frames) {
+    if (console) {
+        console->setFastForward(frames);
+    }
+}
@@ -0,0 +1,260 @@
+#include "opcodes.h"
+
+const OpcodeInfo OPCODE_TABLE[256] = {
+    {"BRK", OP_BRK, MODE_IMPLIED, 7, true},  // $00
+    {"ORA", OP_ORA, MODE_INDIRECT_X, 6, true},  // $01
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $02
+    {"SLO", OP_SLO, MODE_INDIRECT_X, 8, false},  // $03
+    {"NOP", OP_NOP, MODE_ZERO_PAGE, 3, false},  // $04
+    {"ORA", OP_ORA, MODE_ZERO_PAGE, 3, true},  // $05
+    {"ASL", OP_ASL, MODE_ZERO_PAGE, 5, true},  // $06
+    {"SLO", OP_SLO, MODE_ZERO_PAGE, 5, false},  // $07
+    {"PHP", OP_PHP, MODE_IMPLIED, 3, true},  // $08
+    {"ORA", OP_ORA, MODE_IMMEDIATE, 2, true},  // $09
+    {"ASL", OP_ASL, MODE_ACCUMULATOR, 2, true},  // $0A
+    {"ANC", OP_ANC, MODE_IMMEDIATE, 2, false},  // $0B
+    {"NOP", OP_NOP, MODE_ABSOLUTE, 4, false},  // $0C
+    {"ORA", OP_ORA, MODE_ABSOLUTE, 4, true},  // $0D
+    {"ASL", OP_ASL, MODE_ABSOLUTE, 6, true},  // $0E
+    {"SLO", OP_SLO, MODE_ABSOLUTE, 6, false},  // $0F
+    {"BPL", OP_BPL, MODE_RELATIVE, 2, true},  // $10
+    {"ORA", OP_ORA, MODE_INDIRECT_Y, 5, true},  // $11
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $12
+    {"SLO", OP_SLO, MODE_INDIRECT_Y, 8, false},  // $13
+    {"NOP", OP_NOP, MODE_ZERO_PAGE_X, 4, false},  // $14
+    {"ORA", OP_ORA, MODE_ZERO_PAGE_X, 4, true},  // $15
+    {"ASL", OP_ASL, MODE_ZERO_PAGE_X, 6, true},  // $16
+    {"SLO", OP_SLO, MODE_ZERO_PAGE_X, 6, false},  // $17
+    {"CLC", OP_CLC, MODE_IMPLIED, 2, true},  // $18
+    {"ORA", OP_ORA, MODE_ABSOLUTE_Y, 4, true},  // $19
+    {"NOP", OP_NOP, MODE_IMPLIED, 2, false},  // $1A
+    {"SLO", OP_SLO, MODE_ABSOLUTE_Y, 7, false},  // $1B
+    {"NOP", OP_NOP, MODE_ABSOLUTE_X, 4, false},  // $1C
+    {"ORA", OP_ORA, MODE_ABSOLUTE_X, 4, true},  // $1D
+    {"ASL", OP_ASL, MODE_ABSOLUTE_X, 7, true},  // $1E
+    {"SLO", OP_SLO, MODE_ABSOLUTE_X, 7, false},  // $1F
+    {"JSR", OP_JSR, MODE_ABSOLUTE, 6, true},  // $20
+    {"AND", OP_AND, MODE_INDIRECT_X, 6, true},  // $21
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $22
+    {"RLA", OP_RLA, MODE_INDIRECT_X, 8, false},  // $23
+    {"BIT", OP_BIT, MODE_ZERO_PAGE, 3, true},  // $24
+    {"AND", OP_AND, MODE_ZERO_PAGE, 3, true},  // $25
+    {"ROL", OP_ROL, MODE_ZERO_PAGE, 5, true},  // $26
+    {"RLA", OP_RLA, MODE_ZERO_PAGE, 5, false},  // $27
+    {"PLP", OP_PLP, MODE_IMPLIED, 4, true},  // $28
+    {"AND", OP_AND, MODE_IMMEDIATE, 2, true},  // $29
+    {"ROL", OP_ROL, MODE_ACCUMULATOR, 2, true},  // $2A
+    {"ANC", OP_ANC, MODE_IMMEDIATE, 2, false},  // $2B
+    {"BIT", OP_BIT, MODE_ABSOLUTE, 4, true},  // $2C
+    {"AND", OP_AND, MODE_ABSOLUTE, 4, true},  // $2D
+    {"ROL", OP_ROL, MODE_ABSOLUTE, 6, true},  // $2E
+    {"RLA", OP_RLA, MODE_ABSOLUTE, 6, false},  // $2F
+    {"BMI", OP_BMI, MODE_RELATIVE, 2, true},  // $30
+    {"AND", OP_AND, MODE_INDIRECT_Y, 5, true},  // $31
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $32
+    {"RLA", OP_RLA, MODE_INDIRECT_Y, 8, false},  // $33
+    {"NOP", OP_NOP, MODE_ZERO_PAGE_X, 4, false},  // $34
+    {"AND", OP_AND, MODE_ZERO_PAGE_X, 4, true},  // $35
+    {"ROL", OP_ROL, MODE_ZERO_PAGE_X, 6, true},  // $36
+    {"RLA", OP_RLA, MODE_ZERO_PAGE_X, 6, false},  // $37
+    {"SEC", OP_SEC, MODE_IMPLIED, 2, true},  // $38
+    {"AND", OP_AND, MODE_ABSOLUTE_Y, 4, true},  // $39
+    {"NOP", OP_NOP, MODE_IMPLIED, 2, false},  // $3A
+    {"RLA", OP_RLA, MODE_ABSOLUTE_Y, 7, false},  // $3B
+    {"NOP", OP_NOP, MODE_ABSOLUTE_X, 4, false},  // $3C
+    {"AND", OP_AND, MODE_ABSOLUTE_X, 4, true},  // $3D
+    {"ROL", OP_ROL, MODE_ABSOLUTE_X, 7, true},  // $3E
+    {"RLA", OP_RLA, MODE_ABSOLUTE_X, 7, false},  // $3F
+    {"RTI", OP_RTI, MODE_IMPLIED, 6, true},  // $40
+    {"EOR", OP_EOR, MODE_INDIRECT_X, 6, true},  // $41
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $42
+    {"SRE", OP_SRE, MODE_INDIRECT_X, 8, false},  // $43
+    {"NOP", OP_NOP, MODE_ZERO_PAGE, 3, false},  // $44
+    {"EOR", OP_EOR, MODE_ZERO_PAGE, 3, true},  // $45
+    {"LSR", OP_LSR, MODE_ZERO_PAGE, 5, true},  // $46
+    {"SRE", OP_SRE, MODE_ZERO_PAGE, 5, false},  // $47
+    {"PHA", OP_PHA, MODE_IMPLIED, 3, true},  // $48
+    {"EOR", OP_EOR, MODE_IMMEDIATE, 2, true},  // $49
+    {"LSR", OP_LSR, MODE_ACCUMULATOR, 2, true},  // $4A
+    {"ALR", OP_ALR, MODE_IMMEDIATE, 2, false},  // $4B
+    {"JMP", OP_JMP, MODE_ABSOLUTE, 3, true},  // $4C
+    {"EOR", OP_EOR, MODE_ABSOLUTE, 4, true},  // $4D
+    {"LSR", OP_LSR, MODE_ABSOLUTE, 6, true},  // $4E
+    {"SRE", OP_SRE, MODE_ABSOLUTE, 6, false},  // $4F
+    {"BVC", OP_BVC, MODE_RELATIVE, 2, true},  // $50
+    {"EOR", OP_EOR, MODE_INDIRECT_Y, 5, true},  // $51
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $52
+    {"SRE", OP_SRE, MODE_INDIRECT_Y, 8, false},  // $53
+    {"NOP", OP_NOP, MODE_ZERO_PAGE_X, 4, false},  // $54
+    {"EOR", OP_EOR, MODE_ZERO_PAGE_X, 4, true},  // $55
+    {"LSR", OP_LSR, MODE_ZERO_PAGE_X, 6, true},  // $56
+    {"SRE", OP_SRE, MODE_ZERO_PAGE_X, 6, false},  // $57
+    {"CLI", OP_CLI, MODE_IMPLIED, 2, true},  // $58
+    {"EOR", OP_EOR, MODE_ABSOLUTE_Y, 4, true},  // $59
+    {"NOP", OP_NOP, MODE_IMPLIED, 2, false},  // $5A
+    {"SRE", OP_SRE, MODE_ABSOLUTE_Y, 7, false},  // $5B
+    {"NOP", OP_NOP, MODE_ABSOLUTE_X, 4, false},  // $5C
+    {"EOR", OP_EOR, MODE_ABSOLUTE_X, 4, true},  // $5D
+    {"LSR", OP_LSR, MODE_ABSOLUTE_X, 7, true},  // $5E
+    {"SRE", OP_SRE, MODE_ABSOLUTE_X, 7, false},  // $5F
+    {"RTS", OP_RTS, MODE_IMPLIED, 6, true},  // $60
+    {"ADC", OP_ADC, MODE_INDIRECT_X, 6, true},  // $61
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $62
+    {"RRA", OP_RRA, MODE_INDIRECT_X, 8, false},  // $63
+    {"NOP", OP_NOP, MODE_ZERO_PAGE, 3, false},  // $64
+    {"ADC", OP_ADC, MODE_ZERO_PAGE, 3, true},  // $65
+    {"ROR", OP_ROR, MODE_ZERO_PAGE, 5, true},  // $66
+    {"RRA", OP_RRA, MODE_ZERO_PAGE, 5, false},  // $67
+    {"PLA", OP_PLA, MODE_IMPLIED, 4, true},  // $68
+    {"ADC", OP_ADC, MODE_IMMEDIATE, 2, true},  // $69
+    {"ROR", OP_ROR, MODE_ACCUMULATOR, 2, true},  // $6A
+    {"ARR", OP_ARR, MODE_IMMEDIATE, 2, false},  // $6B
+    {"JMP", OP_JMP, MODE_INDIRECT, 5, true},  // $6C
+    {"ADC", OP_ADC, MODE_ABSOLUTE, 4, true},  // $6D
+    {"ROR", OP_ROR, MODE_ABSOLUTE, 6, true},  // $6E
+    {"RRA", OP_RRA, MODE_ABSOLUTE, 6, false},  // $6F
+    {"BVS", OP_BVS, MODE_RELATIVE, 2, true},  // $70
+    {"ADC", OP_ADC, MODE_INDIRECT_Y, 5, true},  // $71
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $72
+    {"RRA", OP_RRA, MODE_INDIRECT_Y, 8, false},  // $73
+    {"NOP", OP_NOP, MODE_ZERO_PAGE_X, 4, false},  // $74
+    {"ADC", OP_ADC, MODE_ZERO_PAGE_X, 4, true},  // $75
+    {"ROR", OP_ROR, MODE_ZERO_PAGE_X, 6, true},  // $76
+    {"RRA", OP_RRA, MODE_ZERO_PAGE_X, 6, false},  // $77
+    {"SEI", OP_SEI, MODE_IMPLIED, 2, true},  // $78
+    {"ADC", OP_ADC, MODE_ABSOLUTE_Y, 4, true},  // $79
+    {"NOP", OP_NOP, MODE_IMPLIED, 2, false},  // $7A
+    {"RRA", OP_RRA, MODE_ABSOLUTE_Y, 7, false},  // $7B
+    {"NOP", OP_NOP, MODE_ABSOLUTE_X, 4, false},  // $7C
+    {"ADC", OP_ADC, MODE_ABSOLUTE_X, 4, true},  // $7D
+    {"ROR", OP_ROR, MODE_ABSOLUTE_X, 7, true},  // $7E
+    {"RRA", OP_RRA, MODE_ABSOLUTE_X, 7, false},  // $7F
+    {"NOP", OP_NOP, MODE_IMMEDIATE, 2, false},  // $80
+    {"STA", OP_STA, MODE_INDIRECT_X, 6, true},  // $81
+    {"NOP", OP_NOP, MODE_IMMEDIATE, 2, false},  // $82
+    {"SAX", OP_SAX, MODE_INDIRECT_X, 6, false},  // $83
+    {"STY", OP_STY, MODE_ZERO_PAGE, 3, true},  // $84
+    {"STA", OP_STA, MODE_ZERO_PAGE, 3, true},  // $85
+    {"STX", OP_STX, MODE_ZERO_PAGE, 3, true},  // $86
+    {"SAX", OP_SAX, MODE_ZERO_PAGE, 3, false},  // $87
+    {"DEY", OP_DEY, MODE_IMPLIED, 2, true},  // $88
+    {"NOP", OP_NOP, MODE_IMMEDIATE, 2, false},  // $89
+    {"TXA", OP_TXA, MODE_IMPLIED, 2, true},  // $8A
+    {"XAA", OP_XAA, MODE_IMMEDIATE, 2, false},  // $8B
+    {"STY", OP_STY, MODE_ABSOLUTE, 4, true},  // $8C
+    {"STA", OP_STA, MODE_ABSOLUTE, 4, true},  // $8D
+    {"STX", OP_STX, MODE_ABSOLUTE, 4, true},  // $8E
+    {"SAX", OP_SAX, MODE_ABSOLUTE, 4, false},  // $8F
+    {"BCC", OP_BCC, MODE_RELATIVE, 2, true},  // $90
+    {"STA", OP_STA, MODE_INDIRECT_Y, 6, true},  // $91
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $92
+    {"AHX", OP_AHX, MODE_INDIRECT_Y, 6, false},  // $93
+    {"STY", OP_STY, MODE_ZERO_PAGE_X, 4, true},  // $94
+    {"STA", OP_STA, MODE_ZERO_PAGE_X, 4, true},  // $95
+    {"STX", OP_STX, MODE_ZERO_PAGE_Y, 4, true},  // $96
+    {"SAX", OP_SAX, MODE_ZERO_PAGE_Y, 4, false},  // $97
+    {"TYA", OP_TYA, MODE_IMPLIED, 2, true},  // $98
+    {"STA", OP_STA, MODE_ABSOLUTE_Y, 5, true},  // $99
+    {"TXS", OP_TXS, MODE_IMPLIED, 2, true},  // $9A
+    {"TAS", OP_TAS, MODE_ABSOLUTE_Y, 5, false},  // $9B
+    {"SHY", OP_SHY, MODE_ABSOLUTE_X, 5, false},  // $9C
+    {"STA", OP_STA, MODE_ABSOLUTE_X, 5, true},  // $9D
+    {"SHX", OP_SHX, MODE_ABSOLUTE_Y, 5, false},  // $9E
+    {"AHX", OP_AHX, MODE_ABSOLUTE_Y, 5, false},  // $9F
+    {"LDY", OP_LDY, MODE_IMMEDIATE, 2, true},  // $A0
+    {"LDA", OP_LDA, MODE_INDIRECT_X, 6, true},  // $A1
+    {"LDX", OP_LDX, MODE_IMMEDIATE, 2, true},  // $A2
+    {"LAX", OP_LAX, MODE_INDIRECT_X, 6, false},  // $A3
+    {"LDY", OP_LDY, MODE_ZERO_PAGE, 3, true},  // $A4
+    {"LDA", OP_LDA, MODE_ZERO_PAGE, 3, true},  // $A5
+    {"LDX", OP_LDX, MODE_ZERO_PAGE, 3, true},  // $A6
+    {"LAX", OP_LAX, MODE_ZERO_PAGE, 3, false},  // $A7
+    {"TAY", OP_TAY, MODE_IMPLIED, 2, true},  // $A8
+    {"LDA", OP_LDA, MODE_IMMEDIATE, 2, true},  // $A9
+    {"TAX", OP_TAX, MODE_IMPLIED, 2, true},  // $AA
+    {"LAX", OP_LAX, MODE_IMMEDIATE, 2, false},  // $AB
+    {"LDY", OP_LDY, MODE_ABSOLUTE, 4, true},  // $AC
+    {"LDA", OP_LDA, MODE_ABSOLUTE, 4, true},  // $AD
+    {"LDX", OP_LDX, MODE_ABSOLUTE, 4, true},  // $AE
+    {"LAX", OP_LAX, MODE_ABSOLUTE, 4, false},  // $AF
+    {"BCS", OP_BCS, MODE_RELATIVE, 2, true},  // $B0
+    {"LDA", OP_LDA, MODE_INDIRECT_Y, 5, true},  // $B1
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $B2
+    {"LAX", OP_LAX, MODE_INDIRECT_Y, 5, false},  // $B3
+    {"LDY", OP_LDY, MODE_ZERO_PAGE_X, 4, true},  // $B4
+    {"LDA", OP_LDA, MODE_ZERO_PAGE_X, 4, true},  // $B5
+    {"LDX", OP_LDX, MODE_ZERO_PAGE_Y, 4, true},  // $B6
+    {"LAX", OP_LAX, MODE_ZERO_PAGE_Y, 4, false},  // $B7
+    {"CLV", OP_CLV, MODE_IMPLIED, 2, true},  // $B8
+    {"LDA", OP_LDA, MODE_ABSOLUTE_Y, 4, true},  // $B9
+    {"TSX", OP_TSX, MODE_IMPLIED, 2, true},  // $BA
+    {"LAS", OP_LAS, MODE_ABSOLUTE_Y, 4, false},  // $BB
+    {"LDY", OP_LDY, MODE_ABSOLUTE_X, 4, true},  // $BC
+    {"LDA", OP_LDA, MODE_ABSOLUTE_X, 4, true},  // $BD
+    {"LDX", OP_LDX, MODE_ABSOLUTE_Y, 4, true},  // $BE
+    {"LAX", OP_LAX, MODE_ABSOLUTE_Y, 4, false},  // $BF
+    {"CPY", OP_CPY, MODE_IMMEDIATE, 2, true},  // $C0
+    {"CMP", OP_CMP, MODE_INDIRECT_X, 6, true},  // $C1
+    {"NOP", OP_NOP, MODE_IMMEDIATE, 2, false},  // $C2
+    {"DCP", OP_DCP, MODE_INDIRECT_X, 8, false},  // $C3
+    {"CPY", OP_CPY, MODE_ZERO_PAGE, 3, true},  // $C4
+    {"CMP", OP_CMP, MODE_ZERO_PAGE, 3, true},  // $C5
+    {"DEC", OP_DEC, MODE_ZERO_PAGE, 5, true},  // $C6
+    {"DCP", OP_DCP, MODE_ZERO_PAGE, 5, false},  // $C7
+    {"INY", OP_INY, MODE_IMPLIED, 2, true},  // $C8
+    {"CMP", OP_CMP, MODE_IMMEDIATE, 2, true},  // $C9
+    {"DEX", OP_DEX, MODE_IMPLIED, 2, true},  // $CA
+    {"AXS", OP_AXS, MODE_IMMEDIATE, 2, false},  // $CB
+    {"CPY", OP_CPY, MODE_ABSOLUTE, 4, true},  // $CC
+    {"CMP", OP_CMP, MODE_ABSOLUTE, 4, true},  // $CD
+    {"DEC", OP_DEC, MODE_ABSOLUTE, 6, true},  // $CE
+    {"DCP", OP_DCP, MODE_ABSOLUTE, 6, false},  // $CF
+    {"BNE", OP_BNE, MODE_RELATIVE, 2, true},  // $D0
+    {"CMP", OP_CMP, MODE_INDIRECT_Y, 5, true},  // $D1
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $D2
+    {"DCP", OP_DCP, MODE_INDIRECT_Y, 8, false},  // $D3
+    {"NOP", OP_NOP, MODE_ZERO_PAGE_X, 4, false},  // $D4
+    {"CMP", OP_CMP, MODE_ZERO_PAGE_X, 4, true},  // $D5
+    {"DEC", OP_DEC, MODE_ZERO_PAGE_X, 6, true},  // $D6
+    {"DCP", OP_DCP, MODE_ZERO_PAGE_X, 6, false},  // $D7
+    {"CLD", OP_CLD, MODE_IMPLIED, 2, true},  // $D8
+    {"CMP", OP_CMP, MODE_ABSOLUTE_Y, 4, true},  // $D9
+    {"NOP", OP_NOP, MODE_IMPLIED, 2, false},  // $DA
+    {"DCP", OP_DCP, MODE_ABSOLUTE_Y, 7, false},  // $DB
+    {"NOP", OP_NOP, MODE_ABSOLUTE_X, 4, false},  // $DC
+    {"CMP", OP_CMP, MODE_ABSOLUTE_X, 4, true},  // $DD
+    {"DEC", OP_DEC, MODE_ABSOLUTE_X, 7, true},  // $DE
+    {"DCP", OP_DCP, MODE_ABSOLUTE_X, 7, false},  // $DF
+    {"CPX", OP_CPX, MODE_IMMEDIATE, 2, true},  // $E0
+    {"SBC", OP_SBC, MODE_INDIRECT_X, 6, true},  // $E1
+    {"NOP", OP_NOP, MODE_IMMEDIATE, 2, false},  // $E2
+    {"ISB", OP_ISB, MODE_INDIRECT_X, 8, false},  // $E3
+    {"CPX", OP_CPX, MODE_ZERO_PAGE, 3, true},  // $E4
+    {"SBC", OP_SBC, MODE_ZERO_PAGE, 3, true},  // $E5
+    {"INC", OP_INC, MODE_ZERO_PAGE, 5, true},  // $E6
+    {"ISB", OP_ISB, MODE_ZERO_PAGE, 5, false},  // $E7
+    {"INX", OP_INX, MODE_IMPLIED, 2, true},  // $E8
+    {"SBC", OP_SBC, MODE_IMMEDIATE, 2, true},  // $E9
+    {"NOP", OP_NOP, MODE_IMPLIED, 2, true},  // $EA
+    {"SBC", OP_SBC, MODE_IMMEDIATE, 2, false},  // $EB
+    {"CPX", OP_CPX, MODE_ABSOLUTE, 4, true},  // $EC
+    {"SBC", OP_SBC, MODE_ABSOLUTE, 4, true},  // $ED
+    {"INC", OP_INC, MODE_ABSOLUTE, 6, true},  // $EE
+    {"ISB", OP_ISB, MODE_ABSOLUTE, 6, false},  // $EF
+    {"BEQ", OP_BEQ, MODE_RELATIVE, 2, true},  // $F0
+    {"SBC", OP_SBC, MODE_INDIRECT_Y, 5, true},  // $F1
+    {"STP", OP_STP, MODE_IMPLIED, 2, false},  // $F2
+    {"ISB", OP_ISB, MODE_INDIRECT_Y, 8, false},  // $F3
+    {"NOP", OP_NOP, MODE_ZERO_PAGE_X, 4, false},  // $F4
+    {"SBC", OP_SBC, MODE_ZERO_PAGE_X, 4, true},  // $F5
+    {"INC", OP_INC, MODE_ZERO_PAGE_X, 6, true},  // $F6
+    {"ISB", OP_ISB, MODE_ZERO_PAGE_X, 6, false},  // $F7
+    {"SED", OP_SED, MODE_IMPLIED, 2, true},  // $F8
+    {"SBC", OP_SBC, MODE_ABSOLUTE_Y, 4, true},  // $F9
+    {"NOP", OP_NOP, MODE_IMPLIED, 2, false},  // $FA
+    {"ISB", OP_ISB, MODE_ABSOLUTE_Y, 7, false},  // $FB
+    {"NOP", OP_NOP, MODE_ABSOLUTE_X, 4, false},  // $FC
+    {"SBC", OP_SBC, MODE_ABSOLUTE_X, 4, true},  // $FD
+    {"INC", OP_INC, MODE_ABSOLUTE_X, 7, true},  // $FE
+    {"ISB", OP_ISB, MODE_ABSOLUTE_X, 7, false},  // $FF
+};
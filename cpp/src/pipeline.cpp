@@ -0,0 +1,162 @@
+#include "pipeline.h"
+
+#include <cstring>
+
+RenderPipeline::RenderPipeline(const PPU& ppu, const Cartridge& cartridge)
+    : ppu(ppu), cartridge(cartridge), frontBuffer(0), framesQueued(0),
+      framesRendered(0), stopping(false) {
+    for (auto& buffer : frameBuffers) {
+        buffer.assign(PPU::FRAME_BUFFER_SIZE, 0);
+    }
+    // Buffers novos: o primeiro frame publicado conta como todo alterado
+    this->ppu.markAllRowsDirty();
+    for (auto& word : dirtyRows) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    this->ppu.setCartridge(&this->cartridge);
+    this->ppu.setFrameBuffer(frameBuffers[1].data());
+    this->ppu.setVideoEnabled(true);
+    
+    worker = std::thread(&RenderPipeline::run, this);
+}
+
+RenderPipeline::~RenderPipeline() {
+    stopping.store(true, std::memory_order_release);
+    wake();
+    worker.join();
+}
+
+void RenderPipeline::logOAMDMA(uint64_t dot, const uint8_t* data) {
+    push({dot, 0x4014, 0, PPUEvent::OAM_DMA});
+    for (int i = 0; i < OAM_DMA_CHUNKS; i++) {
+        PPUEvent chunk = {0, 0, 0, PPUEvent::OAM_DMA};
+        std::memcpy(chunk.data, data + i * 8, 8);
+        push(chunk);
+    }
+}
+
+void RenderPipeline::setVideoEnabled(uint64_t dot, bool enabled) {
+    push({dot, 0, static_cast<uint8_t>(enabled ? 1 : 0), PPUEvent::VIDEO_ENABLE});
+}
+
+void RenderPipeline::endFrame(uint64_t dot) {
+    push({dot, 0, 0, PPUEvent::FRAME_END});
+    framesQueued++;
+    wake();
+    
+    // Limita o atraso da renderização a um frame
+    if (framesQueued < 2) {
+        return;
+    }
+    uint64_t target = framesQueued - 1;
+    if (framesRendered.load(std::memory_order_acquire) < target) {
+        std::unique_lock<std::mutex> lock(mutex);
+        frameDone.wait(lock, [this, target] {
+            return framesRendered.load(std::memory_order_acquire) >= target;
+        });
+    }
+}
+
+const uint8_t* RenderPipeline::getFrameBuffer() const {
+    return frameBuffers[frontBuffer.load(std::memory_order_acquire)].data();
+}
+
+DirtyRows RenderPipeline::takeDirtyRows() {
+    DirtyRows rows;
+    for (int i = 0; i < 4; i++) {
+        rows.bits[i] = dirtyRows[i].exchange(0, std::memory_order_acquire);
+    }
+    return rows;
+}
+
+bool RenderPipeline::hasDirtyRows() const {
+    for (const auto& word : dirtyRows) {
+        if (word.load(std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RenderPipeline::push(const PPUEvent& event) {
+    // Fila cheia: acorda o consumidor e espera espaço
+    while (!queue.push(event)) {
+        wake();
+        std::this_thread::yield();
+    }
+}
+
+void RenderPipeline::wake() {
+    // Passar pelo mutex evita perder a notificação entre o teste e o wait
+    { std::lock_guard<std::mutex> lock(mutex); }
+    workReady.notify_one();
+}
+
+void RenderPipeline::run() {
+    PPUEvent event;
+    while (!stopping.load(std::memory_order_acquire)) {
+        if (queue.pop(event)) {
+            apply(event);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        workReady.wait(lock, [this] {
+            return stopping.load(std::memory_order_acquire) || !queue.empty();
+        });
+    }
+}
+
+void RenderPipeline::apply(const PPUEvent& event) {
+    if (ppu.getDotCount() < event.dot) {
+        ppu.run(event.dot - ppu.getDotCount());
+    }
+    
+    switch (event.kind) {
+        case PPUEvent::WRITE:
+            if (event.addr < 0x4000) {
+                ppu.write(event.addr, event.value);
+            } else if (event.addr >= 0xC000 && cartridge.hasScanlineIRQ()) {
+                // Mesma sincronização de Memory::write
+                ppu.syncMapperIRQ();
+                cartridge.writePRG(event.addr, event.value);
+                ppu.updateMapperIRQ();
+            } else {
+                cartridge.writePRG(event.addr, event.value);
+            }
+            break;
+        case PPUEvent::OAM_DMA: {
+            // A carga vem logo atrás do cabeçalho
+            std::array<uint8_t, 0x100> oamData;
+            PPUEvent chunk;
+            for (int i = 0; i < OAM_DMA_CHUNKS; i++) {
+                while (!queue.pop(chunk)) {
+                    std::this_thread::yield();
+                }
+                std::memcpy(oamData.data() + i * 8, chunk.data, 8);
+            }
+            ppu.writeOAM(oamData.data());
+            break;
+        }
+        case PPUEvent::READ:
+            ppu.read(event.addr);
+            break;
+        case PPUEvent::VIDEO_ENABLE:
+            ppu.setVideoEnabled(event.value != 0);
+            break;
+        case PPUEvent::FRAME_END: {
+            DirtyRows rows = ppu.takeDirtyRows();
+            for (int i = 0; i < 4; i++) {
+                dirtyRows[i].fetch_or(rows.bits[i], std::memory_order_release);
+            }
+            int front = 1 - frontBuffer.load(std::memory_order_relaxed);
+            frontBuffer.store(front, std::memory_order_release);
+            ppu.setFrameBuffer(frameBuffers[1 - front].data());
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                framesRendered.fetch_add(1, std::memory_order_release);
+            }
+            frameDone.notify_all();
+            break;
+        }
+    }
+}
@@ -1,77 +1,803 @@
 #include "ppu.h"
+#include "cartridge.h"
+#include "state.h"
 
-PPU::PPU() : ppuCtrl(0), ppuMask(0), ppuStatus(0), oamAddr(0), ppuScroll(0),
-             ppuAddr(0), ppuData(0), scanline(0), cycle(0), frameReady(false),
-             nmiFlag(false), scrollX(0), scrollY(0) {
+#include <algorithm>
+#include <cstring>
+
+// Paleta RGB do 2C02 (64 cores)
+static const uint8_t NES_PALETTE[64][3] = {
+    { 84,  84,  84}, {  0,  30, 116}, {  8,  16, 144}, { 48,   0, 136},
+    { 68,   0, 100}, { 92,   0,  48}, { 84,   4,   0}, { 60,  24,   0},
+    { 32,  42,   0}, {  8,  58,   0}, {  0,  64,   0}, {  0,  60,   0},
+    {  0,  50,  60}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0},
+    {152, 150, 152}, {  8,  76, 196}, { 48,  50, 236}, { 92,  30, 228},
+    {136,  20, 176}, {160,  20, 100}, {152,  34,  32}, {120,  60,   0},
+    { 84,  90,   0}, { 40, 114,   0}, {  8, 124,   0}, {  0, 118,  40},
+    {  0, 102, 120}, {  0,   0,   0}, {  0,   0,   0}, {  0,   0,   0},
+    {236, 238, 236}, { 76, 154, 236}, {120, 124, 236}, {176,  98, 236},
+    {228,  84, 236}, {236,  88, 180}, {236, 106, 100}, {212, 136,  32},
+    {160, 170,   0}, {116, 196,   0}, { 76, 208,  32}, { 56, 204, 108},
+    { 56, 180, 204}, { 60,  60,  60}, {  0,   0,   0}, {  0,   0,   0},
+    {236, 238, 236}, {168, 204, 236}, {188, 188, 236}, {212, 178, 236},
+    {236, 174, 236}, {236, 174, 212}, {236, 180, 176}, {228, 196, 144},
+    {204, 210, 120}, {180, 222, 120}, {168, 226, 144}, {152, 226, 180},
+    {160, 214, 228}, {160, 162, 160}, {  0,   0,   0}, {  0,   0,   0},
+};
+
+static const uint16_t NO_SPRITE0_HIT = 0xFFFF;
+static const uint64_t NO_MAPPER_EVENT = UINT64_MAX;
+
+// Linhas com buscas de padrão: 0-239 e a pré-render
+static const uint32_t SCANLINE_CLOCKS_PER_FRAME = 241;
+// O MMC3 ignora subidas de A12 depois de menos de ~3 ciclos de M2 em baixo:
+// entre slots de 8 dots da mesma tabela A12 cai por só 3 dots
+static const uint64_t A12_FILTER_DOTS = 9;
+
+// CHR sem cartucho
+static const uint8_t EMPTY_CHR[0x400] = {};
+static const uint8_t* const EMPTY_CHR_PAGES[8] = {
+    EMPTY_CHR, EMPTY_CHR, EMPTY_CHR, EMPTY_CHR,
+    EMPTY_CHR, EMPTY_CHR, EMPTY_CHR, EMPTY_CHR,
+};
+
+// $3F10/$3F14/$3F18/$3F1C espelham as entradas de background
+static inline uint8_t paletteIndex(uint16_t addr) {
+    uint8_t index = addr & 0x1F;
+    if ((index & 0x13) == 0x10) {
+        index &= 0x0F;
+    }
+    return index;
+}
+
+PPU::PPU() : ppuCtrl(0), ppuMask(0), ppuStatus(0), oamAddr(0), ppuData(0),
+             vramAddr(0), tempAddr(0), fineX(0), writeLatch(false),
+             cartridge(nullptr), chrPages(EMPTY_CHR_PAGES), nametablePages(nullptr),
+             frameBuffer(nullptr), scanline(0), cycle(0),
+             dotCount(0), sprite0HitCycle(NO_SPRITE0_HIT), frameReady(false), nmiFlag(false),
+             oddFrame(false), videoEnabled(true), lineSpriteCount(0),
+             a12Mode(A12_NONE), a12ClockCycle(0), a12SyncLine(0), a12SyncCycle(0), a12SyncDot(0),
+             mapperDot(NO_MAPPER_EVENT), a12FallDot(0), a12PrevFallDot(0), a12RiseCount(0), a12RiseNext(0) {
     vram.fill(0);
+    setCartridge(nullptr);
     oam.fill(0);
     palette.fill(0);
-    frameBuffer.fill(0);
+    bgLine.fill(0);
+    rowHashes.fill(0);
+    a12Rises.fill(0);
+    markAllRowsDirty();
+}
+
+int DirtyRows::count() const {
+    int total = 0;
+    for (uint64_t word : bits) {
+        for (; word; word &= word - 1) {
+            total++;
+        }
+    }
+    return total;
+}
+
+DirtyRows PPU::takeDirtyRows() {
+    DirtyRows rows = dirtyRows;
+    dirtyRows = {};
+    return rows;
 }
 
 uint8_t PPU::read(uint16_t addr) {
-    switch (addr) {
-        case 0x2002: return ppuStatus;
+    switch (0x2000 | (addr & 0x7)) {
+        case 0x2002: {
+            uint8_t status = (ppuStatus & 0xE0) | (ppuData & 0x1F);
+            ppuStatus &= ~0x80;
+            writeLatch = false;
+            return status;
+        }
         case 0x2004: return oam[oamAddr];
-        case 0x2007: return ppuData;
+        case 0x2007: {
+            uint16_t vaddr = vramAddr & 0x3FFF;
+            uint8_t value;
+            if (vaddr < 0x3F00) {
+                value = ppuData;
+                ppuData = readVRAM(vaddr);
+            } else {
+                value = readVRAM(vaddr);
+                ppuData = readVRAM(vaddr - 0x1000);
+            }
+            vramAddr = (vramAddr + ((ppuCtrl & 0x04) ? 32 : 1)) & 0x7FFF;
+            return value;
+        }
         default: return 0;
     }
 }
 
 void PPU::write(uint16_t addr, uint8_t value) {
-    switch (addr) {
-        case 0x2000: ppuCtrl = value; break;
+    // Tabelas, tamanho dos sprites e renderização decidem as subidas de A12
+    bool a12Inputs = (addr & 0x6) == 0 && cartridge && cartridge->hasScanlineIRQ();
+    if (a12Inputs) {
+        syncMapperIRQ();
+    }
+    switch (0x2000 | (addr & 0x7)) {
+        case 0x2000: {
+            bool nmiWasEnabled = (ppuCtrl & 0x80) != 0;
+            ppuCtrl = value;
+            tempAddr = (tempAddr & 0xF3FF) | ((value & 0x03) << 10);
+            // Habilitar NMI durante o vblank gera NMI imediatamente
+            if (!nmiWasEnabled && (value & 0x80) && (ppuStatus & 0x80)) {
+                nmiFlag = true;
+            }
+            break;
+        }
         case 0x2001: ppuMask = value; break;
         case 0x2003: oamAddr = value; break;
         case 0x2004: oam[oamAddr++] = value; break;
-        case 0x2005: ppuScroll = value; break;
-        case 0x2006: ppuAddr = value; break;
-        case 0x2007: ppuData = value; break;
+        case 0x2005:
+            if (!writeLatch) {
+                tempAddr = (tempAddr & 0xFFE0) | (value >> 3);
+                fineX = value & 0x07;
+            } else {
+                tempAddr = (tempAddr & 0x8C1F) | ((value & 0x07) << 12) | ((value & 0xF8) << 2);
+            }
+            writeLatch = !writeLatch;
+            break;
+        case 0x2006:
+            if (!writeLatch) {
+                tempAddr = (tempAddr & 0x00FF) | ((value & 0x3F) << 8);
+            } else {
+                tempAddr = (tempAddr & 0xFF00) | value;
+                vramAddr = tempAddr;
+            }
+            writeLatch = !writeLatch;
+            break;
+        case 0x2007:
+            writeVRAM(vramAddr & 0x3FFF, value);
+            vramAddr = (vramAddr + ((ppuCtrl & 0x04) ? 32 : 1)) & 0x7FFF;
+            break;
     }
+    if (a12Inputs) {
+        updateMapperIRQ();
+    }
+}
+
+void PPU::writeOAM(const uint8_t* data) {
+    // Mesmo efeito de 256 escritas em $2004, com a volta em oamAddr
+    size_t first = 0x100 - oamAddr;
+    std::copy(data, data + first, oam.begin() + oamAddr);
+    std::copy(data + first, data + 0x100, oam.begin());
 }
 
 void PPU::step() {
-    renderPixel();
+    if (dotCount == mapperDot) {
+        mapperEvent();
+    }
+    if (scanline < 240) {
+        if (cycle == 1) {
+            if (a12Mode == A12_FETCH) {
+                computeA12Rises();
+            }
+            renderScanline();
+        }
+        if (cycle == sprite0HitCycle) {
+            ppuStatus |= 0x40;
+            sprite0HitCycle = NO_SPRITE0_HIT;
+        }
+        if (renderingEnabled()) {
+            if (cycle == 256) {
+                incrementY();
+            } else if (cycle == 257) {
+                vramAddr = (vramAddr & ~0x041F) | (tempAddr & 0x041F);
+            }
+        }
+    } else if (scanline == 241 && cycle == 1) {
+        // Mantém o contador a menos de um frame da posição sincronizada
+        if (a12Mode == A12_ANALYTIC) {
+            syncMapperIRQ();
+        }
+        ppuStatus |= 0x80;
+        frameReady = true;
+        if (ppuCtrl & 0x80) {
+            nmiFlag = true;
+        }
+    } else if (scanline == 261) {
+        if (cycle == 1) {
+            ppuStatus &= ~0xE0;
+            if (a12Mode == A12_FETCH) {
+                computeA12Rises();
+            }
+        }
+        if (renderingEnabled()) {
+            if (cycle == 257) {
+                vramAddr = (vramAddr & ~0x041F) | (tempAddr & 0x041F);
+            } else if (cycle == 280) {
+                vramAddr = (vramAddr & ~0x7BE0) | (tempAddr & 0x7BE0);
+            } else if (cycle == 339 && oddFrame) {
+                // Frames ímpares pulam o último dot da linha pré-render
+                cycle++;
+            }
+        }
+    }
     
     cycle++;
+    dotCount++;
     if (cycle >= 341) {
         cycle = 0;
         scanline++;
         if (scanline >= 262) {
             scanline = 0;
-            frameReady = true;
-            if (ppuCtrl & 0x80) {
-                nmiFlag = true;
+            oddFrame = !oddFrame;
+        }
+    }
+}
+
+void PPU::run(uint64_t dots) {
+    while (dots > 0) {
+        uint64_t skip = std::min<uint64_t>(dots, nextEventCycle() - cycle);
+        if (skip == 0) {
+            step();
+            dots--;
+            continue;
+        }
+        // Dots sem efeito: só o contador anda
+        cycle += skip;
+        dotCount += skip;
+        dots -= skip;
+        if (cycle >= 341) {
+            cycle = 0;
+            scanline++;
+            if (scanline >= 262) {
+                scanline = 0;
+                oddFrame = !oddFrame;
             }
         }
     }
 }
 
+uint16_t PPU::nextEventCycle() const {
+    // Dots em que step() faz algo além de avançar, na linha atual (341 = fim)
+    uint16_t next = 341;
+    auto consider = [&](uint16_t dot) {
+        if (dot >= cycle && dot < next) {
+            next = dot;
+        }
+    };
+    if (mapperDot - dotCount < 341u - cycle) {
+        consider(static_cast<uint16_t>(cycle + (mapperDot - dotCount)));
+    }
+    if (scanline < 240) {
+        consider(1);
+        consider(sprite0HitCycle);
+        if (renderingEnabled()) {
+            consider(256);
+            consider(257);
+        }
+    } else if (scanline == 241) {
+        consider(1);
+    } else if (scanline == 261) {
+        consider(1);
+        if (renderingEnabled()) {
+            consider(257);
+            consider(280);
+            consider(339);
+        }
+    }
+    return next;
+}
+
 void PPU::reset() {
     ppuCtrl = 0;
     ppuMask = 0;
     ppuStatus = 0;
+    ppuData = 0;
+    vramAddr = 0;
+    tempAddr = 0;
+    fineX = 0;
+    writeLatch = false;
     scanline = 0;
     cycle = 0;
+    dotCount = 0;
+    sprite0HitCycle = NO_SPRITE0_HIT;
     frameReady = false;
     nmiFlag = false;
+    oddFrame = false;
+    lineSpriteCount = 0;
+    a12Mode = A12_NONE;
+    a12SyncLine = 0;
+    a12SyncCycle = 0;
+    a12SyncDot = 0;
+    mapperDot = NO_MAPPER_EVENT;
+    a12FallDot = 0;
+    a12PrevFallDot = 0;
+    a12Rises.fill(0);
+    a12RiseCount = 0;
+    a12RiseNext = 0;
+}
+
+void PPU::saveState(StateWriter& out) const {
+    out.write(ppuCtrl);
+    out.write(ppuMask);
+    out.write(ppuStatus);
+    out.write(oamAddr);
+    out.write(ppuData);
+    out.write(vramAddr);
+    out.write(tempAddr);
+    out.write(fineX);
+    out.write(writeLatch);
+    out.write(vram);
+    out.write(oam);
+    out.write(palette);
+    out.write(scanline);
+    out.write(cycle);
+    out.write(dotCount);
+    out.write(sprite0HitCycle);
+    out.write(frameReady);
+    out.write(nmiFlag);
+    out.write(oddFrame);
+    out.write(a12Mode);
+    out.write(a12ClockCycle);
+    out.write(a12SyncLine);
+    out.write(a12SyncCycle);
+    out.write(a12SyncDot);
+    out.write(mapperDot);
+    out.write(a12FallDot);
+    out.write(a12PrevFallDot);
+    out.write(a12Rises);
+    out.write(a12RiseCount);
+    out.write(a12RiseNext);
+}
+
+void PPU::loadState(StateReader& in) {
+    in.read(ppuCtrl);
+    in.read(ppuMask);
+    in.read(ppuStatus);
+    in.read(oamAddr);
+    in.read(ppuData);
+    in.read(vramAddr);
+    in.read(tempAddr);
+    in.read(fineX);
+    in.read(writeLatch);
+    in.read(vram);
+    in.read(oam);
+    in.read(palette);
+    in.readBounded<uint16_t>(scanline, 261);
+    in.readBounded<uint16_t>(cycle, 340);
+    in.read(dotCount);
+    in.read(sprite0HitCycle);
+    if (sprite0HitCycle > 340 && sprite0HitCycle != NO_SPRITE0_HIT) {
+        in.invalidate();
+        sprite0HitCycle = NO_SPRITE0_HIT;
+    }
+    in.read(frameReady);
+    in.read(nmiFlag);
+    in.read(oddFrame);
+    in.readBounded<uint8_t>(a12Mode, A12_FETCH);
+    in.readBounded<uint16_t>(a12ClockCycle, 340);
+    in.readBounded<uint16_t>(a12SyncLine, 261);
+    in.readBounded<uint16_t>(a12SyncCycle, 341);
+    in.read(a12SyncDot);
+    in.read(mapperDot);
+    in.read(a12FallDot);
+    in.read(a12PrevFallDot);
+    in.read(a12Rises);
+    in.readBounded<uint8_t>(a12RiseCount, static_cast<uint8_t>(a12Rises.size()));
+    in.readBounded<uint8_t>(a12RiseNext, a12RiseCount);
+    lineSpriteCount = 0;
+}
+
+void PPU::setCartridge(Cartridge* cartridge) {
+    this->cartridge = cartridge;
+    if (cartridge) {
+        cartridge->setCIRAM(vram.data());
+        chrPages = cartridge->getCHRPages();
+        nametablePages = cartridge->getNametablePages();
+    } else {
+        ciramPages = {vram.data(), vram.data(), vram.data() + 0x400, vram.data() + 0x400};
+        chrPages = EMPTY_CHR_PAGES;
+        nametablePages = ciramPages.data();
+    }
+}
+
+uint32_t PPU::scanlineClockIndex(uint16_t line, uint16_t dot) const {
+    // Clocks do frame já passados na posição (line, dot)
+    if (line < 240) {
+        return line + (dot > a12ClockCycle ? 1 : 0);
+    }
+    if (line < 261) {
+        return 240;
+    }
+    return 240 + (dot > a12ClockCycle ? 1 : 0);
+}
+
+void PPU::syncMapperIRQ() {
+    if (a12Mode == A12_ANALYTIC && dotCount != a12SyncDot) {
+        // Menos de um frame desde a última sincronização (vblank)
+        uint32_t from = scanlineClockIndex(a12SyncLine, a12SyncCycle);
+        uint32_t to = scanlineClockIndex(scanline, cycle);
+        bool wrapped = scanline < a12SyncLine || (scanline == a12SyncLine && cycle <= a12SyncCycle);
+        cartridge->advanceScanlineCounter(wrapped ? SCANLINE_CLOCKS_PER_FRAME - from + to : to - from);
+    }
+    // No modo por busca os clocks já foram aplicados um a um
+    a12SyncLine = scanline;
+    a12SyncCycle = cycle;
+    a12SyncDot = dotCount;
+}
+
+uint64_t PPU::scanlineClockDot(uint32_t clocks) const {
+    // dotCount do clocks-ésimo clock depois da posição sincronizada
+    uint64_t dot = a12SyncDot;
+    uint32_t position = a12SyncLine * 341u + a12SyncCycle;
+    uint32_t index = scanlineClockIndex(a12SyncLine, a12SyncCycle);
+    bool odd = oddFrame;
+    while (clocks > SCANLINE_CLOCKS_PER_FRAME - index) {
+        clocks -= SCANLINE_CLOCKS_PER_FRAME - index;
+        dot += 262u * 341u - (odd ? 1u : 0u) - position;
+        position = 0;
+        index = 0;
+        odd = !odd;
+    }
+    uint32_t line = index + clocks - 1;
+    return dot + (line < 240 ? line : 261u) * 341u + a12ClockCycle - position;
+}
+
+void PPU::scheduleScanlineIRQ() {
+    uint32_t clocks = cartridge->scanlineClocksUntilIRQ();
+    mapperDot = clocks == UINT32_MAX ? NO_MAPPER_EVENT : scanlineClockDot(clocks);
+}
+
+void PPU::updateMapperIRQ() {
+    syncMapperIRQ();
+    uint8_t previous = a12Mode;
+    a12Mode = A12_NONE;
+    mapperDot = NO_MAPPER_EVENT;
+    if (!cartridge || !cartridge->hasScanlineIRQ() || !renderingEnabled()) {
+        return;
+    }
+    
+    bool bgHigh = (ppuCtrl & 0x10) != 0;
+    bool spritesHigh = (ppuCtrl & 0x08) != 0;
+    if (!(ppuCtrl & 0x20) && bgHigh != spritesHigh) {
+        // Sprites em $1000: subida nas buscas de sprite (dot 257 + 3);
+        // BG em $1000: nas buscas da próxima linha (dot 321 + 3)
+        a12Mode = A12_ANALYTIC;
+        a12ClockCycle = spritesHigh ? 260 : 324;
+        scheduleScanlineIRQ();
+        return;
+    }
+    
+    a12Mode = A12_FETCH;
+    if (previous != A12_FETCH) {
+        // Sem histórico: renderizando, A12 acabou de cair; parado, está baixo
+        a12FallDot = previous == A12_ANALYTIC ? dotCount : 0;
+        a12PrevFallDot = a12FallDot;
+    }
+    a12RiseCount = 0;
+    a12RiseNext = 0;
+    if (cycle >= 1 && (scanline < 240 || scanline == 261)) {
+        computeA12Rises();
+    }
+}
+
+void PPU::computeA12Rises() {
+    // Cada busca de padrão fica em um slot de 8 dots (d0..d0+7) com A12 em
+    // alto de d0+3 a d0+7: 32 de BG, 8 de sprites (257-320), 2 de BG da
+    // próxima linha (321-336)
+    uint64_t lineStart = dotCount - cycle;
+    if (a12FallDot <= lineStart) {
+        // Primeiro cálculo desta linha (recálculos no meio dela partem da
+        // mesma descida)
+        a12PrevFallDot = a12FallDot;
+    }
+    uint64_t fall = a12PrevFallDot;
+    
+    bool bgHigh = (ppuCtrl & 0x10) != 0;
+    uint8_t spritesHigh = (ppuCtrl & 0x08) ? 0xFF : 0x00;
+    if (ppuCtrl & 0x20) {
+        // 8x16: a tabela vem do tile de cada sprite da próxima linha; slots
+        // vazios buscam o tile $FF ($1000)
+        spritesHigh = 0xFF;
+        int count = 0;
+        for (int i = 0; i < 64 && count < 8 && scanline < 240; i++) {
+            int row = scanline - oam[i * 4];
+            if (row >= 0 && row < 16) {
+                if (!(oam[i * 4 + 1] & 0x01)) {
+                    spritesHigh &= ~(1 << count);
+                }
+                count++;
+            }
+        }
+    }
+    
+    a12RiseCount = 0;
+    a12RiseNext = 0;
+    auto slot = [&](uint16_t d0, bool high) {
+        if (!high) {
+            return;
+        }
+        uint16_t rise = d0 + 3;
+        if (rise >= cycle && lineStart + rise >= fall + A12_FILTER_DOTS && a12RiseCount < a12Rises.size()) {
+            a12Rises[a12RiseCount++] = rise;
+        }
+        fall = lineStart + d0 + 8;
+    };
+    for (uint16_t d0 = 1; d0 < 257; d0 += 8) {
+        slot(d0, bgHigh);
+    }
+    for (int s = 0; s < 8; s++) {
+        slot(static_cast<uint16_t>(257 + s * 8), (spritesHigh >> s) & 1);
+    }
+    slot(321, bgHigh);
+    slot(329, bgHigh);
+    a12FallDot = fall;
+    
+    mapperDot = a12RiseCount ? lineStart + a12Rises[0] : NO_MAPPER_EVENT;
+}
+
+void PPU::mapperEvent() {
+    if (a12Mode == A12_ANALYTIC) {
+        // Os clocks até aqui não levantam IRQ; o deste dot pode levantar
+        syncMapperIRQ();
+        cartridge->clockScanlineCounter();
+        a12SyncCycle = cycle + 1;
+        a12SyncDot = dotCount + 1;
+        scheduleScanlineIRQ();
+        return;
+    }
+    cartridge->clockScanlineCounter();
+    a12RiseNext++;
+    mapperDot = a12RiseNext < a12RiseCount ? dotCount - cycle + a12Rises[a12RiseNext] : NO_MAPPER_EVENT;
+}
+
+uint32_t PPU::dotsUntilMapperEvent() const {
+    if (a12Mode == A12_NONE) {
+        return UINT32_MAX;
+    }
+    uint64_t until = mapperDot == NO_MAPPER_EVENT ? UINT64_MAX : mapperDot - dotCount + 1;
+    if (a12Mode == A12_FETCH) {
+        // As subidas da próxima linha só são conhecidas no dot 1 dela
+        until = std::min<uint64_t>(until, 342u - cycle);
+    }
+    return until > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(until);
+}
+
+uint8_t PPU::readVRAM(uint16_t addr) {
+    if (addr < 0x2000) {
+        return chrPages[addr >> 10][addr & 0x3FF];
+    } else if (addr < 0x3F00) {
+        return nametablePages[(addr >> 10) & 0x03][addr & 0x3FF];
+    }
+    return palette[paletteIndex(addr)];
+}
+
+void PPU::writeVRAM(uint16_t addr, uint8_t value) {
+    if (addr < 0x2000) {
+        if (cartridge) {
+            cartridge->writeCHR(addr, value);
+        }
+    } else if (addr < 0x3F00) {
+        nametablePages[(addr >> 10) & 0x03][addr & 0x3FF] = value;
+    } else {
+        palette[paletteIndex(addr)] = value & 0x3F;
+    }
+}
+
+void PPU::renderScanline() {
+    sprite0HitCycle = NO_SPRITE0_HIT;
+    bool draw = videoEnabled && frameBuffer != nullptr;
+    
+    if (!renderingEnabled()) {
+        lineSpriteCount = 0;
+        if (draw) {
+            bgLine.fill(0);
+            composeLine();
+        }
+        return;
+    }
+    
+    evaluateSprites(draw);
+    
+    if (draw) {
+        renderBackground(0, 256);
+        checkSprite0Hit();
+        composeLine();
+    } else if (lineSpriteCount > 0 && lineSprites[0].index == 0) {
+        // Headless: só os 8 pixels sob o sprite 0 importam
+        int x0 = lineSprites[0].x;
+        renderBackground(x0, std::min(x0 + 8, 256));
+        checkSprite0Hit();
+    }
+}
+
+void PPU::evaluateSprites(bool fetchAll) {
+    int height = (ppuCtrl & 0x20) ? 16 : 8;
+    lineSpriteCount = 0;
+    
+    for (int i = 0; i < 64; i++) {
+        // Sprites aparecem uma linha abaixo da coordenada Y da OAM
+        int row = scanline - oam[i * 4] - 1;
+        if (row < 0 || row >= height) {
+            continue;
+        }
+        if (lineSpriteCount == 8) {
+            ppuStatus |= 0x20;
+            break;
+        }
+        
+        LineSprite& sprite = lineSprites[lineSpriteCount++];
+        sprite.index = i;
+        sprite.attr = oam[i * 4 + 2];
+        sprite.x = oam[i * 4 + 3];
+        sprite.patternLo = 0;
+        sprite.patternHi = 0;
+        if (!fetchAll && i != 0) {
+            continue;
+        }
+        
+        uint8_t tile = oam[i * 4 + 1];
+        uint16_t base;
+        if (height == 16) {
+            base = (tile & 0x01) ? 0x1000 : 0x0000;
+            tile &= 0xFE;
+            if (sprite.attr & 0x80) row = 15 - row;
+            if (row > 7) {
+                tile++;
+                row -= 8;
+            }
+        } else {
+            base = (ppuCtrl & 0x08) ? 0x1000 : 0x0000;
+            if (sprite.attr & 0x80) row = 7 - row;
+        }
+        uint16_t addr = base + tile * 16 + row;
+        const uint8_t* pattern = chrPages[addr >> 10] + (addr & 0x3FF);
+        sprite.patternLo = pattern[0];
+        sprite.patternHi = pattern[8];
+    }
 }
 
-void PPU::renderPixel() {
-    if (scanline < 240 && cycle < 256) {
-        renderBackground();
-        renderSprites();
+void PPU::renderBackground(int x0, int x1) {
+    if (!(ppuMask & 0x08)) {
+        std::fill(bgLine.begin() + x0, bgLine.begin() + x1, 0);
+        return;
+    }
+    
+    uint16_t v = vramAddr;
+    uint16_t patternBase = (ppuCtrl & 0x10) ? 0x1000 : 0x0000;
+    int fineY = (v >> 12) & 0x07;
+    int coarseY = (v >> 5) & 0x1F;
+    int firstTile = (x0 + fineX) >> 3;
+    int lastTile = (x1 - 1 + fineX) >> 3;
+    
+    for (int k = firstTile; k <= lastTile; k++) {
+        int coarseX = (v & 0x1F) + k;
+        const uint8_t* nametable = nametablePages[((v >> 10) & 0x02) | (((v >> 10) ^ (coarseX >> 5)) & 0x01)];
+        coarseX &= 0x1F;
+        
+        uint8_t tile = nametable[(coarseY << 5) | coarseX];
+        uint8_t attr = nametable[0x3C0 | ((coarseY >> 2) << 3) | (coarseX >> 2)];
+        uint8_t pal = (attr >> (((coarseY & 0x02) << 1) | (coarseX & 0x02))) & 0x03;
+        uint16_t patternAddr = patternBase + tile * 16 + fineY;
+        const uint8_t* pattern = chrPages[patternAddr >> 10] + (patternAddr & 0x3FF);
+        uint8_t lo = pattern[0];
+        uint8_t hi = pattern[8];
+        
+        for (int bit = 0; bit < 8; bit++) {
+            int x = k * 8 + bit - fineX;
+            if (x < x0 || x >= x1) {
+                continue;
+            }
+            uint8_t pixel = ((lo >> (7 - bit)) & 0x01) | (((hi >> (7 - bit)) & 0x01) << 1);
+            bgLine[x] = pixel ? ((pal << 2) | pixel) : 0;
+        }
+    }
+    
+    // Máscara das 8 colunas da esquerda
+    if (!(ppuMask & 0x02)) {
+        for (int x = x0; x < std::min(x1, 8); x++) {
+            bgLine[x] = 0;
+        }
     }
 }
 
-void PPU::renderBackground() {
-    // Implementação básica
+uint8_t PPU::spritePixel(const LineSprite& sprite, int x) const {
+    int dx = x - sprite.x;
+    if (dx < 0 || dx > 7) {
+        return 0;
+    }
+    int bit = (sprite.attr & 0x40) ? dx : 7 - dx;
+    return ((sprite.patternLo >> bit) & 0x01) | (((sprite.patternHi >> bit) & 0x01) << 1);
 }
 
-void PPU::renderSprites() {
-    // Implementação básica
+void PPU::checkSprite0Hit() {
+    if (lineSpriteCount == 0 || lineSprites[0].index != 0) return;
+    if ((ppuMask & 0x18) != 0x18 || (ppuStatus & 0x40)) return;
+    
+    const LineSprite& sprite = lineSprites[0];
+    bool leftClipped = (ppuMask & 0x06) != 0x06;
+    for (int x = sprite.x; x < sprite.x + 8 && x < 255; x++) {
+        if (x < 8 && leftClipped) {
+            continue;
+        }
+        if (bgLine[x] && spritePixel(sprite, x)) {
+            sprite0HitCycle = x + 1;
+            return;
+        }
+    }
+}
+
+void PPU::composeLine() {
+    // Sprites em ordem reversa: o de menor índice na OAM fica por cima
+    std::array<uint8_t, 256> spriteLine;
+    spriteLine.fill(0);
+    if (ppuMask & 0x10) {
+        for (int i = lineSpriteCount - 1; i >= 0; i--) {
+            const LineSprite& sprite = lineSprites[i];
+            for (int x = sprite.x; x < sprite.x + 8 && x < 256; x++) {
+                uint8_t pixel = spritePixel(sprite, x);
+                if (pixel) {
+                    spriteLine[x] = 0x10 | ((sprite.attr & 0x03) << 2) | pixel |
+                                    ((sprite.attr & 0x20) ? 0x80 : 0x00);
+                }
+            }
+        }
+        if (!(ppuMask & 0x04)) {
+            std::fill(spriteLine.begin(), spriteLine.begin() + 8, 0);
+        }
+    }
+    
+    std::array<uint8_t, 256> colors;
+    for (int x = 0; x < 256; x++) {
+        uint8_t bg = bgLine[x];
+        uint8_t sprite = spriteLine[x];
+        uint8_t index = bg;
+        if (sprite && (!bg || !(sprite & 0x80))) {
+            index = sprite & 0x1F;
+        }
+        colors[x] = getPaletteColor(index);
+    }
+    
+    // Hash das cores da linha, 8 pixels por passo
+    uint64_t hash = 0;
+    for (int x = 0; x < 256; x += 8) {
+        uint64_t word;
+        std::memcpy(&word, colors.data() + x, sizeof(word));
+        hash = ((hash << 5) | (hash >> 59)) ^ word;
+        hash *= 0x9E3779B97F4A7C15ull;
+    }
+    uint32_t rowHash = static_cast<uint32_t>(hash ^ (hash >> 32));
+    if (rowHash != rowHashes[scanline]) {
+        rowHashes[scanline] = rowHash;
+        dirtyRows.bits[scanline >> 6] |= 1ull << (scanline & 63);
+    }
+    
+    uint8_t* out = frameBuffer + scanline * 256 * 3;
+    for (int x = 0; x < 256; x++) {
+        const uint8_t* rgb = NES_PALETTE[colors[x]];
+        out[0] = rgb[0];
+        out[1] = rgb[1];
+        out[2] = rgb[2];
+        out += 3;
+    }
+}
+
+void PPU::incrementY() {
+    if ((vramAddr & 0x7000) != 0x7000) {
+        vramAddr += 0x1000;
+        return;
+    }
+    vramAddr &= ~0x7000;
+    int y = (vramAddr & 0x03E0) >> 5;
+    if (y == 29) {
+        y = 0;
+        vramAddr ^= 0x0800;
+    } else if (y == 31) {
+        y = 0;
+    } else {
+        y++;
+    }
+    vramAddr = (vramAddr & ~0x03E0) | (y << 5);
 }
 
 uint8_t PPU::getPaletteColor(uint8_t index) {
-    return palette[index & 0x1F];
+    uint8_t color = palette[(index & 0x03) ? (index & 0x1F) : 0];
+    if (ppuMask & 0x01) {
+        color &= 0x30;  // Escala de cinza
+    }
+    return color & 0x3F;
 }
@@ -0,0 +1,105 @@
+#include "profiler.h"
+#include "cartridge.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const uint8_t PROFILE_MAGIC[4] = {'N', 'E', 'S', 'P'};
+static const uint32_t PROFILE_VERSION = 1;
+
+Profiler::Profiler() : cartridge(nullptr) {
+    reset();
+}
+
+void Profiler::attach(const Cartridge* cartridge) {
+    this->cartridge = cartridge;
+    size_t size = LOW_PCS + (cartridge ? cartridge->getPRGSize() : 0);
+    pcCounts.assign(size, 0);
+    pcCycles.assign(size, 0);
+    reset();
+}
+
+void Profiler::reset() {
+    std::memset(opcodeCounts, 0, sizeof(opcodeCounts));
+    std::memset(opcodeCycles, 0, sizeof(opcodeCycles));
+    std::memset(pageAccesses, 0, sizeof(pageAccesses));
+    std::memset(ppuRegisterHits, 0, sizeof(ppuRegisterHits));
+    std::memset(apuRegisterHits, 0, sizeof(apuRegisterHits));
+    std::fill(pcCounts.begin(), pcCounts.end(), 0);
+    std::fill(pcCycles.begin(), pcCycles.end(), 0);
+}
+
+size_t Profiler::pcIndex(uint16_t pc) const {
+    if (pc < LOW_PCS) {
+        return pc;
+    }
+    // Offset na PRG ROM pelo banco mapeado agora
+    return cartridge ? LOW_PCS + cartridge->getPRGOffset(pc) : SIZE_MAX;
+}
+
+bool Profiler::writeBinary(FILE* file) const {
+    uint32_t header[4] = {
+        PROFILE_VERSION, 256, static_cast<uint32_t>(pcCounts.size()), 256
+    };
+    bool ok = fwrite(PROFILE_MAGIC, 1, 4, file) == 4 &&
+              fwrite(header, sizeof(header), 1, file) == 1 &&
+              fwrite(opcodeCounts, sizeof(opcodeCounts), 1, file) == 1 &&
+              fwrite(opcodeCycles, sizeof(opcodeCycles), 1, file) == 1 &&
+              fwrite(pageAccesses, sizeof(pageAccesses), 1, file) == 1 &&
+              fwrite(ppuRegisterHits, sizeof(ppuRegisterHits), 1, file) == 1 &&
+              fwrite(apuRegisterHits, sizeof(apuRegisterHits), 1, file) == 1;
+    if (ok && !pcCounts.empty()) {
+        ok = fwrite(pcCounts.data(), sizeof(uint64_t), pcCounts.size(), file) == pcCounts.size() &&
+             fwrite(pcCycles.data(), sizeof(uint64_t), pcCycles.size(), file) == pcCycles.size();
+    }
+    return ok;
+}
+
+bool Profiler::writeCSV(FILE* file) const {
+    bool ok = fprintf(file, "secao,banco,endereco,contagem,ciclos\n") > 0;
+    
+    for (int op = 0; op < 256 && ok; op++) {
+        if (opcodeCounts[op]) {
+            ok = fprintf(file, "opcode,-1,$%02X,%llu,%llu\n", op,
+                         static_cast<unsigned long long>(opcodeCounts[op]),
+                         static_cast<unsigned long long>(opcodeCycles[op])) > 0;
+        }
+    }
+    for (size_t i = 0; i < pcCounts.size() && ok; i++) {
+        if (!pcCounts[i]) {
+            continue;
+        }
+        long bank = -1;
+        size_t addr = i;
+        if (i >= LOW_PCS) {
+            bank = static_cast<long>((i - LOW_PCS) / 0x2000);
+            addr = (i - LOW_PCS) % 0x2000;
+        }
+        ok = fprintf(file, "pc,%ld,$%04zX,%llu,%llu\n", bank, addr,
+                     static_cast<unsigned long long>(pcCounts[i]),
+                     static_cast<unsigned long long>(pcCycles[i])) > 0;
+    }
+    
+    static const char* const ACCESS[2] = {"leitura", "escrita"};
+    for (int w = 0; w < 2 && ok; w++) {
+        for (int page = 0; page < 256 && ok; page++) {
+            if (pageAccesses[w][page]) {
+                ok = fprintf(file, "pagina_%s,-1,$%02X00,%llu,0\n", ACCESS[w], page,
+                             static_cast<unsigned long long>(pageAccesses[w][page])) > 0;
+            }
+        }
+        for (int reg = 0; reg < 8 && ok; reg++) {
+            if (ppuRegisterHits[w][reg]) {
+                ok = fprintf(file, "ppu_%s,-1,$%04X,%llu,0\n", ACCESS[w], 0x2000 + reg,
+                             static_cast<unsigned long long>(ppuRegisterHits[w][reg])) > 0;
+            }
+        }
+        for (int reg = 0; reg < 32 && ok; reg++) {
+            if (apuRegisterHits[w][reg]) {
+                ok = fprintf(file, "apu_%s,-1,$%04X,%llu,0\n", ACCESS[w], 0x4000 + reg,
+                             static_cast<unsigned long long>(apuRegisterHits[w][reg])) > 0;
+            }
+        }
+    }
+    return ok;
+}
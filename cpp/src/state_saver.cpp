@@ -0,0 +1,437 @@
+#include "state_saver.h"
+#include "console.h"
+#include "ppu.h"
+#include "thumbnail.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static const uint8_t FILE_MAGIC[4] = {'N', 'E', 'S', 'Z'};
+static const uint8_t FILE_VERSION = 1;
+static const uint8_t STATE_FILE_THUMBNAIL = 1 << 0;
+static const size_t HEADER_SIZE = 32;
+// Save states reais têm dezenas de KB (RAM, VRAM, CHR RAM, PRG RAM); o
+// limite só protege a alocação de cabeçalhos corrompidos
+static const size_t MAX_STATE_SIZE = 1 << 20;
+
+// Limites do formato de bloco do LZ4
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5;   // Últimos bytes sempre literais
+static const size_t MATCH_LIMIT = 12;    // Nenhum match começa depois de size - 12
+static const int HASH_BITS = 12;
+// Cada byte comprimido gera no máximo 255 bytes (extensão de comprimento)
+static const size_t MAX_EXPANSION = 255;
+
+static uint32_t load32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Tamanho de match a partir de a e b: 8 bytes por vez até a diferença
+static size_t matchLength(const uint8_t* a, const uint8_t* b, const uint8_t* end) {
+    const uint8_t* start = a;
+    while (a + 8 <= end && load64(a) == load64(b)) {
+        a += 8;
+        b += 8;
+    }
+    while (a < end && *a == *b) {
+        a++;
+        b++;
+    }
+    return static_cast<size_t>(a - start);
+}
+
+static uint8_t* writeLength(uint8_t* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+static uint8_t* writeSequence(uint8_t* op, const uint8_t* literals, size_t literalLength,
+                              size_t offset, size_t matchLength) {
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+    if (literalLength >= 15) {
+        op = writeLength(op, literalLength - 15);
+    }
+    std::memcpy(op, literals, literalLength);
+    op += literalLength;
+    if (matchLength == 0) {
+        return op;  // Última sequência: só literais
+    }
+    *op++ = static_cast<uint8_t>(offset);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    size_t extra = matchLength - MIN_MATCH;
+    *token |= static_cast<uint8_t>(extra < 15 ? extra : 15);
+    if (extra >= 15) {
+        op = writeLength(op, extra - 15);
+    }
+    return op;
+}
+
+size_t StateSaver::compress(const uint8_t* src, size_t size, uint8_t* out, size_t capacity) {
+    if (capacity < maxCompressedSize(size)) {
+        return 0;
+    }
+    // Posição + 1 da última ocorrência de cada hash de 4 bytes (0 = nenhuma)
+    uint32_t table[1 << HASH_BITS];
+    std::memset(table, 0, sizeof(table));
+    
+    uint8_t* op = out;
+    size_t anchor = 0;
+    size_t pos = 0;
+    if (size > MATCH_LIMIT) {
+        size_t limit = size - MATCH_LIMIT;
+        const uint8_t* matchEnd = src + size - LAST_LITERALS;
+        while (pos <= limit) {
+            uint32_t sequence = load32(src + pos);
+            uint32_t& entry = table[hashSequence(sequence)];
+            size_t candidate = entry;
+            entry = static_cast<uint32_t>(pos + 1);
+            if (candidate == 0 || pos - (candidate - 1) > 0xFFFF || load32(src + candidate - 1) != sequence) {
+                // Trechos sem match avançam cada vez mais rápido
+                pos += 1 + ((pos - anchor) >> 6);
+                continue;
+            }
+            candidate--;
+            while (pos > anchor && candidate > 0 && src[pos - 1] == src[candidate - 1]) {
+                pos--;
+                candidate--;
+            }
+            size_t length = MIN_MATCH + matchLength(src + pos + MIN_MATCH, src + candidate + MIN_MATCH, matchEnd);
+            op = writeSequence(op, src + anchor, pos - anchor, pos - candidate, length);
+            pos += length;
+            anchor = pos;
+            if (pos <= limit) {
+                table[hashSequence(load32(src + pos - 2))] = static_cast<uint32_t>(pos - 2 + 1);
+            }
+        }
+    }
+    op = writeSequence(op, src + anchor, size - anchor, 0, 0);
+    return static_cast<size_t>(op - out);
+}
+
+static bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip >= end) {
+            return false;
+        }
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool StateSaver::decompress(const uint8_t* src, size_t srcSize, uint8_t* out, size_t size) {
+    const uint8_t* ip = src;
+    const uint8_t* end = src + srcSize;
+    size_t op = 0;
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(ip, end, literals)) {
+            return false;
+        }
+        if (literals > static_cast<size_t>(end - ip) || literals > size - op) {
+            return false;
+        }
+        std::memcpy(out + op, ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == end) {
+            break;
+        }
+        
+        if (end - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t length = token & 15;
+        if (length == 15 && !readLength(ip, end, length)) {
+            return false;
+        }
+        length += MIN_MATCH;
+        if (offset == 0 || offset > op || length > size - op) {
+            return false;
+        }
+        // Offsets curtos repetem o que acabou de ser escrito: cada cópia
+        // dobra o trecho periódico disponível (runs de zeros, offset 1)
+        const uint8_t* match = out + op - offset;
+        uint8_t* dst = out + op;
+        size_t remaining = length;
+        while (remaining > 0) {
+            size_t chunk = std::min(remaining, static_cast<size_t>(dst - match));
+            std::memcpy(dst, match, chunk);
+            dst += chunk;
+            remaining -= chunk;
+        }
+        op += length;
+    }
+    return op == size;
+}
+
+StateSaver::StateSaver()
+    : completion(nullptr), completionUser(nullptr), submitted(0), completed(0), dropped(0),
+      stopping(false) {
+    for (int i = 0; i < SLOTS; i++) {
+        slots[i].stateSize = 0;
+        slots[i].ticket = 0;
+        slots[i].romHash = 0;
+        slots[i].thumbnail = false;
+        slots[i].path[0] = '\0';
+        freeSlots.push(static_cast<uint8_t>(i));
+    }
+    worker = std::thread(&StateSaver::run, this);
+}
+
+StateSaver::~StateSaver() {
+    stopping.store(true, std::memory_order_release);
+    wake();
+    worker.join();
+}
+
+void StateSaver::setCompletion(Completion callback, void* user) {
+    completion = callback;
+    completionUser = user;
+}
+
+uint64_t StateSaver::save(const Console& console, const char* path, bool withThumbnail) {
+    size_t pathLength = path ? std::strlen(path) : 0;
+    if (pathLength == 0 || pathLength + sizeof(".tmp") > MAX_PATH_LENGTH) {
+        return 0;
+    }
+    uint8_t index;
+    if (!freeSlots.pop(index)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    Slot& slot = slots[index];
+    
+    // Sem buffer o StateWriter só conta bytes, então o slot vazio é tratado à parte
+    slot.stateSize = slot.state.empty() ? 0 : console.saveState(slot.state.data(), slot.state.size());
+    if (slot.stateSize == 0) {
+        // Primeiro uso do slot (ou outra ROM): cresce e serializa de novo
+        slot.state.resize(console.getStateSize());
+        slot.stateSize = console.saveState(slot.state.data(), slot.state.size());
+    }
+    const uint8_t* frame = console.getFrameBuffer();
+    slot.thumbnail = withThumbnail && frame;
+    if (slot.thumbnail) {
+        slot.frame.resize(PPU::FRAME_BUFFER_SIZE);
+        std::memcpy(slot.frame.data(), frame, PPU::FRAME_BUFFER_SIZE);
+    }
+    slot.romHash = console.getROMHash();
+    std::memcpy(slot.path, path, pathLength + 1);
+    
+    uint64_t ticket = submitted.load(std::memory_order_relaxed) + 1;
+    slot.ticket = ticket;
+    submitted.store(ticket, std::memory_order_release);
+    readySlots.push(index);
+    wake();
+    return ticket;
+}
+
+void StateSaver::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] {
+        return completed.load(std::memory_order_acquire) == submitted.load(std::memory_order_acquire);
+    });
+}
+
+size_t StateSaver::getPending() const {
+    return static_cast<size_t>(submitted.load(std::memory_order_acquire) -
+                               completed.load(std::memory_order_acquire));
+}
+
+void StateSaver::wake() {
+    // Passar pelo mutex evita perder a notificação entre o teste e o wait
+    { std::lock_guard<std::mutex> lock(mutex); }
+    workReady.notify_one();
+}
+
+void StateSaver::run() {
+#if defined(__linux__)
+    // SCHED_BATCH não preempta quem acordou a thread: o wake() de save()
+    // volta na hora em vez de ceder o núcleo para a compressão
+    sched_param param = {};
+    pthread_setschedparam(pthread_self(), SCHED_BATCH, &param);
+#endif
+    for (;;) {
+        uint8_t index;
+        if (readySlots.pop(index)) {
+            const Slot& slot = slots[index];
+            bool ok = write(slot);
+            uint64_t ticket = slot.ticket;
+            freeSlots.push(index);
+            if (completion) {
+                completion(completionUser, ticket, ok);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                completed.fetch_add(1, std::memory_order_release);
+            }
+            idle.notify_all();
+            continue;
+        }
+        // Só encerra com a fila vazia: o que foi aceito é gravado
+        if (stopping.load(std::memory_order_acquire)) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        workReady.wait(lock, [this] {
+            return stopping.load(std::memory_order_acquire) || !readySlots.empty();
+        });
+    }
+}
+
+template <typename T>
+static void storeLE(uint8_t* p, T value) {
+    for (size_t i = 0; i < sizeof(T); i++) {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+template <typename T>
+static T loadLE(const uint8_t* p) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        value |= static_cast<T>(p[i]) << (8 * i);
+    }
+    return value;
+}
+
+bool StateSaver::write(const Slot& slot) {
+    if (slot.stateSize == 0) {
+        return false;
+    }
+    size_t thumbnailCapacity = slot.thumbnail
+        ? thumbnailMaxSize(THUMBNAIL_PNG, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT) : 0;
+    output.resize(HEADER_SIZE + maxCompressedSize(slot.stateSize) + thumbnailCapacity);
+    
+    uint8_t* body = output.data() + HEADER_SIZE;
+    size_t compressedSize = compress(slot.state.data(), slot.stateSize, body,
+                                     maxCompressedSize(slot.stateSize));
+    size_t thumbnailSize = 0;
+    if (slot.thumbnail) {
+        thumbnailSize = encodeThumbnail(slot.frame.data(), THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT,
+                                        THUMBNAIL_PNG, body + compressedSize, thumbnailCapacity);
+    }
+    
+    uint8_t* header = output.data();
+    std::memcpy(header, FILE_MAGIC, 4);
+    header[4] = FILE_VERSION;
+    header[5] = thumbnailSize ? STATE_FILE_THUMBNAIL : 0;
+    storeLE<uint16_t>(header + 6, 0);
+    storeLE<uint64_t>(header + 8, slot.romHash);
+    storeLE<uint32_t>(header + 16, static_cast<uint32_t>(slot.stateSize));
+    storeLE<uint32_t>(header + 20, static_cast<uint32_t>(compressedSize));
+    storeLE<uint32_t>(header + 24, static_cast<uint32_t>(thumbnailSize));
+    storeLE<uint32_t>(header + 28, fnv1a(slot.state.data(), slot.stateSize));
+    size_t total = HEADER_SIZE + compressedSize + thumbnailSize;
+    
+    // Escreve ao lado e troca: o destino é o arquivo antigo ou o novo inteiro
+    char temporary[MAX_PATH_LENGTH];
+    size_t pathLength = std::strlen(slot.path);
+    std::memcpy(temporary, slot.path, pathLength);
+    std::memcpy(temporary + pathLength, ".tmp", sizeof(".tmp"));
+    FILE* file = std::fopen(temporary, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(output.data(), 1, total, file) == total && std::fflush(file) == 0;
+#if defined(_WIN32)
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = std::fclose(file) == 0 && ok;
+#if defined(_WIN32)
+    // rename não substitui um arquivo existente no Windows
+    if (ok) {
+        std::remove(slot.path);
+    }
+#endif
+    if (!ok || std::rename(temporary, slot.path) != 0) {
+        std::remove(temporary);
+        return false;
+    }
+    return true;
+}
+
+bool StateSaver::readFile(const char* path, std::vector<uint8_t>& state, std::vector<uint8_t>* thumbnail) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[16384];
+    size_t count;
+    while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + count);
+    }
+    std::fclose(file);
+    
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), FILE_MAGIC, 4) != 0 ||
+        data[4] != FILE_VERSION) {
+        return false;
+    }
+    size_t stateSize = loadLE<uint32_t>(&data[16]);
+    size_t compressedSize = loadLE<uint32_t>(&data[20]);
+    size_t thumbnailSize = loadLE<uint32_t>(&data[24]);
+    uint32_t checksum = loadLE<uint32_t>(&data[28]);
+    if (compressedSize > data.size() - HEADER_SIZE ||
+        thumbnailSize != data.size() - HEADER_SIZE - compressedSize) {
+        return false;
+    }
+    // Tamanho validado antes de alocar
+    if (stateSize > MAX_STATE_SIZE || stateSize > compressedSize * MAX_EXPANSION) {
+        return false;
+    }
+    
+    std::vector<uint8_t> decoded(stateSize);
+    if (!decompress(&data[HEADER_SIZE], compressedSize, decoded.data(), stateSize) ||
+        fnv1a(decoded.data(), stateSize) != checksum) {
+        return false;
+    }
+    state.swap(decoded);
+    if (thumbnail) {
+        const uint8_t* png = data.data() + HEADER_SIZE + compressedSize;
+        thumbnail->assign(png, png + thumbnailSize);
+    }
+    return true;
+}
@@ -0,0 +1,420 @@
+#include "thumbnail.h"
+#include "lane_simd.h"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr int MAX_WIDTH = 256;   // Frame da PPU
+static constexpr int MAX_HEIGHT = 240;
+
+static constexpr size_t QOI_HEADER_SIZE = 14;
+static constexpr size_t QOI_END_SIZE = 8;
+static constexpr size_t PNG_BLOCK_SIZE = 65535;  // Maior bloco deflate "stored"
+
+static bool validSize(int width, int height) {
+    return width >= 1 && width <= MAX_WIDTH && height >= 1 && height <= MAX_HEIGHT;
+}
+
+static void writeBE32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+// Soma uma linha de bytes nos acumuladores de 16 bits (16 bytes por vez)
+static void accumulateRow(uint16_t* sums, const uint8_t* row, int count) {
+    int i = 0;
+#if defined(NES_LANES_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i* low = reinterpret_cast<__m128i*>(sums + i);
+        __m128i* high = reinterpret_cast<__m128i*>(sums + i + 8);
+        _mm_storeu_si128(low, _mm_add_epi16(_mm_loadu_si128(low), _mm_unpacklo_epi8(bytes, zero)));
+        _mm_storeu_si128(high, _mm_add_epi16(_mm_loadu_si128(high), _mm_unpackhi_epi8(bytes, zero)));
+    }
+#elif defined(NES_LANES_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t bytes = vld1q_u8(row + i);
+        vst1q_u16(sums + i, vaddw_u8(vld1q_u16(sums + i), vget_low_u8(bytes)));
+        vst1q_u16(sums + i + 8, vaddw_u8(vld1q_u16(sums + i + 8), vget_high_u8(bytes)));
+    }
+#endif
+    for (; i < count; i++) {
+        sums[i] += row[i];
+    }
+}
+
+// Linhas de uma imagem RGB já no tamanho final
+struct ImageRows {
+    const uint8_t* rgb;
+    size_t stride;
+    
+    const uint8_t* row(int y) { return rgb + y * stride; }
+};
+
+/**
+ * Filtro de caixa gerando uma linha de destino por vez (pedidas em ordem)
+ *
+ * Cada pixel de destino é a média do retângulo de origem que ele cobre
+ * (limites inteiros). As linhas de origem são somadas por coluna com SIMD e
+ * as colunas de cada caixa somadas em seguida; a divisão vira multiplicação
+ * por recíproco, recalculado só quando a altura da caixa muda.
+ */
+class BoxScaler {
+public:
+    BoxScaler(const uint8_t* src, int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+        : src(src), srcWidth(srcWidth), srcHeight(srcHeight), dstWidth(dstWidth),
+          dstHeight(dstHeight), cachedRows(0) {
+        for (int x = 0; x <= dstWidth; x++) {
+            columnStart[x] = static_cast<uint16_t>(x * srcWidth / dstWidth);
+        }
+    }
+    
+    const uint8_t* row(int y) {
+        int y0 = y * srcHeight / dstHeight;
+        int y1 = (y + 1) * srcHeight / dstHeight;
+        int rowBytes = srcWidth * 3;
+        std::memset(sums, 0, rowBytes * sizeof(uint16_t));
+        for (int r = y0; r < y1; r++) {
+            accumulateRow(sums, src + r * rowBytes, rowBytes);
+        }
+        
+        int rows = y1 - y0;
+        if (rows != cachedRows) {
+            cachedRows = rows;
+            for (int x = 0; x < dstWidth; x++) {
+                uint32_t count = (columnStart[x + 1] - columnStart[x]) * rows;
+                scale[x] = (1ull << 32) / count;
+            }
+        }
+        
+        uint8_t* out = line;
+        for (int x = 0; x < dstWidth; x++) {
+            uint32_t r = 0, g = 0, b = 0;
+            for (int c = columnStart[x]; c < columnStart[x + 1]; c++) {
+                r += sums[c * 3];
+                g += sums[c * 3 + 1];
+                b += sums[c * 3 + 2];
+            }
+            out[0] = static_cast<uint8_t>((r * scale[x] + (1ull << 31)) >> 32);
+            out[1] = static_cast<uint8_t>((g * scale[x] + (1ull << 31)) >> 32);
+            out[2] = static_cast<uint8_t>((b * scale[x] + (1ull << 31)) >> 32);
+            out += 3;
+        }
+        return line;
+    }
+
+private:
+    const uint8_t* src;
+    int srcWidth;
+    int srcHeight;
+    int dstWidth;
+    int dstHeight;
+    int cachedRows;
+    uint16_t columnStart[MAX_WIDTH + 1];
+    uint64_t scale[MAX_WIDTH];        // 2^32 / pixels da caixa
+    uint16_t sums[MAX_WIDTH * 3];     // Até 240 linhas * 255 cabe em 16 bits
+    uint8_t line[MAX_WIDTH * 3];
+};
+
+static size_t qoiMaxSize(int width, int height) {
+    return QOI_HEADER_SIZE + static_cast<size_t>(width) * height * 4 + QOI_END_SIZE;
+}
+
+// QOI (qoiformat.org) com 3 canais; alfa é sempre 255
+template <typename Rows>
+static size_t encodeQOI(Rows& rows, int width, int height, uint8_t* out, size_t capacity) {
+    if (capacity < QOI_HEADER_SIZE + QOI_END_SIZE) {
+        return 0;
+    }
+    std::memcpy(out, "qoif", 4);
+    writeBE32(out + 4, static_cast<uint32_t>(width));
+    writeBE32(out + 8, static_cast<uint32_t>(height));
+    out[12] = 3;  // RGB
+    out[13] = 0;  // sRGB
+    
+    uint8_t* p = out + QOI_HEADER_SIZE;
+    const uint8_t* limit = out + capacity - QOI_END_SIZE;
+    uint32_t index[64] = {};  // Alfa 0: nunca coincide com um pixel
+    uint32_t previous = 0xFF000000u;
+    int run = 0;
+    for (int y = 0; y < height; y++) {
+        const uint8_t* pixels = rows.row(y);
+        for (int x = 0; x < width; x++, pixels += 3) {
+            uint8_t r = pixels[0], g = pixels[1], b = pixels[2];
+            uint32_t pixel = r | (g << 8) | (b << 16) | 0xFF000000u;
+            if (pixel == previous) {
+                if (++run == 62) {
+                    if (p >= limit) {
+                        return 0;
+                    }
+                    *p++ = static_cast<uint8_t>(0xC0 | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            // Pior caso: fim da sequência + QOI_OP_RGB
+            if (limit - p < (run ? 5 : 4)) {
+                return 0;
+            }
+            if (run) {
+                *p++ = static_cast<uint8_t>(0xC0 | (run - 1));
+                run = 0;
+            }
+            
+            int hash = (r * 3 + g * 5 + b * 7 + 255 * 11) & 63;
+            if (index[hash] == pixel) {
+                *p++ = static_cast<uint8_t>(hash);
+            } else {
+                index[hash] = pixel;
+                int dr = static_cast<int8_t>(r - (previous & 0xFF));
+                int dg = static_cast<int8_t>(g - ((previous >> 8) & 0xFF));
+                int db = static_cast<int8_t>(b - ((previous >> 16) & 0xFF));
+                int drg = dr - dg;
+                int dbg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    *p++ = static_cast<uint8_t>(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                    *p++ = static_cast<uint8_t>(0x80 | (dg + 32));
+                    *p++ = static_cast<uint8_t>(((drg + 8) << 4) | (dbg + 8));
+                } else {
+                    *p++ = 0xFE;
+                    *p++ = r;
+                    *p++ = g;
+                    *p++ = b;
+                }
+            }
+            previous = pixel;
+        }
+    }
+    if (run) {
+        if (p >= limit) {
+            return 0;
+        }
+        *p++ = static_cast<uint8_t>(0xC0 | (run - 1));
+    }
+    std::memset(p, 0, QOI_END_SIZE - 1);
+    p[QOI_END_SIZE - 1] = 1;
+    return p + QOI_END_SIZE - out;
+}
+
+// Tabelas do CRC-32 do PNG para slicing-by-4 (4 bytes por consulta)
+struct CRCTables {
+    uint32_t values[4][256];
+    
+    CRCTables() {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            values[0][n] = c;
+        }
+        for (uint32_t n = 0; n < 256; n++) {
+            for (int t = 1; t < 4; t++) {
+                uint32_t c = values[t - 1][n];
+                values[t][n] = (c >> 8) ^ values[0][c & 0xFF];
+            }
+        }
+    }
+};
+
+static uint32_t crc32(const uint8_t* data, size_t size) {
+    static const CRCTables tables;
+    const uint32_t (*t)[256] = tables.values;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (; size >= 4; size -= 4, data += 4) {
+        crc ^= data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+        crc = t[3][crc & 0xFF] ^ t[2][(crc >> 8) & 0xFF] ^ t[1][(crc >> 16) & 0xFF] ^ t[0][crc >> 24];
+    }
+    for (; size > 0; size--) {
+        crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static size_t pngRawSize(int width, int height) {
+    return static_cast<size_t>(height) * (1 + static_cast<size_t>(width) * 3);
+}
+
+static size_t pngDataSize(int width, int height) {
+    size_t raw = pngRawSize(width, height);
+    size_t blocks = (raw + PNG_BLOCK_SIZE - 1) / PNG_BLOCK_SIZE;
+    return 2 + raw + 5 * blocks + 4;  // zlib: cabeçalho, blocos, Adler-32
+}
+
+static size_t pngSize(int width, int height) {
+    return 8 + (12 + 13) + (12 + pngDataSize(width, height)) + 12;
+}
+
+// Fluxo zlib só com blocos "stored" (sem compressão) e o Adler-32 do conteúdo
+class StoredDeflate {
+public:
+    StoredDeflate(uint8_t* out, size_t total)
+        : p(out), blockLeft(0), remaining(total), a(1), b(0) {
+        *p++ = 0x78;  // Janela de 32KB, sem dicionário
+        *p++ = 0x01;
+    }
+    
+    void put(const uint8_t* data, size_t size) {
+        while (size > 0) {
+            if (blockLeft == 0) {
+                size_t block = std::min(remaining, PNG_BLOCK_SIZE);
+                remaining -= block;
+                *p++ = remaining == 0 ? 1 : 0;  // BFINAL, BTYPE 00
+                p[0] = static_cast<uint8_t>(block);
+                p[1] = static_cast<uint8_t>(block >> 8);
+                p[2] = static_cast<uint8_t>(~block);
+                p[3] = static_cast<uint8_t>(~block >> 8);
+                p += 4;
+                blockLeft = block;
+            }
+            size_t count = std::min(size, blockLeft);
+            std::memcpy(p, data, count);
+            adler(data, count);
+            p += count;
+            data += count;
+            size -= count;
+            blockLeft -= count;
+        }
+    }
+    
+    uint8_t* finish() {
+        writeBE32(p, (b << 16) | a);
+        return p + 4;
+    }
+
+private:
+    uint8_t* p;
+    size_t blockLeft;
+    size_t remaining;
+    uint32_t a;
+    uint32_t b;
+    
+    void adler(const uint8_t* data, size_t size) {
+        // 5552 bytes é o máximo antes de b estourar 32 bits
+        while (size > 0) {
+            size_t count = std::min<size_t>(size, 5552);
+            for (size_t i = 0; i < count; i++) {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += count;
+            size -= count;
+        }
+    }
+};
+
+static uint8_t* writeChunkHeader(uint8_t* p, uint32_t length, const char* type) {
+    writeBE32(p, length);
+    std::memcpy(p + 4, type, 4);
+    return p + 8;
+}
+
+// Fecha o chunk iniciado em 'start' (comprimento) com o CRC de tipo + dados
+static uint8_t* writeChunkCRC(uint8_t* start, uint8_t* end) {
+    writeBE32(end, crc32(start + 4, end - start - 4));
+    return end + 4;
+}
+
+// PNG RGB de 8 bits, filtro "None" em todas as linhas
+template <typename Rows>
+static size_t encodePNG(Rows& rows, int width, int height, uint8_t* out, size_t capacity) {
+    if (capacity < pngSize(width, height)) {
+        return 0;
+    }
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    uint8_t* p = out;
+    std::memcpy(p, SIGNATURE, sizeof(SIGNATURE));
+    p += sizeof(SIGNATURE);
+    
+    uint8_t* chunk = p;
+    p = writeChunkHeader(p, 13, "IHDR");
+    writeBE32(p, static_cast<uint32_t>(width));
+    writeBE32(p + 4, static_cast<uint32_t>(height));
+    p[8] = 8;   // Bits por canal
+    p[9] = 2;   // RGB
+    p[10] = 0;  // Deflate
+    p[11] = 0;  // Filtros adaptativos
+    p[12] = 0;  // Sem entrelaçamento
+    p = writeChunkCRC(chunk, p + 13);
+    
+    chunk = p;
+    p = writeChunkHeader(p, static_cast<uint32_t>(pngDataSize(width, height)), "IDAT");
+    StoredDeflate stream(p, pngRawSize(width, height));
+    const uint8_t filter = 0;
+    for (int y = 0; y < height; y++) {
+        stream.put(&filter, 1);
+        stream.put(rows.row(y), static_cast<size_t>(width) * 3);
+    }
+    p = writeChunkCRC(chunk, stream.finish());
+    
+    chunk = p;
+    p = writeChunkHeader(p, 0, "IEND");
+    p = writeChunkCRC(chunk, p);
+    return p - out;
+}
+
+template <typename Rows>
+static size_t encode(Rows& rows, int width, int height, ThumbnailFormat format,
+              uint8_t* out, size_t capacity) {
+    switch (format) {
+        case THUMBNAIL_QOI:
+            return encodeQOI(rows, width, height, out, capacity);
+        case THUMBNAIL_PNG:
+            return encodePNG(rows, width, height, out, capacity);
+    }
+    return 0;
+}
+
+size_t thumbnailMaxSize(ThumbnailFormat format, int width, int height) {
+    if (!validSize(width, height)) {
+        return 0;
+    }
+    switch (format) {
+        case THUMBNAIL_QOI:
+            return qoiMaxSize(width, height);
+        case THUMBNAIL_PNG:
+            return pngSize(width, height);
+    }
+    return 0;
+}
+
+bool downscaleRGB(const uint8_t* src, int srcWidth, int srcHeight,
+                  uint8_t* dst, int dstWidth, int dstHeight) {
+    if (!src || !dst || !validSize(srcWidth, srcHeight) || !validSize(dstWidth, dstHeight) ||
+        dstWidth > srcWidth || dstHeight > srcHeight) {
+        return false;
+    }
+    BoxScaler scaler(src, srcWidth, srcHeight, dstWidth, dstHeight);
+    size_t rowBytes = static_cast<size_t>(dstWidth) * 3;
+    for (int y = 0; y < dstHeight; y++) {
+        std::memcpy(dst + y * rowBytes, scaler.row(y), rowBytes);
+    }
+    return true;
+}
+
+size_t encodeImage(const uint8_t* rgb, int width, int height, ThumbnailFormat format,
+                   uint8_t* out, size_t capacity) {
+    if (!rgb || !out || !validSize(width, height)) {
+        return 0;
+    }
+    ImageRows rows = {rgb, static_cast<size_t>(width) * 3};
+    return encode(rows, width, height, format, out, capacity);
+}
+
+size_t encodeThumbnail(const uint8_t* frame, int width, int height, ThumbnailFormat format,
+                       uint8_t* out, size_t capacity) {
+    if (width == MAX_WIDTH && height == MAX_HEIGHT) {
+        return encodeImage(frame, width, height, format, out, capacity);
+    }
+    if (!frame || !out || !validSize(width, height)) {
+        return 0;
+    }
+    BoxScaler scaler(frame, MAX_WIDTH, MAX_HEIGHT, width, height);
+    return encode(scaler, width, height, format, out, capacity);
+}
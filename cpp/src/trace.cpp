@@ -0,0 +1,143 @@
+#include "trace.h"
+#include "cpu.h"
+#include "ppu.h"
+#include "memory.h"
+#include "opcodes.h"
+
+#include <cstring>
+
+static const uint8_t TRACE_MAGIC[4] = {'N', 'E', 'S', 'T'};
+static const uint32_t TRACE_VERSION = 1;
+
+Tracer::Tracer(size_t capacity) : head(0), memory(nullptr), ppu(nullptr) {
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    records.resize(rounded);
+    mask = rounded - 1;
+}
+
+void Tracer::attach(const Memory* memory, const PPU* ppu) {
+    this->memory = memory;
+    this->ppu = ppu;
+}
+
+void Tracer::record(const CPU& cpu, uint8_t opcode, uint8_t event) {
+    TraceRecord& entry = records[head & mask];
+    head++;
+    
+    entry.cycle = cpu.cycles;
+    entry.pc = cpu.pc;
+    entry.opcode = opcode;
+    // Leitura sem efeitos colaterais: operandos em I/O ficam zerados
+    const uint8_t* page = memory ? memory->getPagePointer(cpu.pc >> 8) : nullptr;
+    uint8_t offset = cpu.pc & 0xFF;
+    if (page && offset < 0xFE) {
+        entry.operands[0] = page[offset + 1];
+        entry.operands[1] = page[offset + 2];
+    } else {
+        for (int i = 0; i < 2; i++) {
+            uint16_t addr = cpu.pc + 1 + i;
+            const uint8_t* next = memory ? memory->getPagePointer(addr >> 8) : nullptr;
+            entry.operands[i] = next ? next[addr & 0xFF] : 0;
+        }
+    }
+    entry.a = cpu.a;
+    entry.x = cpu.x;
+    entry.y = cpu.y;
+    entry.p = cpu.getStatus() | 0x20;  // Bit 5 sempre lido como 1
+    entry.sp = cpu.sp;
+    entry.scanline = ppu ? ppu->getScanline() : 0;
+    entry.dot = ppu ? ppu->getCycle() : 0;
+    entry.event = event;
+}
+
+void Tracer::copyRecords(std::vector<TraceRecord>& out) const {
+    size_t count = getCount();
+    out.resize(count);
+    uint64_t first = head - count;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = records[(first + i) & mask];
+    }
+}
+
+bool Tracer::writeDump(FILE* file) const {
+    std::vector<TraceRecord> ordered;
+    copyRecords(ordered);
+    uint32_t header[2] = {TRACE_VERSION, sizeof(TraceRecord)};
+    uint64_t counts[2] = {head, ordered.size()};
+    bool ok = fwrite(TRACE_MAGIC, 1, 4, file) == 4 &&
+              fwrite(header, sizeof(header), 1, file) == 1 &&
+              fwrite(counts, sizeof(counts), 1, file) == 1;
+    if (ok && !ordered.empty()) {
+        ok = fwrite(ordered.data(), sizeof(TraceRecord), ordered.size(), file) == ordered.size();
+    }
+    return ok;
+}
+
+bool Tracer::readDump(FILE* file, std::vector<TraceRecord>& out) {
+    uint8_t magic[4];
+    uint32_t header[2];
+    uint64_t counts[2];
+    if (fread(magic, 1, 4, file) != 4 || std::memcmp(magic, TRACE_MAGIC, 4) != 0 ||
+        fread(header, sizeof(header), 1, file) != 1 || header[0] != TRACE_VERSION ||
+        header[1] != sizeof(TraceRecord) || fread(counts, sizeof(counts), 1, file) != 1) {
+        return false;
+    }
+    out.resize(static_cast<size_t>(counts[1]));
+    return out.empty() || fread(out.data(), sizeof(TraceRecord), out.size(), file) == out.size();
+}
+
+size_t formatTraceRecord(const TraceRecord& record, char* out, size_t size) {
+    const OpcodeInfo& info = OPCODE_TABLE[record.opcode];
+    uint8_t length = instructionLength(info.mode);
+    uint8_t lo = record.operands[0];
+    uint16_t word = lo | (record.operands[1] << 8);
+    
+    char bytes[9];
+    if (length == 1) {
+        snprintf(bytes, sizeof(bytes), "%02X", record.opcode);
+    } else if (length == 2) {
+        snprintf(bytes, sizeof(bytes), "%02X %02X", record.opcode, lo);
+    } else {
+        snprintf(bytes, sizeof(bytes), "%02X %02X %02X", record.opcode, lo, record.operands[1]);
+    }
+    
+    char operand[16] = "";
+    switch (info.mode) {
+        case MODE_IMPLIED: break;
+        case MODE_ACCUMULATOR: snprintf(operand, sizeof(operand), " A"); break;
+        case MODE_IMMEDIATE: snprintf(operand, sizeof(operand), " #$%02X", lo); break;
+        case MODE_ZERO_PAGE: snprintf(operand, sizeof(operand), " $%02X", lo); break;
+        case MODE_ZERO_PAGE_X: snprintf(operand, sizeof(operand), " $%02X,X", lo); break;
+        case MODE_ZERO_PAGE_Y: snprintf(operand, sizeof(operand), " $%02X,Y", lo); break;
+        case MODE_ABSOLUTE: snprintf(operand, sizeof(operand), " $%04X", word); break;
+        case MODE_ABSOLUTE_X: snprintf(operand, sizeof(operand), " $%04X,X", word); break;
+        case MODE_ABSOLUTE_Y: snprintf(operand, sizeof(operand), " $%04X,Y", word); break;
+        case MODE_INDIRECT: snprintf(operand, sizeof(operand), " ($%04X)", word); break;
+        case MODE_INDIRECT_X: snprintf(operand, sizeof(operand), " ($%02X,X)", lo); break;
+        case MODE_INDIRECT_Y: snprintf(operand, sizeof(operand), " ($%02X),Y", lo); break;
+        case MODE_RELATIVE:
+            snprintf(operand, sizeof(operand), " $%04X",
+                     static_cast<uint16_t>(record.pc + 2 + static_cast<int8_t>(lo)));
+            break;
+    }
+    
+    char disassembly[24];
+    snprintf(disassembly, sizeof(disassembly), "%s%s", info.mnemonic, operand);
+    
+    // Opcodes não documentados levam '*' antes do mnemônico, como no nestest
+    const char* event = record.event == TRACE_NMI ? "[NMI]\n" :
+                        record.event == TRACE_IRQ ? "[IRQ]\n" : "";
+    int written = snprintf(out, size,
+                           "%s%04X  %-8s %c%-32sA:%02X X:%02X Y:%02X P:%02X SP:%02X PPU:%3u,%3u CYC:%llu",
+                           event, record.pc, bytes, info.official ? ' ' : '*', disassembly,
+                           record.a, record.x, record.y, record.p, record.sp,
+                           record.scanline, record.dot,
+                           static_cast<unsigned long long>(record.cycle));
+    if (written < 0) {
+        return 0;
+    }
+    return static_cast<size_t>(written) < size ? static_cast<size_t>(written) : size - 1;
+}
@@ -0,0 +1,467 @@
+#include "video_filter.h"
+#include "lane_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static constexpr int WIDTH = VideoFilter::SOURCE_WIDTH;
+static constexpr int HEIGHT = VideoFilter::SOURCE_HEIGHT;
+static constexpr int MAX_LINE = WIDTH * 4;
+static constexpr int ROW_PAD = 4;  // Borda das linhas RGBA (mantém o alinhamento de 16 bytes)
+
+// NTSC: um pixel dura 2/3 do ciclo da subportadora; 2 amostras por pixel,
+// 3 por ciclo de cor
+static constexpr int NTSC_SAMPLES = WIDTH * 2;
+static constexpr int NTSC_PAD = 4;
+static const int32_t NTSC_COS[3] = {128, -64, -64};  // Q7
+static const int32_t NTSC_SIN[3] = {0, 111, -111};
+
+static inline uint32_t packRGBA(uint32_t r, uint32_t g, uint32_t b) {
+    return r | (g << 8) | (b << 16) | 0xFF000000u;  // Bytes R, G, B, A em memória
+}
+
+/*
+ * 4 pixels RGBA por operação; máscaras são 0xFFFFFFFF / 0 por pixel.
+ */
+#if defined(NES_LANES_SSE2)
+
+struct Quad { __m128i v; };
+
+static inline Quad load(const uint32_t* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+static inline void store(uint32_t* p, Quad a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a.v); }
+static inline Quad equal(Quad a, Quad b) { return {_mm_cmpeq_epi32(a.v, b.v)}; }
+static inline Quad operator&(Quad a, Quad b) { return {_mm_and_si128(a.v, b.v)}; }
+static inline Quad operator|(Quad a, Quad b) { return {_mm_or_si128(a.v, b.v)}; }
+// a & ~b
+static inline Quad andNot(Quad a, Quad b) { return {_mm_andnot_si128(b.v, a.v)}; }
+static inline Quad select(Quad mask, Quad a, Quad b) {
+    return {_mm_or_si128(_mm_and_si128(mask.v, a.v), _mm_andnot_si128(mask.v, b.v))};
+}
+
+// a0 b0 a1 b1 a2 b2 a3 b3
+static inline void storeInterleaved(uint32_t* p, Quad a, Quad b) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_unpacklo_epi32(a.v, b.v));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 4), _mm_unpackhi_epi32(a.v, b.v));
+}
+
+// a0 b0 c0 a1 b1 c1 a2 b2 c2 a3 b3 c3
+static inline void storeInterleaved(uint32_t* p, Quad a, Quad b, Quad c) {
+    __m128i ab = _mm_unpacklo_epi32(a.v, b.v);
+    __m128i ca = _mm_unpacklo_epi32(c.v, _mm_shuffle_epi32(a.v, _MM_SHUFFLE(1, 1, 1, 1)));
+    __m128i bc = _mm_unpacklo_epi32(_mm_shuffle_epi32(b.v, _MM_SHUFFLE(1, 1, 1, 1)),
+                                    _mm_shuffle_epi32(c.v, _MM_SHUFFLE(1, 1, 1, 1)));
+    __m128i abHigh = _mm_unpackhi_epi32(a.v, b.v);
+    __m128i ca3 = _mm_unpackhi_epi32(c.v, _mm_shuffle_epi32(a.v, _MM_SHUFFLE(3, 3, 3, 3)));
+    __m128i bcHigh = _mm_unpackhi_epi32(b.v, c.v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_unpacklo_epi64(ab, ca));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 4), _mm_unpacklo_epi64(bc, abHigh));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 8),
+                     _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(ca3), _mm_castsi128_pd(bcHigh), 2)));
+}
+
+// Cada pixel repetido 4 vezes
+static inline void storeRepeat4(uint32_t* p, Quad a) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_shuffle_epi32(a.v, _MM_SHUFFLE(0, 0, 0, 0)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 4), _mm_shuffle_epi32(a.v, _MM_SHUFFLE(1, 1, 1, 1)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 8), _mm_shuffle_epi32(a.v, _MM_SHUFFLE(2, 2, 2, 2)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 12), _mm_shuffle_epi32(a.v, _MM_SHUFFLE(3, 3, 3, 3)));
+}
+
+// RGB * factor / 256, alfa mantido
+static void darkenRow(const uint32_t* src, uint8_t* dst, int count, uint8_t factor) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i scale = _mm_set1_epi16(factor);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    for (int x = 0; x < count; x += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        __m128i low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), scale), 8);
+        __m128i high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), scale), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4),
+                         _mm_or_si128(_mm_packus_epi16(low, high), alpha));
+    }
+}
+
+#elif defined(NES_LANES_NEON)
+
+struct Quad { uint32x4_t v; };
+
+static inline Quad load(const uint32_t* p) { return {vld1q_u32(p)}; }
+static inline void store(uint32_t* p, Quad a) { vst1q_u32(p, a.v); }
+static inline Quad equal(Quad a, Quad b) { return {vceqq_u32(a.v, b.v)}; }
+static inline Quad operator&(Quad a, Quad b) { return {vandq_u32(a.v, b.v)}; }
+static inline Quad operator|(Quad a, Quad b) { return {vorrq_u32(a.v, b.v)}; }
+static inline Quad andNot(Quad a, Quad b) { return {vbicq_u32(a.v, b.v)}; }
+static inline Quad select(Quad mask, Quad a, Quad b) { return {vbslq_u32(mask.v, a.v, b.v)}; }
+
+static inline void storeInterleaved(uint32_t* p, Quad a, Quad b) {
+    uint32x4x2_t pair = {{a.v, b.v}};
+    vst2q_u32(p, pair);
+}
+
+static inline void storeInterleaved(uint32_t* p, Quad a, Quad b, Quad c) {
+    uint32x4x3_t triple = {{a.v, b.v, c.v}};
+    vst3q_u32(p, triple);
+}
+
+static inline void storeRepeat4(uint32_t* p, Quad a) {
+    uint32x4x4_t quad = {{a.v, a.v, a.v, a.v}};
+    vst4q_u32(p, quad);
+}
+
+static void darkenRow(const uint32_t* src, uint8_t* dst, int count, uint8_t factor) {
+    const uint8x8_t scale = vdup_n_u8(factor);
+    const uint8x16_t alpha = vreinterpretq_u8_u32(vdupq_n_u32(0xFF000000u));
+    for (int x = 0; x < count; x += 4) {
+        uint8x16_t v = vreinterpretq_u8_u32(vld1q_u32(src + x));
+        uint8x8_t low = vshrn_n_u16(vmull_u8(vget_low_u8(v), scale), 8);
+        uint8x8_t high = vshrn_n_u16(vmull_u8(vget_high_u8(v), scale), 8);
+        vst1q_u8(dst + x * 4, vorrq_u8(vcombine_u8(low, high), alpha));
+    }
+}
+
+#else
+
+struct Quad { uint32_t v[4]; };
+
+static inline Quad load(const uint32_t* p) { Quad q; std::memcpy(q.v, p, sizeof(q.v)); return q; }
+static inline void store(uint32_t* p, Quad a) { std::memcpy(p, a.v, sizeof(a.v)); }
+
+template <typename F>
+static inline Quad map(Quad a, Quad b, F f) {
+    Quad r;
+    for (int i = 0; i < 4; i++) {
+        r.v[i] = f(a.v[i], b.v[i]);
+    }
+    return r;
+}
+
+static inline Quad equal(Quad a, Quad b) { return map(a, b, [](uint32_t x, uint32_t y) { return x == y ? 0xFFFFFFFFu : 0u; }); }
+static inline Quad operator&(Quad a, Quad b) { return map(a, b, [](uint32_t x, uint32_t y) { return x & y; }); }
+static inline Quad operator|(Quad a, Quad b) { return map(a, b, [](uint32_t x, uint32_t y) { return x | y; }); }
+static inline Quad andNot(Quad a, Quad b) { return map(a, b, [](uint32_t x, uint32_t y) { return x & ~y; }); }
+static inline Quad select(Quad mask, Quad a, Quad b) { return (mask & a) | andNot(b, mask); }
+
+static inline void storeInterleaved(uint32_t* p, Quad a, Quad b) {
+    for (int i = 0; i < 4; i++) {
+        p[i * 2] = a.v[i];
+        p[i * 2 + 1] = b.v[i];
+    }
+}
+
+static inline void storeInterleaved(uint32_t* p, Quad a, Quad b, Quad c) {
+    for (int i = 0; i < 4; i++) {
+        p[i * 3] = a.v[i];
+        p[i * 3 + 1] = b.v[i];
+        p[i * 3 + 2] = c.v[i];
+    }
+}
+
+static inline void storeRepeat4(uint32_t* p, Quad a) {
+    for (int i = 0; i < 16; i++) {
+        p[i] = a.v[i / 4];
+    }
+}
+
+static void darkenRow(const uint32_t* src, uint8_t* dst, int count, uint8_t factor) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
+    for (int i = 0; i < count * 4; i++) {
+        dst[i] = (i & 3) == 3 ? 0xFF : static_cast<uint8_t>((bytes[i] * factor) >> 8);
+    }
+}
+
+#endif
+
+// Linha de origem em RGBA, com a borda (1 pixel de cada lado) repetida
+static void expandRow(const uint8_t* rgb, uint32_t* row) {
+    for (int x = 0; x < WIDTH; x++, rgb += 3) {
+        row[x] = packRGBA(rgb[0], rgb[1], rgb[2]);
+    }
+    row[-1] = row[0];
+    row[WIDTH] = row[WIDTH - 1];
+}
+
+static void padRow(uint32_t* row, int width) {
+    row[-1] = row[0];
+    row[width] = row[width - 1];
+}
+
+/*
+ * Scale2x (AdvMAME2x): com B acima, D à esquerda, F à direita e H abaixo
+ * de E, cada pixel vira 2x2 e os cantos copiam o vizinho quando duas bordas
+ * adjacentes coincidem. Linhas com 1 pixel de borda, largura múltipla de 4.
+ */
+static void scale2xRow(const uint32_t* above, const uint32_t* row, const uint32_t* below,
+                       int width, uint32_t* out0, uint32_t* out1) {
+    for (int x = 0; x < width; x += 4) {
+        Quad b = load(above + x);
+        Quad h = load(below + x);
+        Quad d = load(row + x - 1);
+        Quad e = load(row + x);
+        Quad f = load(row + x + 1);
+        Quad bf = equal(b, f);
+        Quad dh = equal(d, h);
+        Quad db = equal(d, b);
+        Quad hf = equal(h, f);
+        Quad e0 = select(andNot(andNot(db, bf), dh), d, e);
+        Quad e1 = select(andNot(andNot(bf, db), hf), f, e);
+        Quad e2 = select(andNot(andNot(dh, db), hf), d, e);
+        Quad e3 = select(andNot(andNot(hf, dh), bf), f, e);
+        storeInterleaved(out0 + x * 2, e0, e1);
+        storeInterleaved(out1 + x * 2, e2, e3);
+    }
+}
+
+// Scale3x (AdvMAME3x): vizinhança 3x3 A B C / D E F / G H I
+static void scale3xRow(const uint32_t* above, const uint32_t* row, const uint32_t* below,
+                       uint32_t* out0, uint32_t* out1, uint32_t* out2) {
+    for (int x = 0; x < WIDTH; x += 4) {
+        Quad a = load(above + x - 1);
+        Quad b = load(above + x);
+        Quad c = load(above + x + 1);
+        Quad d = load(row + x - 1);
+        Quad e = load(row + x);
+        Quad f = load(row + x + 1);
+        Quad g = load(below + x - 1);
+        Quad h = load(below + x);
+        Quad i = load(below + x + 1);
+        // B != H e D != F
+        Quad active = andNot(andNot(equal(e, e), equal(b, h)), equal(d, f));
+        Quad db = equal(d, b) & active;
+        Quad bf = equal(b, f) & active;
+        Quad dh = equal(d, h) & active;
+        Quad hf = equal(h, f) & active;
+        Quad ea = equal(e, a);
+        Quad ec = equal(e, c);
+        Quad eg = equal(e, g);
+        Quad ei = equal(e, i);
+        storeInterleaved(out0 + x * 3, select(db, d, e),
+                         select(andNot(db, ec) | andNot(bf, ea), b, e), select(bf, f, e));
+        storeInterleaved(out1 + x * 3, select(andNot(db, eg) | andNot(dh, ea), d, e), e,
+                         select(andNot(bf, ei) | andNot(hf, ec), f, e));
+        storeInterleaved(out2 + x * 3, select(dh, d, e),
+                         select(andNot(dh, ei) | andNot(hf, eg), h, e), select(hf, f, e));
+    }
+}
+
+VideoFilter::VideoFilter() : settings{VIDEO_FILTER_NEAREST, 2, 0} {
+    // Matriz RGB -> YIQ (FCC), em 1/16 de unidade
+    static const double YIQ[3][3] = {
+        {0.299, 0.587, 0.114},
+        {0.596, -0.274, -0.322},
+        {0.211, -0.523, 0.312},
+    };
+    for (int channel = 0; channel < 3; channel++) {
+        for (int value = 0; value < 256; value++) {
+            for (int k = 0; k < 3; k++) {
+                yiqTable[channel][value][k] = static_cast<int32_t>(std::lround(YIQ[k][channel] * value * 16));
+            }
+        }
+    }
+}
+
+bool VideoFilter::configure(const VideoFilterSettings& newSettings) {
+    if (newSettings.type > VIDEO_FILTER_NTSC || newSettings.scale < 2 || newSettings.scale > 4) {
+        return false;
+    }
+    settings = newSettings;
+    return true;
+}
+
+void VideoFilter::apply(const uint8_t* frame, uint8_t* out, size_t pitch) const {
+    switch (settings.type) {
+        case VIDEO_FILTER_NEAREST:
+            applyNearest(frame, out, pitch);
+            break;
+        case VIDEO_FILTER_SMOOTH:
+            applySmooth(frame, out, pitch);
+            break;
+        case VIDEO_FILTER_NTSC:
+            applyNTSC(frame, out, pitch);
+            break;
+    }
+}
+
+// A última linha de saída de cada linha de origem recebe as scanlines
+void VideoFilter::writeLine(uint8_t* out, size_t pitch, int row, const uint32_t* line) const {
+    uint8_t* dst = out + row * pitch;
+    int width = getWidth();
+    if (settings.scanlines && row % settings.scale == settings.scale - 1) {
+        darkenRow(line, dst, width, static_cast<uint8_t>(255 - settings.scanlines));
+    } else {
+        std::memcpy(dst, line, width * sizeof(uint32_t));
+    }
+}
+
+void VideoFilter::applyNearest(const uint8_t* frame, uint8_t* out, size_t pitch) const {
+    alignas(16) uint32_t source[WIDTH + 2 * ROW_PAD];
+    alignas(16) uint32_t line[MAX_LINE];
+    uint32_t* row = source + ROW_PAD;
+    int scale = settings.scale;
+    for (int y = 0; y < HEIGHT; y++) {
+        expandRow(frame + y * WIDTH * 3, row);
+        for (int x = 0; x < WIDTH; x += 4) {
+            Quad pixels = load(row + x);
+            if (scale == 2) {
+                storeInterleaved(line + x * 2, pixels, pixels);
+            } else if (scale == 3) {
+                storeInterleaved(line + x * 3, pixels, pixels, pixels);
+            } else {
+                storeRepeat4(line + x * 4, pixels);
+            }
+        }
+        for (int r = 0; r < scale; r++) {
+            writeLine(out, pitch, y * scale + r, line);
+        }
+    }
+}
+
+void VideoFilter::applySmooth(const uint8_t* frame, uint8_t* out, size_t pitch) const {
+    // Três linhas de origem em anel (acima, atual, abaixo)
+    alignas(16) uint32_t source[3][WIDTH + 2 * ROW_PAD];
+    alignas(16) uint32_t lines[3][MAX_LINE];
+    auto sourceRow = [&](int y) { return source[y % 3] + ROW_PAD; };
+    
+    // 4x: Scale2x sobre as linhas do primeiro Scale2x, em anel de 4
+    alignas(16) uint32_t middle[4][WIDTH * 2 + 2 * ROW_PAD];
+    auto middleRow = [&](int j) { return middle[j & 3] + ROW_PAD; };
+    auto finishMiddle = [&](int j, int last) {
+        scale2xRow(middleRow(std::max(j - 1, 0)), middleRow(j), middleRow(std::min(j + 1, last)),
+                   WIDTH * 2, lines[0], lines[1]);
+        writeLine(out, pitch, j * 2, lines[0]);
+        writeLine(out, pitch, j * 2 + 1, lines[1]);
+    };
+    
+    expandRow(frame, sourceRow(0));
+    for (int y = 0; y < HEIGHT; y++) {
+        if (y + 1 < HEIGHT) {
+            expandRow(frame + (y + 1) * WIDTH * 3, sourceRow(y + 1));
+        }
+        const uint32_t* above = sourceRow(y > 0 ? y - 1 : 0);
+        const uint32_t* row = sourceRow(y);
+        const uint32_t* below = sourceRow(y + 1 < HEIGHT ? y + 1 : y);
+        
+        switch (settings.scale) {
+            case 2:
+                scale2xRow(above, row, below, WIDTH, lines[0], lines[1]);
+                writeLine(out, pitch, y * 2, lines[0]);
+                writeLine(out, pitch, y * 2 + 1, lines[1]);
+                break;
+            case 3:
+                scale3xRow(above, row, below, lines[0], lines[1], lines[2]);
+                for (int r = 0; r < 3; r++) {
+                    writeLine(out, pitch, y * 3 + r, lines[r]);
+                }
+                break;
+            default: {
+                int last = HEIGHT * 2 - 1;
+                scale2xRow(above, row, below, WIDTH, middleRow(y * 2), middleRow(y * 2 + 1));
+                padRow(middleRow(y * 2), WIDTH * 2);
+                padRow(middleRow(y * 2 + 1), WIDTH * 2);
+                if (y > 0) {
+                    finishMiddle(y * 2 - 1, last);
+                }
+                finishMiddle(y * 2, last);
+                if (y == HEIGHT - 1) {
+                    finishMiddle(last, last);
+                }
+                break;
+            }
+        }
+    }
+}
+
+/*
+ * Cada linha é codificada como sinal composto (Y + I cos + Q sin, com a
+ * fase da subportadora avançando 2/3 de ciclo por pixel e 1/3 por linha) e
+ * decodificada com filtros de caixa de um ciclo para o luma e dois para o
+ * croma. O borrão de cor e os artefatos nas bordas saem da própria
+ * decodificação, como em uma TV. A conversão RGB -> YIQ usa a tabela do
+ * construtor e os filtros são somas corridas, O(1) por amostra.
+ */
+void VideoFilter::applyNTSC(const uint8_t* frame, uint8_t* out, size_t pitch) const {
+    int32_t composite[NTSC_SAMPLES + 2 * NTSC_PAD];
+    int32_t demodI[NTSC_SAMPLES + 2 * NTSC_PAD];
+    int32_t demodQ[NTSC_SAMPLES + 2 * NTSC_PAD];
+    alignas(16) uint32_t decoded[NTSC_SAMPLES + ROW_PAD];
+    alignas(16) uint32_t line[MAX_LINE];
+    int scale = settings.scale;
+    
+    for (int y = 0; y < HEIGHT; y++) {
+        // Amostra n em composite[n + NTSC_PAD]; fora da linha repete a borda
+        const uint8_t* rgb = frame + y * WIDTH * 3;
+        int phase = y % 3;
+        int32_t* signal = composite + NTSC_PAD;
+        for (int x = 0; x < WIDTH; x++, rgb += 3) {
+            const int32_t* r = yiqTable[0][rgb[0]];
+            const int32_t* g = yiqTable[1][rgb[1]];
+            const int32_t* b = yiqTable[2][rgb[2]];
+            int32_t luma = r[0] + g[0] + b[0];
+            int32_t inPhase = r[1] + g[1] + b[1];
+            int32_t quadrature = r[2] + g[2] + b[2];
+            for (int k = 0; k < 2; k++) {
+                *signal++ = luma + ((inPhase * NTSC_COS[phase] + quadrature * NTSC_SIN[phase]) >> 7);
+                phase = phase == 2 ? 0 : phase + 1;
+            }
+        }
+        for (int k = 0; k < NTSC_PAD; k++) {
+            composite[k] = composite[NTSC_PAD + (k & 1)];
+            composite[NTSC_PAD + NTSC_SAMPLES + k] = composite[NTSC_PAD + NTSC_SAMPLES - 2 + (k & 1)];
+        }
+        phase = ((y - NTSC_PAD) % 3 + 3) % 3;
+        for (int i = 0; i < NTSC_SAMPLES + 2 * NTSC_PAD; i++) {
+            demodI[i] = composite[i] * NTSC_COS[phase];
+            demodQ[i] = composite[i] * NTSC_SIN[phase];
+            phase = phase == 2 ? 0 : phase + 1;
+        }
+        
+        // Janelas [n-1, n+1] (luma) e [n-3, n+2] (croma)
+        int32_t sumY = composite[NTSC_PAD - 1] + composite[NTSC_PAD] + composite[NTSC_PAD + 1];
+        int32_t sumI = 0, sumQ = 0;
+        for (int k = -3; k <= 2; k++) {
+            sumI += demodI[NTSC_PAD + k];
+            sumQ += demodQ[NTSC_PAD + k];
+        }
+        int32_t lumaOut[NTSC_SAMPLES];
+        int32_t inPhaseOut[NTSC_SAMPLES];
+        int32_t quadratureOut[NTSC_SAMPLES];
+        for (int n = 0; n < NTSC_SAMPLES; n++) {
+            lumaOut[n] = sumY;
+            inPhaseOut[n] = sumI;
+            quadratureOut[n] = sumQ;
+            int i = NTSC_PAD + n;
+            sumY += composite[i + 2] - composite[i - 1];
+            sumI += demodI[i + 3] - demodI[i - 3];
+            sumQ += demodQ[i + 3] - demodQ[i - 3];
+        }
+        // YIQ -> RGB em laço independente por amostra (vetorizado pelo compilador)
+        for (int n = 0; n < NTSC_SAMPLES; n++) {
+            int32_t yy = lumaOut[n] / 3;
+            int32_t ii = inPhaseOut[n] / 384;  // 2 * média / 128
+            int32_t qq = quadratureOut[n] / 384;
+            int32_t r = (yy + ((245 * ii + 159 * qq) >> 8)) >> 4;
+            int32_t g = (yy - ((70 * ii + 166 * qq) >> 8)) >> 4;
+            int32_t b = (yy - ((283 * ii - 436 * qq) >> 8)) >> 4;
+            decoded[n] = packRGBA(std::min(std::max(r, 0), 255), std::min(std::max(g, 0), 255),
+                                  std::min(std::max(b, 0), 255));
+        }
+        
+        // 512 amostras -> 256 * scale pixels
+        const uint32_t* result = decoded;
+        if (scale == 3) {
+            for (int m = 0; m < WIDTH * 3; m++) {
+                line[m] = decoded[(m * 2 + 1) / 3];
+            }
+            result = line;
+        } else if (scale == 4) {
+            for (int n = 0; n < NTSC_SAMPLES; n += 4) {
+                Quad samples = load(decoded + n);
+                storeInterleaved(line + n * 2, samples, samples);
+            }
+            result = line;
+        }
+        for (int r = 0; r < scale; r++) {
+            writeLine(out, pitch, y * scale + r, result);
+        }
+    }
+}
@@ -0,0 +1,228 @@
+/*
+ * Exercita a API C (nes_api.h) a partir de C puro: carrega a ROM por fd,
+ * roda frames com buffers de vídeo/áudio do chamador (sem perder amostras),
+ * grava e restaura um save state e confere que a reexecução reproduz o
+ * mesmo frame.
+ *
+ * Uso: nes_api_harness <rom.nes> [frames]
+ *
+ * Sai com 0 se tudo confere, 1 em erro de uso/ROM e 2 em divergência.
+ */
+
+#include "nes_api.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static uint64_t hashFrame(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static size_t drainAudio(nes_console* console, const float* ring, size_t capacity) {
+    size_t head;
+    size_t count = nes_audio_available(console, &head);
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        sum += ring[(head + i) % capacity];  /* Leitura direto do anel */
+    }
+    (void)sum;
+    nes_consume_audio(console, count);
+    return count;
+}
+
+static void saveDone(void* user, uint64_t ticket, int ok) {
+    (void)ticket;
+    *(int*)user += ok;
+}
+
+static int fail(const char* message) {
+    fprintf(stderr, "falhou: %s\n", message);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "uso: %s <rom.nes> [frames]\n", argv[0]);
+        return 1;
+    }
+    int frames = argc > 2 ? atoi(argv[2]) : 120;
+    if (frames < 2) {
+        frames = 2;
+    }
+    
+    if (nes_api_version() != NES_API_VERSION) {
+        return fail("versão da API");
+    }
+    
+    nes_console* console = nes_create(1);
+    if (!console) {
+        return fail("nes_create");
+    }
+    
+    int fd = open(argv[1], O_RDONLY);
+    if (fd < 0 || nes_load_rom_fd(console, fd) != NES_OK) {
+        fprintf(stderr, "ROM inválida: %s\n", argv[1]);
+        if (fd >= 0) {
+            close(fd);
+        }
+        nes_destroy(console);
+        return 1;
+    }
+    close(fd);
+    
+    static uint8_t video[NES_FRAME_BYTES];
+    /* Dois frames de amostras: o anel só é drenado entre frames */
+    static float audio[2 * NES_AUDIO_MIN_CAPACITY];
+    if (nes_set_video_buffer(console, video, sizeof(video) - 1) != NES_ERROR_BUFFER_TOO_SMALL ||
+        nes_set_video_buffer(console, video, sizeof(video)) != NES_OK ||
+        nes_set_audio_buffer(console, audio, NES_AUDIO_MIN_CAPACITY - 1) != NES_ERROR_BUFFER_TOO_SMALL ||
+        nes_set_audio_buffer(console, audio, sizeof(audio) / sizeof(audio[0])) != NES_OK) {
+        return fail("buffers do chamador");
+    }
+    
+    /* Primeira metade com entrada, depois um save state no meio */
+    size_t samples = 0;
+    int half = frames / 2;
+    for (int f = 0; f < half; f++) {
+        nes_set_buttons(console, 0, (f & 8) ? NES_BUTTON_RIGHT : NES_BUTTON_A);
+        nes_run_frame(console);
+        samples += drainAudio(console, audio, sizeof(audio) / sizeof(audio[0]));
+    }
+    
+    size_t stateSize = nes_state_size(console);
+    uint8_t* state = malloc(stateSize);
+    if (!state || nes_save_state(console, state, stateSize) != stateSize ||
+        nes_save_state(console, state, stateSize - 1) != 0) {
+        return fail("nes_save_state");
+    }
+    
+    for (int f = half; f < frames; f++) {
+        nes_run_frame(console);
+        samples += drainAudio(console, audio, sizeof(audio) / sizeof(audio[0]));
+    }
+    uint64_t firstHash = hashFrame(video, sizeof(video));
+    uint64_t firstCount = nes_get_frame_count(console);
+    
+    /* Cerca de um frame de amostras por frame (o primeiro começa na linha
+     * 0, não no vblank), sem nenhuma descartada */
+    if (nes_audio_overruns(console) != 0 || samples < (size_t)(frames - 1) * (NES_AUDIO_MIN_CAPACITY - 64)) {
+        return fail("amostras de áudio descartadas");
+    }
+    
+    /* Nada rodou desde a última consulta: nenhuma linha alterada */
+    uint64_t rows[4];
+    nes_take_dirty_rows(console, rows);
+    if (nes_take_dirty_rows(console, rows) != 0 || rows[0] || rows[1] || rows[2] || rows[3]) {
+        return fail("nes_take_dirty_rows");
+    }
+    
+    /* Restaura e refaz a segunda metade: o frame final tem de ser igual */
+    if (nes_load_state(console, state, stateSize - 1) != NES_ERROR_INVALID_STATE ||
+        nes_load_state(console, state, stateSize) != NES_OK) {
+        return fail("nes_load_state");
+    }
+    for (int f = half; f < frames; f++) {
+        nes_run_frame(console);
+        drainAudio(console, audio, sizeof(audio) / sizeof(audio[0]));
+    }
+    uint64_t secondHash = hashFrame(video, sizeof(video));
+    if (secondHash != firstHash || nes_get_frame_count(console) != firstCount) {
+        return fail("reexecução após load state divergiu");
+    }
+    
+    /* Miniatura: PNG "stored" tem sempre o tamanho máximo; QOI cabe nele */
+    size_t pngSize = nes_thumbnail_max_size(NES_IMAGE_PNG, 128, 120);
+    uint8_t* thumbnail = malloc(nes_thumbnail_max_size(NES_IMAGE_QOI, 128, 120));
+    if (!thumbnail || pngSize == 0 ||
+        nes_encode_thumbnail(console, NES_IMAGE_PNG, 128, 120, thumbnail, pngSize) != pngSize ||
+        nes_encode_thumbnail(console, NES_IMAGE_PNG, 128, 120, thumbnail, pngSize - 1) != 0 ||
+        memcmp(thumbnail, "\x89PNG", 4) != 0 ||
+        nes_encode_thumbnail(console, NES_IMAGE_QOI, 128, 120, thumbnail,
+                             nes_thumbnail_max_size(NES_IMAGE_QOI, 128, 120)) == 0 ||
+        nes_encode_thumbnail(console, NES_IMAGE_QOI, 257, 120, thumbnail, pngSize) != 0) {
+        return fail("nes_encode_thumbnail");
+    }
+    free(thumbnail);
+    
+    /* Filtro de vídeo sobre o último frame, em um buffer com folga por linha */
+    nes_video_filter* filter = nes_filter_create(NES_FILTER_SMOOTH, 3, 64);
+    int filterWidth = 0, filterHeight = 0;
+    nes_filter_get_size(filter, &filterWidth, &filterHeight);
+    size_t pitch = (size_t)filterWidth * 4 + 64;
+    size_t filteredSize = pitch * filterHeight;
+    uint8_t* filtered = malloc(filteredSize);
+    if (!filter || filterWidth != 768 || filterHeight != 720 || !filtered ||
+        nes_filter_create(NES_FILTER_NTSC, 5, 0) != NULL ||
+        nes_filter_apply(filter, video, filtered, pitch, filteredSize - pitch) != NES_ERROR_BUFFER_TOO_SMALL ||
+        nes_filter_apply(filter, video, filtered, pitch, filteredSize) != NES_OK ||
+        filtered[3] != 0xFF || filtered[pitch * 719 + 767 * 4 + 3] != 0xFF) {
+        return fail("nes_filter_apply");
+    }
+    free(filtered);
+    nes_filter_destroy(filter);
+    
+    /* Save em arquivo pela thread do saver; recarregar reproduz o frame */
+    int saved = 0;
+    char statePath[] = "/tmp/nes_api_harness_XXXXXX";
+    int stateFd = mkstemp(statePath);
+    nes_state_saver* saver = nes_saver_create(saveDone, &saved);
+    static uint8_t png[65536];
+    if (stateFd < 0 || !saver || nes_saver_save(saver, console, statePath, 1) == 0) {
+        return fail("nes_saver_save");
+    }
+    close(stateFd);
+    nes_saver_flush(saver);
+    nes_saver_destroy(saver);
+    for (int f = 0; f < 4; f++) {
+        nes_run_frame(console);
+        drainAudio(console, audio, sizeof(audio) / sizeof(audio[0]));
+    }
+    uint64_t savedHash = hashFrame(video, sizeof(video));
+    if (saved != 1 || nes_load_state_file(console, statePath) != NES_OK ||
+        nes_read_state_thumbnail(statePath, png, sizeof(png)) == 0 || memcmp(png, "\x89PNG", 4) != 0) {
+        return fail("nes_load_state_file");
+    }
+    for (int f = 0; f < 4; f++) {
+        nes_run_frame(console);
+        drainAudio(console, audio, sizeof(audio) / sizeof(audio[0]));
+    }
+    unlink(statePath);
+    if (hashFrame(video, sizeof(video)) != savedHash) {
+        return fail("reexecução após nes_load_state_file divergiu");
+    }
+    
+    /* Pacer a 240 Hz: cada frame sai com latência medida e entrada contada */
+    nes_frame_pacer* pacer = nes_pacer_create(console, 240.0);
+    nes_pacer_stats pacing;
+    if (!pacer || nes_pacer_create(NULL, 60.0) != NULL) {
+        return fail("nes_pacer_create");
+    }
+    for (int f = 0; f < 8; f++) {
+        uint64_t wake = nes_pacer_wait(pacer);
+        nes_push_input(console, 0, nes_now_ns(), 0, (f & 1) ? NES_BUTTON_B : 0);
+        nes_pacer_run_frame(pacer);
+        drainAudio(console, audio, sizeof(audio) / sizeof(audio[0]));
+        if (wake == 0 || nes_pacer_frame_presented(pacer, 0) == 0) {
+            return fail("nes_pacer_frame_presented");
+        }
+    }
+    nes_pacer_get_stats(pacer, &pacing);
+    if (pacing.frames != 8 || pacing.events != 8 || pacing.input_latency_max_ns < pacing.input_latency_avg_ns) {
+        return fail("nes_pacer_get_stats");
+    }
+    nes_pacer_destroy(pacer);
+    
+    printf("%s: %d frames, %zu amostras, estado de %zu bytes, frame %016llx\n",
+           argv[1], frames, samples, stateSize, (unsigned long long)firstHash);
+    
+    free(state);
+    nes_destroy(console);
+    return 0;
+}
@@ -0,0 +1,354 @@
+/**
+ * Executor headless do núcleo: carrega uma ROM, roda N frames (ou um filme)
+ * em K instâncias distribuídas em T threads e mede a vazão.
+ *
+ * Uso: nes_headless <rom.nes> [--frames N] [--movie arquivo] [--instances K]
+ *                   [--threads T] [--video] [--audio] [--json]
+ *                   [--profile arquivo.csv|arquivo.bin] [--trace arquivo.bin]
+ *
+ * Sem --video/--audio roda em HEADLESS_ALL. Com --movie cada instância
+ * reproduz o filme (e para nele, se for mais curto que N frames); filme
+ * inválido ou gravado com outra ROM é erro (saída 1).
+ * --profile grava os contadores da instância 0 (build com NES_PROFILING).
+ * --trace grava as últimas instruções da instância 0 (ver nes_trace_format).
+ */
+
+#include "console.h"
+#include "movie.h"
+#include "ppu.h"
+#include "profiler.h"
+#include "state.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+struct Options {
+    std::string romPath;
+    std::string moviePath;
+    std::string profilePath;
+    std::string tracePath;
+    int frames = 600;
+    int instances = 1;
+    int threads = 1;
+    bool video = false;
+    bool audio = false;
+    bool json = false;
+};
+
+struct InstanceResult {
+    uint64_t frames = 0;
+    ComponentTimings timings = {};
+    uint64_t stateHash = 0;
+    uint64_t frameHash = 0;
+    bool desynced = false;
+    uint32_t desyncFrame = 0;
+    const char* error = nullptr;  // Instância não rodou
+};
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Pico de memória residente do processo, em KB (0 se indisponível)
+static long peakRSSKB() {
+#if defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+#elif defined(__unix__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+// Texto como string JSON (aspas, barras e controles escapados)
+static std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "uso: %s <rom.nes> [--frames N] [--movie arquivo] [--instances K]\n"
+            "       [--threads T] [--video] [--audio] [--json]\n"
+            "       [--profile arquivo.csv|arquivo.bin] [--trace arquivo.bin]\n", program);
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--frames") && hasValue) {
+            options.frames = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--movie") && hasValue) {
+            options.moviePath = argv[++i];
+        } else if (!strcmp(arg, "--instances") && hasValue) {
+            options.instances = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--threads") && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--profile") && hasValue) {
+            options.profilePath = argv[++i];
+        } else if (!strcmp(arg, "--trace") && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (!strcmp(arg, "--video")) {
+            options.video = true;
+        } else if (!strcmp(arg, "--audio")) {
+            options.audio = true;
+        } else if (!strcmp(arg, "--json")) {
+            options.json = true;
+        } else if (arg[0] != '-' && options.romPath.empty()) {
+            options.romPath = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.romPath.empty() && options.frames > 0 &&
+           options.instances > 0 && options.threads > 0;
+}
+
+static void writeProfile(const std::string& path, const Profiler& profiler) {
+    FILE* file = fopen(path.c_str(), "wb");
+    bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    bool ok = file && (csv ? profiler.writeCSV(file) : profiler.writeBinary(file));
+    if (file) {
+        ok = fclose(file) == 0 && ok;
+    }
+    if (!ok) {
+        fprintf(stderr, "não foi possível gravar o perfil em %s\n", path.c_str());
+    }
+}
+
+static void writeTrace(const std::string& path, const Tracer& tracer) {
+    FILE* file = fopen(path.c_str(), "wb");
+    bool ok = file && tracer.writeDump(file);
+    if (file) {
+        ok = fclose(file) == 0 && ok;
+    }
+    if (!ok) {
+        fprintf(stderr, "não foi possível gravar o trace em %s\n", path.c_str());
+    }
+}
+
+static void runInstance(const Options& options, const std::vector<uint8_t>& rom,
+                        const std::vector<uint8_t>& movie, InstanceResult& result,
+                        bool first) {
+    Console console(true);
+    std::vector<uint8_t> frameBuffer;
+    std::vector<float> audioBuffer;
+    if (options.video) {
+        frameBuffer.assign(PPU::FRAME_BUFFER_SIZE, 0);
+        console.setFrameBuffer(frameBuffer.data());
+    }
+    if (options.audio) {
+        audioBuffer.assign(Console::DEFAULT_AUDIO_CAPACITY, 0.0f);
+        console.setAudioBuffer(audioBuffer.data(), audioBuffer.size());
+    }
+    console.setHeadless((options.video ? 0 : HEADLESS_NO_VIDEO) |
+                        (options.audio ? 0 : HEADLESS_NO_AUDIO));
+    if (!console.loadROM(rom.data(), rom.size())) {
+        result.error = "ROM inválida";
+        return;
+    }
+    
+    MoviePlayer player;
+    bool playing = !movie.empty();
+    if (playing && !player.load(movie.data(), movie.size())) {
+        result.error = "filme inválido";
+        return;
+    }
+    if (playing && !player.begin(console)) {
+        result.error = "filme gravado com outra ROM";
+        return;
+    }
+    
+    bool trace = first && !options.tracePath.empty();
+    console.setTraceEnabled(trace);
+    console.setTimingEnabled(true);
+    for (int f = 0; f < options.frames; f++) {
+        if (playing) {
+            if (!player.step(console)) {
+                break;
+            }
+        } else {
+            console.runFrame();
+        }
+        while (console.hasAudioData()) {
+            console.getAudioSample();
+        }
+        result.frames++;
+    }
+    
+    result.timings = console.getTimings();
+    result.desynced = playing && player.hasDesynced();
+    result.desyncFrame = player.getDesyncFrame();
+    std::vector<uint8_t> state = console.getState();
+    result.stateHash = hashBytes(state.data(), state.size());
+    if (options.video) {
+        result.frameHash = hashBytes(frameBuffer.data(), frameBuffer.size());
+    }
+    if (first && !options.profilePath.empty() && console.getProfiler()) {
+        writeProfile(options.profilePath, *console.getProfiler());
+    }
+    if (trace) {
+        writeTrace(options.tracePath, *console.getTracer());
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    std::vector<uint8_t> rom;
+    if (!readFile(options.romPath, rom)) {
+        fprintf(stderr, "não foi possível ler %s\n", options.romPath.c_str());
+        return 1;
+    }
+    {
+        Console probe(true);
+        if (!probe.loadROM(rom.data(), rom.size())) {
+            fprintf(stderr, "ROM inválida: %s\n", options.romPath.c_str());
+            return 1;
+        }
+    }
+    
+    std::vector<uint8_t> movie;
+    if (!options.moviePath.empty()) {
+        MoviePlayer check;
+        if (!readFile(options.moviePath, movie) || !check.load(movie.data(), movie.size())) {
+            fprintf(stderr, "filme inválido: %s\n", options.moviePath.c_str());
+            return 1;
+        }
+        Console probe(true);
+        if (!probe.loadROM(rom.data(), rom.size()) || !check.begin(probe)) {
+            fprintf(stderr, "filme gravado com outra ROM: %s\n", options.moviePath.c_str());
+            return 1;
+        }
+    }
+    
+    if (!options.profilePath.empty() && !Profiler::ENABLED) {
+        fprintf(stderr, "--profile requer um build com NES_PROFILING\n");
+        return 1;
+    }
+    
+    // Instâncias distribuídas em round-robin pelas threads
+    int threadCount = std::min(options.threads, options.instances);
+    std::vector<InstanceResult> results(options.instances);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; t++) {
+        workers.emplace_back([&, t]() {
+            for (int i = t; i < options.instances; i += threadCount) {
+                runInstance(options, rom, movie, results[i], i == 0);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double wallNs = std::chrono::duration<double, std::nano>(end - start).count();
+    
+    for (size_t i = 0; i < results.size(); i++) {
+        if (results[i].error) {
+            fprintf(stderr, "instância %zu: %s\n", i, results[i].error);
+            return 1;
+        }
+    }
+    
+    uint64_t totalFrames = 0;
+    ComponentTimings total = {};
+    bool hashesMatch = true;
+    bool desynced = false;
+    for (const InstanceResult& result : results) {
+        totalFrames += result.frames;
+        total.cpuNs += result.timings.cpuNs;
+        total.ppuNs += result.timings.ppuNs;
+        total.apuNs += result.timings.apuNs;
+        total.mapperNs += result.timings.mapperNs;
+        total.outputNs += result.timings.outputNs;
+        hashesMatch = hashesMatch && result.stateHash == results[0].stateHash &&
+                      result.frameHash == results[0].frameHash;
+        desynced = desynced || result.desynced;
+    }
+    
+    double fps = totalFrames / (wallNs / 1e9);
+    double frames = static_cast<double>(std::max<uint64_t>(totalFrames, 1));
+    // ns/frame por instância (tempo de CPU do host, somado entre threads)
+    double nsPerFrame = wallNs * threadCount / frames;
+    double cpuNs = total.cpuNs / frames;
+    double ppuNs = total.ppuNs / frames;
+    double apuNs = total.apuNs / frames;
+    double mapperNs = total.mapperNs / frames;
+    double outputNs = total.outputNs / frames;
+    long rssKB = peakRSSKB();
+    
+    if (options.json) {
+        printf("{\"rom\": %s, \"movie\": %s, \"frames\": %d, \"instances\": %d, "
+               "\"threads\": %d, \"video\": %s, \"audio\": %s, "
+               "\"total_frames\": %llu, \"wall_ms\": %.3f, \"fps\": %.1f, "
+               "\"ns_per_frame\": %.0f, \"cpu_ns_per_frame\": %.0f, \"ppu_ns_per_frame\": %.0f, "
+               "\"apu_ns_per_frame\": %.0f, \"mapper_ns_per_frame\": %.0f, "
+               "\"output_ns_per_frame\": %.0f, \"peak_rss_kb\": %ld, "
+               "\"state_hash\": \"%016llx\", \"frame_hash\": \"%016llx\", "
+               "\"hashes_match\": %s, \"desync\": %s}\n",
+               jsonString(options.romPath).c_str(), jsonString(options.moviePath).c_str(), options.frames,
+               options.instances, threadCount, options.video ? "true" : "false",
+               options.audio ? "true" : "false",
+               static_cast<unsigned long long>(totalFrames), wallNs / 1e6, fps,
+               nsPerFrame, cpuNs, ppuNs, apuNs, mapperNs, outputNs, rssKB,
+               static_cast<unsigned long long>(results[0].stateHash),
+               static_cast<unsigned long long>(results[0].frameHash),
+               hashesMatch ? "true" : "false", desynced ? "true" : "false");
+    } else {
+        printf("%s: %llu frames em %d instância(s), %d thread(s)\n", options.romPath.c_str(),
+               static_cast<unsigned long long>(totalFrames), options.instances, threadCount);
+        printf("  %.1f fps, %.0f ns/frame (CPU %.0f, PPU %.0f, APU %.0f, mapper %.0f, saída %.0f)\n",
+               fps, nsPerFrame, cpuNs, ppuNs, apuNs, mapperNs, outputNs);
+        printf("  pico de RSS %ld KB\n", rssKB);
+        printf("  hash do estado %016llx, do frame %016llx%s\n",
+               static_cast<unsigned long long>(results[0].stateHash),
+               static_cast<unsigned long long>(results[0].frameHash),
+               hashesMatch ? "" : " (instâncias divergem)");
+        if (desynced) {
+            printf("  filme dessincronizou no frame %u\n", results[0].desyncFrame);
+        }
+    }
+    
+    return (desynced || !hashesMatch) ? 2 : 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * Converte um dump binário do trace de instruções (Tracer::writeDump) para
+ * texto no formato do nestest.log.
+ *
+ * Uso: nes_trace_format <trace.bin> [saida.txt]
+ *
+ * Sem arquivo de saída escreve em stdout.
+ */
+
+#include "trace.h"
+
+#include <cstdio>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "uso: %s <trace.bin> [saida.txt]\n", argv[0]);
+        return 1;
+    }
+    
+    FILE* input = fopen(argv[1], "rb");
+    std::vector<TraceRecord> records;
+    bool ok = input && Tracer::readDump(input, records);
+    if (input) {
+        fclose(input);
+    }
+    if (!ok) {
+        fprintf(stderr, "trace inválido: %s\n", argv[1]);
+        return 1;
+    }
+    
+    FILE* output = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (!output) {
+        fprintf(stderr, "não foi possível criar %s\n", argv[2]);
+        return 1;
+    }
+    char line[160];
+    for (const TraceRecord& record : records) {
+        size_t length = formatTraceRecord(record, line, sizeof(line));
+        line[length] = '\n';
+        if (fwrite(line, 1, length + 1, output) != length + 1) {
+            ok = false;
+            break;
+        }
+    }
+    if (output != stdout) {
+        ok = fclose(output) == 0 && ok;
+    }
+    if (!ok) {
+        fprintf(stderr, "erro ao gravar a saída\n");
+        return 1;
+    }
+    return 0;
+}